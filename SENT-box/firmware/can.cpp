@@ -1,6 +1,9 @@
 #include "can.h"
 #include "hal.h"
 
+#include "sent.h"
+#include "sent_can.h"
+
 #include <cstdint>
 #include <cstring>
 
@@ -15,39 +18,94 @@ const CANConfig canConfig500 =
 };
 
 
-#define SWAP_UINT16(x) (((x) << 8) | ((x) >> 8))
+/* per channel CAN ID and rate cap, 0 - every decoded frame is sent */
+static const struct sent_can_cfg sentCanCfg[SENT_CHANNELS_NUM] = {
+    { SENT_CAN_BASE_ID + 0, 0 },
+    { SENT_CAN_BASE_ID + 1, 0 },
+#if SENT_CHANNELS_NUM > 2
+    { SENT_CAN_BASE_ID + 2, 0 },
+    { SENT_CAN_BASE_ID + 3, 0 },
+#endif
+};
+
+static struct sent_can_state sentCanState[SENT_CHANNELS_NUM];
 
-void SendSomething()
+static bool CanSentTx(uint32_t id, const uint8_t *data, void *)
 {
-    auto baseAddress = 0x156;
+    CANTxFrame m_frame;
 
-    {
-        CANTxFrame m_frame;
-
-	    m_frame.IDE = CAN_IDE_STD;
-	    m_frame.EID = 0;
-	    m_frame.SID = baseAddress;
-	    m_frame.RTR = CAN_RTR_DATA;
-	    m_frame.DLC = 8;
-	    memset(m_frame.data8, 0, sizeof(m_frame.data8));
-	    m_frame.data8[3] = 0x33;
-	    m_frame.data8[6] = 0x66;
-
-    	canTransmitTimeout(&CAND1, CAN_ANY_MAILBOX, &m_frame, TIME_IMMEDIATE);
+    m_frame.IDE = CAN_IDE_STD;
+    m_frame.EID = 0;
+    m_frame.SID = id;
+    m_frame.RTR = CAN_RTR_DATA;
+    m_frame.DLC = SENT_CAN_DLC;
+    memcpy(m_frame.data8, data, SENT_CAN_DLC);
+
+    /* never wait for mailbox, would delay all following frames */
+    return canTransmitTimeout(&CAND1, CAN_ANY_MAILBOX, &m_frame, TIME_IMMEDIATE) == MSG_OK;
+}
+
+/* one stats frame per channel, all from same snapshot of that channel,
+ * and timing frame if built with SENT_PROFILING */
+static void CanSendStats(void)
+{
+    /* too big for stack of this thread */
+    static struct sent_channel_stats stats;
+
+    for (uint32_t n = 0; n < SENT_CHANNELS_NUM; n++) {
+        uint8_t data[SENT_CAN_DLC];
+
+        SENT_GetChannelStats(n, &stats);
+        SENT_CanPackStats(&stats, data);
+        CanSentTx(SENT_CAN_STATS_BASE_ID + n, data, nullptr);
     }
 
+#if SENT_PROFILING
+    static struct sent_prof prof;
+    uint8_t data[SENT_CAN_DLC];
+
+    SENT_GetProf(&prof);
+    SENT_CanPackProf(&prof, data);
+    CanSentTx(SENT_CAN_PROF_ID, data, nullptr);
+#endif
 }
 
 static THD_WORKING_AREA(waCanTxThread, 256);
 void CanTxThread(void*)
 {
+    systime_t statsTime = chVTGetSystemTime();
+
     while(1) {
-        SendSomething();
+        /* woken up by decoder as soon as frames are published */
+        SENT_WaitFrames(SENT_CAN_STATS_PERIOD_MS);
+
+        if (chVTTimeElapsedSinceX(statsTime) >= TIME_MS2I(SENT_CAN_STATS_PERIOD_MS)) {
+            statsTime = chTimeAddX(statsTime, TIME_MS2I(SENT_CAN_STATS_PERIOD_MS));
+            CanSendStats();
+        }
+
+        for (uint32_t n = 0; n < SENT_CHANNELS_NUM; n++) {
+            struct sent_can_state *state = &sentCanState[n];
+            uint32_t seq = SENT_GetFrameSeq(n);
+            uint32_t first = state->seq + 1;
 
-        chThdSleepMilliseconds(10);
+            SENT_CanPublish(n, &sentCanCfg[n], state, seq, SENT_FRAME_RING_SIZE, port_rt_get_counter_value(),
+                SENT_GetFrame, CanSentTx, nullptr);
+
+            /* latency of newest frame only, older ones were queued for known reason */
+            struct sent_frame frame;
+            if ((seq >= first) && (SENT_GetFrame(n, seq, &frame))) {
+                SENT_AccountLatency(SENT_CONSUMER_CAN, &frame);
+            }
+        }
     }
 }
 
+void CanGetSentStats(uint32_t n, struct sent_can_state *stats)
+{
+    *stats = sentCanState[n];
+}
+
 static THD_WORKING_AREA(waCanRxThread, 256);
 void CanRxThread(void*)
 {
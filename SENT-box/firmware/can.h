@@ -1,3 +1,10 @@
 #pragma once
 
+#include <cstdint>
+
 void InitCan();
+
+struct sent_can_state;
+
+/* SENT to CAN publisher counters of channel n */
+void CanGetSentStats(uint32_t n, struct sent_can_state *stats);
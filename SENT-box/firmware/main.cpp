@@ -19,6 +19,7 @@
 #include "uart.h"
 #include "can.h"
 #include "sent.h"
+#include "sent_hw_emu.h"
 
 #include "io_pins.h"
 
@@ -64,6 +65,9 @@ int main(void) {
   InitUart();
   InitCan();
   InitSent();
+#if SENT_EMU_OUTPUT
+  InitSentEmulator();
+#endif
 
   /*
    * Normal main() thread activity, in this demo it does nothing except
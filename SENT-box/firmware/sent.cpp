@@ -9,35 +9,19 @@
 #include "hal.h"
 
 #include "sent.h"
-
-struct sent_channel {
-    SM_SENT_enum state;
-    uint8_t nibbles[SENT_MSG_PAYLOAD_SIZE];
-    /* Tick interval in CPU clocks - adjusted on SYNC */
-    uint32_t tickClocks;
-
-    /* slow channel stuff */
-    struct {
-        uint16_t data;
-        uint8_t id;
-    } scMsg[16];
-    uint16_t scMsgFlags;
-    uint32_t scShift2;   /* shift register for bit 2 from status nibble */
-    uint32_t scShift3;   /* shift register for bit 3 from status nibble */
-    bool sc16Bit;       /* C-flag */
-
-#if SENT_STATISTIC_COUNTERS
-    /* stats */
-    uint32_t PulseCnt;
-    uint32_t ShortIntervalErr;
-    uint32_t LongIntervalErr;
-    uint32_t SyncErr;
-    uint32_t CrcErrCnt;
-    uint32_t FrameCnt;
-#endif // SENT_STATISTIC_COUNTERS
-};
-
-static struct sent_channel channels[SENT_CHANNELS_NUM];
+#include "sent_decoder.h"
+#include "sent_channel_set.h"
+#include "sent_capture.h"
+#include "sent_hw_icu.h"
+#include "sent_hw_pal.h"
+#include "sent_hw_dma.h"
+#include "sent_spsc_ring.h"
+#include "sent_raw_stream.h"
+#include "sent_frame_ring.h"
+#include "sent_stats.h"
+#include "sent_prof.h"
+
+static SentChannelSet<SENT_CHANNELS_NUM> channels;
 
 /* Si7215 decoded data */
 int32_t si7215_magnetic[SENT_CHANNELS_NUM];
@@ -58,249 +42,6 @@ uint16_t sentClosedTempVal = 0;
 
 uint8_t sentRawData = 1;
 
-uint8_t sent_crc4(uint8_t* pdata, uint16_t ndata);
-uint8_t sent_crc4_gm(uint8_t* pdata, uint16_t ndata);
-
-static int SENT_SlowChannelDecoder(struct sent_channel *ch);
-
-//#define SENT_TICK (5 * 72) // 5uS @72MHz
-#define SENT_TICK (27 * 72 / 10) // 2.7uS @72MHz
-
-int SENT_Decoder(struct sent_channel *ch, uint16_t clocks)
-{
-    int ret = 0;
-
-    #if SENT_STATISTIC_COUNTERS
-        ch->PulseCnt++;
-    #endif
-
-    /* special case for out-of-sync state */
-    if (ch->state == SM_SENT_INIT_STATE) {
-        /* check is pulse looks like sync with allowed +/-20% deviation */
-        int syncClocks = (SENT_SYNC_INTERVAL + SENT_OFFSET_INTERVAL) * SENT_TICK;
-
-        if ((clocks >= (syncClocks * 80 / 100)) &&
-            (clocks <= (syncClocks * 120 / 100))) {
-            /* calculate tick time */
-            ch->tickClocks = (clocks + 56 / 2) / (SENT_SYNC_INTERVAL + SENT_OFFSET_INTERVAL);
-            /* next state */
-            ch->state = SM_SENT_STATUS_STATE;
-            /* done for this pulse */
-            return 0;
-        }
-    }
-
-    int interval = (clocks + ch->tickClocks / 2) / ch->tickClocks - SENT_OFFSET_INTERVAL;
-
-    if (interval < 0) {
-        #if SENT_STATISTIC_COUNTERS
-            ch->ShortIntervalErr++;
-        #endif //SENT_STATISTIC_COUNTERS
-        ch->state = SM_SENT_INIT_STATE;
-        return -1;
-    }
-
-    switch(ch->state)
-    {
-        case SM_SENT_INIT_STATE:
-            /* handles above, should not get in here */
-            break;
-
-        case SM_SENT_SYNC_STATE:
-            if (interval == SENT_SYNC_INTERVAL)
-            {// sync interval - 56 ticks
-                /* measured tick interval will be used until next sync pulse */
-                ch->tickClocks = (clocks + 56 / 2) / (SENT_SYNC_INTERVAL + SENT_OFFSET_INTERVAL);
-                ch->state = SM_SENT_STATUS_STATE;
-            }
-            else
-            {
-                #if SENT_STATISTIC_COUNTERS
-                    // Increment sync interval err count
-                    ch->SyncErr++;
-                    if (interval > SENT_SYNC_INTERVAL)
-                    {
-                        ch->LongIntervalErr++;
-                    }
-                    else
-                    {
-                        ch->ShortIntervalErr++;
-                    }
-                #endif // SENT_STATISTIC_COUNTERS
-                /* wait for next sync and recalibrate tickClocks */
-                ch->state = SM_SENT_INIT_STATE;
-            }
-            break;
-
-        case SM_SENT_STATUS_STATE:
-        case SM_SENT_SIG1_DATA1_STATE:
-        case SM_SENT_SIG1_DATA2_STATE:
-        case SM_SENT_SIG1_DATA3_STATE:
-        case SM_SENT_SIG2_DATA1_STATE:
-        case SM_SENT_SIG2_DATA2_STATE:
-        case SM_SENT_SIG2_DATA3_STATE:
-        case SM_SENT_CRC_STATE:
-            if(interval <= SENT_MAX_INTERVAL)
-            {
-                ch->nibbles[ch->state - SM_SENT_STATUS_STATE] = interval;
-
-                if (ch->state != SM_SENT_CRC_STATE)
-                {
-                    /* TODO: refactor */
-                    ch->state = (SM_SENT_enum)((int)ch->state + 1);
-                }
-                else
-                {
-                    #if SENT_STATISTIC_COUNTERS
-                        ch->FrameCnt++;
-                    #endif // SENT_STATISTIC_COUNTERS
-                    /* CRC check */
-                    if ((ch->nibbles[7] == sent_crc4(ch->nibbles, 7)) ||
-                        (ch->nibbles[7] == sent_crc4_gm(ch->nibbles + 1, 6)))
-                    {
-                        // Full packet has been received
-                        ret = 1;
-                    }
-                    else
-                    {
-                        #if SENT_STATISTIC_COUNTERS
-                            ch->CrcErrCnt++;
-                        #endif // SENT_STATISTIC_COUNTERS
-                        ret = -1;
-                    }
-                    ch->state = SM_SENT_SYNC_STATE;
-                }
-            }
-            else
-            {
-                #if SENT_STATISTIC_COUNTERS
-                    ch->LongIntervalErr++;
-                #endif
-
-                ch->state = SM_SENT_INIT_STATE;
-            }
-            break;
-    }
-
-    if (ret > 0) {
-        /* valid packet received, can process slow channels */
-        SENT_SlowChannelDecoder(ch);
-    } else if (ret < 0) {
-        /* packet is incorrect, reset slow channel state machine */
-        ch->scShift2 = 0;
-        ch->scShift3 = 0;
-    }
-
-    return ret;
-}
-
-static int SENT_SlowChannelDecoder(struct sent_channel *ch)
-{
-    /* bit 2 and bit 3 from status nibble are used to transfer short messages */
-    bool b2 = !!(ch->nibbles[0] & (1 << 2));
-    bool b3 = !!(ch->nibbles[0] & (1 << 3));
-
-    /* shift in new data */
-    ch->scShift2 = (ch->scShift2 << 1) | b2;
-    ch->scShift3 = (ch->scShift3 << 1) | b3;
-
-    if (1) {
-        /* Short Serial Message format */
-
-        /* 0b1000.0000.0000.0000? */
-        if ((ch->scShift3 & 0xffff) == 0x8000) {
-            /* Done receiving */
-            uint8_t id = (ch->scShift2 >> 12) & 0x0f;
-
-            /* TODO: add CRC check */
-            ch->scMsg[id].data = (ch->scShift2 >> 4) & 0xff;
-            ch->scMsg[id].id = id;
-            ch->scMsgFlags |= (1 << id);
-        }
-    }
-    if (1) {
-        /* Enhanced Serial Message format */
-
-        /* 0b11.1111.0xxx.xx0x.xxx0 ? */
-        if ((ch->scShift3 & 0x3f821) == 0x3f000) {
-            uint8_t id;
-
-            /* C: configuration bit is used to indicate 16 bit format */
-            ch->sc16Bit = !!(ch->scShift3 & (1 << 10));
-            if (!ch->sc16Bit) {
-                int i;
-                /* 12 bit message, 8 bit ID */
-                id = ((ch->scShift3 >> 1) & 0x0f) |
-                     ((ch->scShift3 >> 2) & 0xf0);
-                uint16_t data = ch->scShift2 & 0x0fff; /* 12 bit */
-
-                /* TODO: add crc check */
-                /* Find free mainbox or mailbox with same ID */
-                /* TODO: allow message box freeing */
-                for (i = 0; i < 16; i++) {
-                    if (((ch->scMsgFlags & (1 << i)) == 0) ||
-                        (ch->scMsg[i].id == id)) {
-                        ch->scMsg[i].data = data;
-                        ch->scMsg[i].id = id;
-                        ch->scMsgFlags |= (1 << i);
-                        return 0;
-                    }
-                }
-            } else {
-                /* 16 bit message, 4 bit ID */
-                uint16_t data;
-                data = (ch->scShift2 & 0x0fff) |
-                       (((ch->scShift3 >> 1) & 0x0f) << 12);
-                id = (ch->scShift3 >> 6) & 0x0f;
-
-                /* TODO: add crc check */
-                ch->scMsg[id].data = data; /* 16 bit */
-                ch->scMsg[id].id = id; /* straight mapping */
-                ch->scMsgFlags |= (1 << id);
-            }
-        }
-    }
-
-    return 0;
-}
-
-/* This CRC works for Si7215 for WHOLE message expect last nibble (CRC) */
-uint8_t sent_crc4(uint8_t* pdata, uint16_t ndata)
-{
-    size_t i;
-    uint8_t crc = SENT_CRC_SEED; // initialize checksum with seed "0101"
-    const uint8_t CrcLookup[16] = {0, 13, 7, 10, 14, 3, 9, 4, 1, 12, 6, 11, 15, 2, 8, 5};
-
-    for (i = 0; i < ndata; i++)
-    {
-        crc = crc ^ pdata[i];
-        crc = CrcLookup[crc];
-    }
-
-    return crc;
-}
-
-/* This CRC works for GM pressure sensor for message minus status nibble and minus CRC nibble */
-/* TODO: double check and use same CRC routine? */
-uint8_t sent_crc4_gm(uint8_t* pdata, uint16_t ndata)
-{
-    const uint8_t CrcLookup[16] = {0, 13, 7, 10, 14, 3, 9, 4, 1, 12, 6, 11, 15, 2, 8, 5};
-    uint8_t calculatedCRC, i;
-
-    calculatedCRC = SENT_CRC_SEED; // initialize checksum with seed "0101"
-
-    for (i = 0; i < ndata; i++)
-    {
-        calculatedCRC = CrcLookup[calculatedCRC];
-        calculatedCRC = (calculatedCRC ^ pdata[i]) & 0x0F;
-    }
-    // One more round with 0 as input
-    calculatedCRC = CrcLookup[calculatedCRC];
-
-    return calculatedCRC;
-}
-
-
 uint8_t SENT_IsRawData(void)
 {
     return sentRawData;
@@ -329,71 +70,66 @@ uint16_t SENT_GetClosedThrottleVal(void)
 /* Stat counters */
 uint32_t SENT_GetShortIntervalErrCnt(void)
 {
-    #if SENT_STATISTIC_COUNTERS
-        return channels[0].ShortIntervalErr;
-    #else
-        return 0;
-    #endif
+    struct sent_channel_stats stats;
+
+    SENT_GetChannelStats(0, &stats);
+    return stats.shortIntervalErr;
 }
 
 uint32_t SENT_GetLongIntervalErrCnt(void)
 {
-    #if SENT_STATISTIC_COUNTERS
-        return channels[0].LongIntervalErr;
-    #else
-        return 0;
-    #endif
+    struct sent_channel_stats stats;
+
+    SENT_GetChannelStats(0, &stats);
+    return stats.longIntervalErr;
 }
 
 uint32_t SENT_GetCrcErrCnt(void)
 {
-    #if SENT_STATISTIC_COUNTERS
-        return channels[0].CrcErrCnt;
-    #else
-        return 0;
-    #endif
+    struct sent_channel_stats stats;
+
+    SENT_GetChannelStats(0, &stats);
+    return stats.crcErr;
 }
 
 uint32_t SENT_GetSyncErrCnt(void)
 {
-    #if SENT_STATISTIC_COUNTERS
-        return channels[0].SyncErr;
-    #else
-        return 0;
-    #endif
+    struct sent_channel_stats stats;
+
+    SENT_GetChannelStats(0, &stats);
+    return stats.syncErr;
 }
 
 uint32_t SENT_GetSyncCnt(void)
 {
-    #if SENT_STATISTIC_COUNTERS
-        return channels[0].PulseCnt;
-    #else
-        return 0;
-    #endif
+    struct sent_channel_stats stats;
+
+    SENT_GetChannelStats(0, &stats);
+    return stats.pulseCnt;
 }
 
 uint32_t SENT_GetFrameCnt(uint32_t n)
 {
-    #if SENT_STATISTIC_COUNTERS
-        return channels[n].FrameCnt;
-    #else
-        (void)n;
-        return 0;
-    #endif
+    struct sent_channel_stats stats;
+
+    SENT_GetChannelStats(n, &stats);
+    return stats.frameCnt;
 }
 
 uint32_t SENT_GetErrPercent(void)
 {
-    #if SENT_STATISTIC_COUNTERS
-        return 100 * channels[0].SyncErr / channels[0].PulseCnt;
-    #else
-        return 0;
-    #endif
+    struct sent_channel_stats stats;
+
+    SENT_GetChannelStats(0, &stats);
+    return SENT_StatsPercent(stats.syncErr, stats.pulseCnt);
 }
 
 uint32_t SENT_GetTickTimeNs(void)
 {
-    return channels[0].tickClocks * 1000 / 72;
+    struct sent_channel_stats stats;
+
+    SENT_GetChannelStats(0, &stats);
+    return stats.tickNs;
 }
 
 /* Debug */
@@ -401,7 +137,7 @@ void SENT_GetRawNibbles(uint8_t* buf)
 {
     for(uint8_t i = 0; i < SENT_MSG_PAYLOAD_SIZE; i++)
     {
-        buf[i] = channels[0].nibbles[i];
+        buf[i] = channels.hot(0)->nibbles[i];
     }
 }
 
@@ -413,19 +149,16 @@ uint8_t SENT_GetThrottleValPrec(void)
 #endif
 
 /* Slow Channel */
-uint16_t SENT_GetSlowMessagesFlags(uint32_t n)
+bool SENT_GetSlowMessageById(uint32_t n, uint8_t format, uint8_t id, struct sent_slow_msg *msg)
 {
-    return channels[n].scMsgFlags;
-}
+    int i = SENT_SlowMsgFind(channels.cold(n), (sent_slow_format)format, id);
 
-uint16_t SENT_GetSlowMessage(uint32_t n, uint32_t i)
-{
-    return channels[n].scMsg[i].data;
-}
+    if (i < 0) {
+        return false;
+    }
+    *msg = channels.cold(n)->scMsg[i];
 
-uint16_t SENT_GetSlowMessageID(uint32_t n, uint32_t i)
-{
-    return channels[n].scMsg[i].id;
+    return true;
 }
 
 /* Si7215 decoded data */
@@ -475,70 +208,328 @@ int32_t gm_GetPressure(uint32_t n)
     return ((gm_GetSig0(n) - 198 + 10 + gm_GetSig1(n) - 202 + 10) * 100 / 2);
 }
 
-/* 4 per channel should be enougth */
-#define SENT_MB_SIZE        (4 * SENT_CH_MAX)
+/* 64 intervals per channel, ~2 mS of the shortest SENT pulses */
+#define SENT_RING_SIZE      64
+
+/* ISR to decoder thread, one producer (capture ISR) and one consumer per channel */
+static SentSpscRing<struct sent_edge, SENT_RING_SIZE> sent_rings[SENT_CHANNELS_NUM];
+/* signalled on empty to non-empty transition of any ring */
+static BSEMAPHORE_DECL(sent_wakeup, true);
+/* signalled after decoder published frames, consumed by CAN publisher */
+static BSEMAPHORE_DECL(sent_frames_ready, true);
+
+/* Deepest path is thread loop, batch decoder, slow channel decoder and
+ * mailbox store: 416 bytes, 464 with SENT_PROFILING on Si7215 board, by
+ * -fcallgraph-info of host g++ -O2. 64 bit host frames should not be
+ * smaller than target ones, threads are filled (CH_DBG_FILL_THREADS) to
+ * check high water on target */
+static THD_WORKING_AREA(waSentDecoderThread, 640);
+
+static struct sent_edge sent_edges[SENT_RING_SIZE];
+static uint16_t sent_batch[SENT_RING_SIZE];
+
+/* decoder thread to UART/CAN */
+static SentFrameRing<SENT_FRAME_RING_SIZE> sent_frames[SENT_CHANNELS_NUM];
+static struct sent_latency sent_latency[SENT_CONSUMER_NUM];
+
+/* decoder thread to UART and CAN publishers, refreshed every SENT_STATS_PUBLISH_MS */
+#define SENT_STATS_PUBLISH_MS   10
+static SentStatsBlock<> sent_stats[SENT_CHANNELS_NUM];
+static uint32_t sent_stats_time;
+
+/* decoder thread to UART in raw streaming mode, ~4 mS of the shortest SENT pulses */
+#define SENT_RAW_RING_SIZE      128
+static SentRawStream<SENT_RAW_RING_SIZE> sent_raw[SENT_CHANNELS_NUM];
+
+/* intervals captured in bulk, DMA backend hands over half of its buffer at once */
+#define SENT_CAPTURE_BATCH_SIZE     (SENT_DMA_BUF_SIZE / 2)
+static uint16_t sent_capture_batch[SENT_CAPTURE_BATCH_SIZE];
+
+#if SENT_PROFILING
+static struct sent_prof sent_prof;
+
+uint32_t SENT_ProfCycles(void)
+{
+    return port_rt_get_counter_value();
+}
+#endif // SENT_PROFILING
+
+bool SENT_GetProf(struct sent_prof *prof)
+{
+#if SENT_PROFILING
+    *prof = sent_prof;
+    return true;
+#else
+    (void)prof;
+    return false;
+#endif
+}
+
+static void SENT_WakeupDecoder(void)
+{
+#if SENT_PROFILING
+    SENT_ProfWakeSignal(&sent_prof);
+#endif
+    chSysLockFromISR();
+    chBSemSignalI(&sent_wakeup);
+    chSysUnlockFromISR();
+}
+
+void SENT_ISR_Handler(uint8_t ch, uint16_t clocks, uint32_t entry)
+{
+    if (ch >= SENT_CHANNELS_NUM) {
+        return;
+    }
+
+    /* Edge happened ISR latency before, capture timer and this counter both run
+     * at CPU clock so interval and time are in same units */
+    struct sent_edge edge = { entry, clocks };
 
-static msg_t sent_mb_buffer[SENT_MB_SIZE];
-static MAILBOX_DECL(sent_mb, sent_mb_buffer, SENT_MB_SIZE);
+    /* no kernel lock unless decoder thread has to be woken up */
+    if (sent_rings[ch].push(edge)) {
+        SENT_WakeupDecoder();
+    }
 
-static THD_WORKING_AREA(waSentDecoderThread, 256);
+#if SENT_PROFILING
+    SENT_ProfMailbox(&sent_prof, sent_rings[ch].count());
+    SENT_ProfEnd(&sent_prof, SENT_PROF_ISR, entry, 1);
+#endif
+}
 
-void SENT_ISR_Handler(uint8_t ch, uint16_t clocks)
+void SENT_CaptureReady_ISR_Handler(uint8_t ch, uint32_t entry)
 {
-    /* encode to fin msg_t */
-    msg_t msg = (ch << 16) | clocks;
-    chMBPostI(&sent_mb, msg);
+    (void)ch;
+    SENT_WakeupDecoder();
+
+#if SENT_PROFILING
+    SENT_ProfEnd(&sent_prof, SENT_PROF_ISR, entry, 1);
+#else
+    (void)entry;
+#endif
+}
+
+/* Signal decode per profile layout, unused branches are dropped at compile time */
+template <class Profile>
+static void SentFrameHandler(struct sent_channel_hot *ch, void *arg)
+{
+    uint32_t n = (uintptr_t)arg;
+
+    /* Si7215 packet, signals are assembled by decoder as nibbles arrive,
+     * inverted nibble is checked by decoder already */
+    if (Profile::layout == SENT_LAYOUT_SI7215) {
+        si7215_magnetic[n] = ch->sig0 - 2048;
+        si7215_counter[n] = ch->sig1;
+    }
+    /* GM DI fuel pressure, temperature sensor */
+    if (Profile::layout == SENT_LAYOUT_DUAL12) {
+        gm_sig0[n] = ch->sig0;
+        gm_sig1[n] = ch->sig1;
+        gm_stat[n] =
+            ch->nibbles[0];
+    }
+
+    struct sent_frame frame;
+    frame.syncTime = ch->frameSyncTime;
+    frame.sig0 = (Profile::layout == SENT_LAYOUT_SI7215) ? si7215_magnetic[n] : gm_sig0[n];
+    frame.sig1 = (Profile::layout == SENT_LAYOUT_SI7215) ? si7215_counter[n] : gm_sig1[n];
+    for (uint8_t i = 0; i < SENT_MSG_PAYLOAD_SIZE; i++) {
+        frame.nibbles[i] = ch->nibbles[i];
+    }
+    frame.dataNibbles = ch->frameDataNibbles;
+    sent_frames[n].push(frame);
+}
+
+struct sent_channel_cfg {
+    sent_split_decoder decode;
+    sent_frame_cb onFrame;
+    sent_capture_type capture;
+    sent_input input;
+    /* falling edges closer than this are glitches, for backends that filter them */
+    uint16_t minPulseUs;
+};
+
+#define SENT_CHANNEL_CFG(profile, capture, input, minPulseUs) \
+    { SENT_DecodeBatch<profile>, SentFrameHandler<profile>, capture, input, minPulseUs }
+
+/* Sensor connected to each input and how its edges are captured. Any mix of
+ * profiles and backends can be used, each channel gets decoder specialized
+ * for its sensor. Wrap profile into SentProfileTracked<> for sensor with
+ * noisy edges or drifting tick. ICU and DMA need input's own timer, PAL can
+ * take any pin but one per EXTI line (pin number). Valid SENT pulse is at
+ * least 12 ticks, ~32 uS even with 2.7 uS tick, so 10 uS glitch filter is
+ * safe for any sensor: raise it for slow tick sensor on noisy wiring */
+static const struct sent_channel_cfg sent_channel_cfg[SENT_CHANNELS_NUM] = {
+#if SENT_DEV == SENT_GM_ETB
+    SENT_CHANNEL_CFG(SentProfileGmEtb, SENT_CAPTURE_ICU, SENT_INPUT_PA7, 10),
+    SENT_CHANNEL_CFG(SentProfileGmEtb, SENT_CAPTURE_ICU, SENT_INPUT_PB6, 10),
+#elif SENT_DEV == SENT_SILABS_SENS
+    SENT_CHANNEL_CFG(SentProfileSi7215, SENT_CAPTURE_ICU, SENT_INPUT_PA7, 10),
+    SENT_CHANNEL_CFG(SentProfileSi7215, SENT_CAPTURE_ICU, SENT_INPUT_PB6, 10),
+    SENT_CHANNEL_CFG(SentProfileSi7215, SENT_CAPTURE_ICU, SENT_INPUT_PA8, 10),
+    SENT_CHANNEL_CFG(SentProfileSi7215, SENT_CAPTURE_ICU, SENT_INPUT_PA1, 10),
+#endif
+};
+
+static SentCaptureBackend *sent_capture[SENT_CHANNELS_NUM];
+
+static SentCaptureBackend *SENT_GetBackend(sent_capture_type type)
+{
+    switch (type) {
+    case SENT_CAPTURE_ICU:
+        return SENT_IcuBackend();
+    case SENT_CAPTURE_PAL:
+        return SENT_PalBackend();
+    case SENT_CAPTURE_DMA:
+        return SENT_DmaBackend();
+    default:
+        return nullptr;
+    }
+}
+
+uint32_t SENT_GetIntervalOverflowCnt(uint32_t n)
+{
+    struct sent_capture_counters counters;
+
+    sent_capture[n]->getCounters(n, &counters);
+    return sent_rings[n].getOverflowCnt() + counters.overruns;
+}
+
+/* Consistent copy of all counters of channel n, zeroes until decoder published first one */
+void SENT_GetChannelStats(uint32_t n, struct sent_channel_stats *stats)
+{
+    if (!sent_stats[n].read(stats)) {
+        *stats = {};
+    }
+}
+
+/* Decoder thread only: counters are changed by this thread, so they do not move while taken */
+static void SENT_PublishStats(uint32_t now)
+{
+    /* too big for stack of decoder thread */
+    static struct sent_channel_stats stats;
+
+    for (uint32_t n = 0; n < SENT_CHANNELS_NUM; n++) {
+        stats = {};
+        channels.getStats(n, &stats);
+        stats.intervalOverflow = SENT_GetIntervalOverflowCnt(n);
+        sent_stats[n].publish(stats, now);
+    }
+}
+
+static int SENT_DecodeChannel(uint32_t n, const uint16_t *clocks, size_t cnt)
+{
+#if SENT_PROFILING
+    uint32_t start = SENT_ProfCycles();
+    int frames = channels.decode(n, sent_channel_cfg[n].decode, clocks, cnt, sent_channel_cfg[n].onFrame, (void *)(uintptr_t)n);
+
+    SENT_ProfEnd(&sent_prof, SENT_PROF_PULSE, start, cnt);
+    return frames;
+#else
+    return channels.decode(n, sent_channel_cfg[n].decode, clocks, cnt, sent_channel_cfg[n].onFrame, (void *)(uintptr_t)n);
+#endif
 }
 
 static void SentDecoderThread(void*)
 {
-    msg_t msg;
     while(true)
     {
-        msg_t ret;
-
-        ret = chMBFetchTimeout(&sent_mb, &msg, TIME_INFINITE);
-        /* TODO: handle ret */
-        if (ret == MSG_OK) {
-            uint16_t tick = msg & 0xffff;
-            uint8_t n = (msg >> 16) & 0xff;
-            struct sent_channel *ch = &channels[n];
-
-            if (SENT_Decoder(ch, tick) > 0) {
-                /* decode Si7215 packet */
-                if (((~ch->nibbles[1 + 5]) & 0x0f) == ch->nibbles[1 + 0]) {
-                    si7215_magnetic[n] =
-                        ((ch->nibbles[1 + 0] << 8) |
-                         (ch->nibbles[1 + 1] << 4) |
-                         (ch->nibbles[1 + 2] << 0)) - 2048;
-                    si7215_counter[n] =
-                        (ch->nibbles[1 + 3] << 4) |
-                        (ch->nibbles[1 + 4] << 0);
-                }
-                /* decode GM DI fuel pressure, temperature sensor */
-                if (1) {
-                    /* Sig0 occupie first 3 nibbles in MSB..LSB order
-                     * Sig1 occupit next 3 nibbles in LSB..MSB order */
-                    gm_sig0[n] =
-                        (ch->nibbles[1 + 0] << 8) |
-                        (ch->nibbles[1 + 1] << 4) |
-                        (ch->nibbles[1 + 2] << 0);
-                    gm_sig1[n] =
-                        (ch->nibbles[1 + 3] << 0) |
-                        (ch->nibbles[1 + 4] << 4) |
-                        (ch->nibbles[1 + 5] << 8);
-                    gm_stat[n] =
-                        ch->nibbles[0];
+        /* wake up without edges too, so stats of silent channel go on and rates drop */
+        chBSemWaitTimeout(&sent_wakeup, TIME_MS2I(SENT_STATS_PUBLISH_MS));
+#if SENT_PROFILING
+        SENT_ProfWakeRun(&sent_prof);
+#endif
+
+        int frames = 0;
+        for (uint32_t n = 0; n < SENT_CHANNELS_NUM; n++) {
+            /* intervals captured in bulk, converted by backend */
+            size_t cnt;
+            uint32_t endTime;
+            while ((cnt = sent_capture[n]->collect(n, sent_capture_batch, SENT_CAPTURE_BATCH_SIZE, &endTime)) > 0) {
+                struct sent_capture_counters counters;
+
+                sent_capture[n]->getCounters(n, &counters);
+                channels.setEdgeTime(n, sent_capture_batch, cnt, endTime);
+                frames += SENT_DecodeChannel(n, sent_capture_batch, cnt);
+                sent_raw[n].tap(sent_capture_batch, cnt, endTime, counters.overruns);
+            }
+            /* take everything posted so far, per pulse overhead is paid once per batch */
+            while ((cnt = sent_rings[n].pop(sent_edges, SENT_RING_SIZE)) > 0) {
+                for (size_t i = 0; i < cnt; i++) {
+                    sent_batch[i] = sent_edges[i].clocks;
                 }
+                channels.setEdgeTime(n, sent_batch, cnt, sent_edges[cnt - 1].time);
+                frames += SENT_DecodeChannel(n, sent_batch, cnt);
+                sent_raw[n].tap(sent_edges, cnt, sent_rings[n].getOverflowCnt());
             }
         }
+
+        if (frames) {
+            chBSemSignal(&sent_frames_ready);
+        }
+
+        uint32_t now = port_rt_get_counter_value();
+        if (now - sent_stats_time >= SENT_STATS_PUBLISH_MS * 1000 * SENT_TIMER_CLOCK_MHZ) {
+            sent_stats_time = now;
+            SENT_PublishStats(now);
+        }
     }
 }
 
-void SentDecoder_Init(void)
+void InitSent()
 {
-    /* init interval mailbox */
-    chMBObjectInit(&sent_mb, sent_mb_buffer, SENT_MB_SIZE);
+    for (uint32_t n = 0; n < SENT_CHANNELS_NUM; n++) {
+        sent_capture[n] = SENT_GetBackend(sent_channel_cfg[n].capture);
+        osalDbgAssert(sent_capture[n] != nullptr, "SENT capture backend");
+    }
 
+    /* Start decoder thread before first edge can be posted */
     chThdCreateStatic(waSentDecoderThread, sizeof(waSentDecoderThread), NORMALPRIO, SentDecoderThread, nullptr);
+
+    for (uint32_t n = 0; n < SENT_CHANNELS_NUM; n++) {
+        bool ok = sent_capture[n]->start(n, sent_channel_cfg[n].input,
+            sent_channel_cfg[n].minPulseUs * SENT_TIMER_CLOCK_MHZ);
+        osalDbgAssert(ok, "SENT input can not be captured by its backend or EXTI line is taken");
+        (void)ok;
+    }
+}
+
+uint32_t SENT_GetFrameSeq(uint32_t n)
+{
+    return sent_frames[n].lastSeq();
+}
+
+bool SENT_GetFrame(uint32_t n, uint32_t seq, struct sent_frame *frame)
+{
+    return sent_frames[n].read(seq, frame);
+}
+
+bool SENT_WaitFrames(uint32_t timeoutMs)
+{
+    return chBSemWaitTimeout(&sent_frames_ready, TIME_MS2I(timeoutMs)) == MSG_OK;
+}
+
+void SENT_AccountLatency(uint32_t consumer, const struct sent_frame *frame)
+{
+    SENT_LatencyAdd(&sent_latency[consumer], port_rt_get_counter_value() - frame->syncTime);
+}
+
+void SENT_GetLatencyUs(uint32_t consumer, uint32_t *min, uint32_t *avg, uint32_t *max)
+{
+    const struct sent_latency *lat = &sent_latency[consumer];
+
+    *min = lat->min / SENT_TIMER_CLOCK_MHZ;
+    *avg = SENT_LatencyAvg(lat) / SENT_TIMER_CLOCK_MHZ;
+    *max = lat->max / SENT_TIMER_CLOCK_MHZ;
+}
+
+void SENT_SetRawStream(bool on)
+{
+    for (uint32_t n = 0; n < SENT_CHANNELS_NUM; n++) {
+        sent_raw[n].enable(on);
+    }
+}
+
+size_t SENT_GetRawIntervals(uint32_t n, uint16_t *clocks, size_t max, uint32_t *endTime, bool *gap, uint32_t *lost)
+{
+    return sent_raw[n].read(clocks, max, endTime, gap, lost);
 }
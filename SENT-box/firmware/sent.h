@@ -7,8 +7,8 @@
 
 #pragma once
 
-#define SENT_MODE_ICU 1
-#define SENT_MODE_PAL 0
+/* SENT emulator drives PA8, see sent_hw_emu.h */
+#define SENT_EMU_OUTPUT 0
 
 #define SENT_SILABS_SENS    0   // Silabs Si7215, tick 5 us
 #define SENT_GM_ETB         1   // GM ETB throttle, tick 3.25 us
@@ -21,12 +21,19 @@
 #define SENT_CHANNELS_NUM 4 // Number of sent channels
 #endif
 
+/* capture timer runs from 72 MHz CPU clock */
+#define SENT_TIMER_CLOCK_MHZ 72
+
 #define SENT_OFFSET_INTERVAL 12
 #define SENT_SYNC_INTERVAL   (56 - SENT_OFFSET_INTERVAL) // 56 ticks - 12
 
 #define SENT_MIN_INTERVAL 12
 #define SENT_MAX_INTERVAL 15
 
+/* Passed to decoder in place of lost edges or of interval too long for 16 bits,
+ * longer than any valid SENT pulse. Decoder drops back to sync search */
+#define SENT_GAP_INTERVAL 0xffff
+
 #define SENT_CRC_SEED 0x05
 
 #define SENT_MSG_DATA_SIZE      6
@@ -36,6 +43,10 @@
 /* collect statistic */
 #define SENT_STATISTIC_COUNTERS 1
 
+/* ISR and decoder cycle histograms, mailbox high water mark, wake latency,
+ * see sent_prof.h. Reported over UART telemetry and CAN */
+#define SENT_PROFILING 0
+
 #define SENT_THROTTLE_OPEN_VAL   435     // Sensor position of fully open throttle
 #define SENT_THROTTLE_CLOSE_VAL  3665    // Sensor position of fully closed throttle
 
@@ -62,20 +73,58 @@ typedef enum
         SM_SENT_SIG2_DATA2_STATE,
         SM_SENT_SIG2_DATA3_STATE,
         SM_SENT_CRC_STATE,
+        /* after CRC nibble of profiles with pause pulse, expects pause or sync */
+        SM_SENT_PAUSE_STATE,
 }SM_SENT_enum;
 
-/* SENT init */
-void InitSent();
+struct sent_frame;
+
+/* Readers of decoded frames, each gets own latency statistic */
+enum
+{
+    SENT_CONSUMER_UART = 0,
+    SENT_CONSUMER_CAN,
+    SENT_CONSUMER_NUM,
+};
 
-/* Decoder task init, called from PAL or ICU implementation */
-void SentDecoder_Init(void);
+/* SENT init: decoder thread and capture backend of each channel, see sent_channel_cfg */
+void InitSent();
 
-/* ISR hook */
-void SENT_ISR_Handler(uint8_t ch, uint16_t val_res);
+/* ISR hook. entry: cycle counter read first thing in backend callback,
+ * taken as edge time and as start of ISR timing */
+void SENT_ISR_Handler(uint8_t ch, uint16_t val_res, uint32_t entry);
 
-uint16_t SENT_GetData(uint8_t ch);
+/* Bulk capture ISR hook: backend has intervals for decoder thread to collect() */
+void SENT_CaptureReady_ISR_Handler(uint8_t ch, uint32_t entry);
 
 /* Stat counters */
+struct sent_channel_stats {
+    uint32_t tickNs;
+    uint32_t pulseCnt;
+    uint32_t shortIntervalErr;
+    uint32_t longIntervalErr;
+    uint32_t syncErr;
+    uint32_t crcErr;
+    uint32_t frameCnt;
+    /* slow channel messages with bad CRC, live messages pushed out of mailbox */
+    uint32_t slowCrcErr;
+    uint32_t slowEvict;
+    /* frames missing from sensor rolling counter sequence, 0 for sensors without one */
+    uint32_t lostFrames;
+    /* captured intervals dropped before decoder got them */
+    uint32_t intervalOverflow;
+    /* per second over sliding window, see sent_stats.h */
+    uint32_t frameRate;
+    uint32_t errRate;
+    uint32_t lostRate;
+};
+
+struct sent_prof;
+/* Copy of timing instrumentation, false if built without SENT_PROFILING */
+bool SENT_GetProf(struct sent_prof *prof);
+
+void SENT_GetChannelStats(uint32_t n, struct sent_channel_stats *stats);
+uint32_t SENT_GetIntervalOverflowCnt(uint32_t n);
 uint32_t SENT_GetShortIntervalErrCnt(void);
 uint32_t SENT_GetLongIntervalErrCnt(void);
 uint32_t SENT_GetCrcErrCnt(void);
@@ -85,6 +134,26 @@ uint32_t SENT_GetFrameCnt(uint32_t n);
 uint32_t SENT_GetErrPercent(void);
 uint32_t SENT_GetTickTimeNs(void);
 
+/* Decoded frames kept per channel for consumers, ~8 mS of frames */
+#define SENT_FRAME_RING_SIZE    8
+
+/* Decoded frames, see sent_frame_ring.h.
+ * Sequence number of newest frame of channel, 0 if none yet */
+uint32_t SENT_GetFrameSeq(uint32_t n);
+/* Copy frame seq of channel n, false if not published yet or already overwritten */
+bool SENT_GetFrame(uint32_t n, uint32_t seq, struct sent_frame *frame);
+/* Wait for decoder to publish new frames, false if nothing came in timeoutMs */
+bool SENT_WaitFrames(uint32_t timeoutMs);
+/* Consumer got frame: account time from its sync edge till now */
+void SENT_AccountLatency(uint32_t consumer, const struct sent_frame *frame);
+void SENT_GetLatencyUs(uint32_t consumer, uint32_t *min, uint32_t *avg, uint32_t *max);
+
+/* Raw interval streaming for recordings, see sent_raw_stream.h. Can be switched from ISR */
+void SENT_SetRawStream(bool on);
+/* Up to max captured intervals of channel n in CPU clocks, endTime is capture time of last one.
+ * gap is set if intervals were lost before first one, lost is their count if known */
+size_t SENT_GetRawIntervals(uint32_t n, uint16_t *clocks, size_t max, uint32_t *endTime, bool *gap, uint32_t *lost);
+
 /* Debug */
 void SENT_GetRawNibbles(uint8_t * buf);
 
@@ -96,9 +165,11 @@ void SENT_ResetRawDataProp(void);
 uint8_t SENT_GetThrottleValPrec(void);
 
 /* Slow Channel */
-uint16_t SENT_GetSlowMessagesFlags(uint32_t n);
-uint16_t SENT_GetSlowMessage(uint32_t n, uint32_t i);
-uint16_t SENT_GetSlowMessageID(uint32_t n, uint32_t i);
+struct sent_slow_msg;
+
+/* Message by format (sent_slow_format) and ID with its update time and count.
+ * False if it was not received or aged out */
+bool SENT_GetSlowMessageById(uint32_t n, uint8_t format, uint8_t id, struct sent_slow_msg *msg);
 
 /* Si7215 decoded data */
 int32_t Si7215_GetMagneticField(uint32_t n);
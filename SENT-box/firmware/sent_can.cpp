@@ -0,0 +1,101 @@
+/*
+ * sent_can.cpp
+ *
+ * SENT frames to CAN publisher core
+ */
+
+#include "sent_can.h"
+
+void SENT_CanPack(const struct sent_frame *frame, uint8_t counter, uint32_t now, uint8_t *data)
+{
+    uint32_t sig0 = frame->sig0 & 0xfff;
+    uint32_t sig1 = frame->sig1 & 0xfff;
+    uint32_t ageUs = (now - frame->syncTime) / SENT_TIMER_CLOCK_MHZ;
+
+    if (ageUs > 0xffff) {
+        ageUs = 0xffff;
+    }
+
+    data[0] = (frame->nibbles[0] & 0x0f) | ((counter & 0x0f) << 4);
+    data[1] = sig0 & 0xff;
+    data[2] = (sig0 >> 8) | ((sig1 & 0x0f) << 4);
+    data[3] = sig1 >> 4;
+    data[4] = ageUs & 0xff;
+    data[5] = ageUs >> 8;
+    data[6] = 0;
+    data[7] = 0;
+}
+
+static inline void SENT_CanPut16(uint8_t *data, uint32_t val)
+{
+    if (val > 0xffff) {
+        val = 0xffff;
+    }
+    data[0] = val & 0xff;
+    data[1] = val >> 8;
+}
+
+void SENT_CanPackStats(const struct sent_channel_stats *stats, uint8_t *data)
+{
+    SENT_CanPut16(data + 0, stats->frameRate);
+    SENT_CanPut16(data + 2, stats->errRate);
+    SENT_CanPut16(data + 4, stats->lostRate);
+    SENT_CanPut16(data + 6, stats->tickNs);
+}
+
+void SENT_CanPackProf(const struct sent_prof *prof, uint8_t *data)
+{
+    SENT_CanPut16(data + 0, prof->hist[SENT_PROF_ISR].max);
+    SENT_CanPut16(data + 2, prof->hist[SENT_PROF_PULSE].max);
+    SENT_CanPut16(data + 4, prof->hist[SENT_PROF_WAKE].max);
+    SENT_CanPut16(data + 6, prof->mailboxHighWater);
+}
+
+int SENT_CanPublish(uint32_t n, const struct sent_can_cfg *cfg, struct sent_can_state *state,
+    uint32_t lastSeq, uint32_t depth, uint32_t now, sent_frame_reader read, sent_can_tx tx, void *arg)
+{
+    int sent = 0;
+
+    state->queueDepth = lastSeq - state->seq;
+    if (state->queueDepth > state->maxQueueDepth) {
+        state->maxQueueDepth = state->queueDepth;
+    }
+
+    /* lapped by decoder: frames out of ring are gone, skip them in one step */
+    if (state->queueDepth > depth) {
+        state->lostCnt += state->queueDepth - depth;
+        state->seq = lastSeq - depth;
+    }
+
+    while (state->seq != lastSeq) {
+        struct sent_frame frame;
+
+        state->seq++;
+        if (!read(n, state->seq, &frame)) {
+            /* overwritten while we were sending */
+            state->lostCnt++;
+            continue;
+        }
+
+        if ((cfg->minPeriod) && (state->sentOnce) &&
+            (frame.syncTime - state->lastTxSyncTime < cfg->minPeriod)) {
+            state->rateSkipCnt++;
+            continue;
+        }
+
+        uint8_t data[SENT_CAN_DLC];
+        SENT_CanPack(&frame, state->counter, now, data);
+        if (!tx(cfg->id, data, arg)) {
+            state->txFullCnt++;
+            continue;
+        }
+
+        state->counter = (state->counter + 1) & 0x0f;
+        state->lastTxSyncTime = frame.syncTime;
+        state->sentOnce = true;
+        state->txCnt++;
+        sent++;
+    }
+
+    return sent;
+}
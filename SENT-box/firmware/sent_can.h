@@ -0,0 +1,85 @@
+/*
+ * sent_can.h
+ *
+ * SENT frames to CAN: packing, per channel rate cap and accounting.
+ * No ChibiOS/HAL dependencies here: this is also built into unit_tests,
+ * CAN driver is reached through sent_can_tx callback.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "sent_frame_ring.h"
+#include "sent_prof.h"
+
+#define SENT_CAN_BASE_ID    0x156
+
+/* CAN frame layout, DLC 8:
+ * byte 0:    status nibble (bits 0..3), rolling counter (bits 4..7)
+ * bytes 1-3: sig0 (12 bit) and sig1 (12 bit), little endian, sig0 first
+ * bytes 4-5: sync edge to transmit time, uS, little endian, saturated
+ * bytes 6-7: reserved, 0 */
+#define SENT_CAN_DLC        8
+
+/* Statistic frame of channel n at SENT_CAN_STATS_BASE_ID + n, DLC 8, every
+ * SENT_CAN_STATS_PERIOD_MS, from one stats snapshot. All little endian, saturated:
+ * bytes 0-1: frames per second
+ * bytes 2-3: decoder errors per second (CRC, sync, short and long pulses)
+ * bytes 4-5: frames lost per second (sensor rolling counter)
+ * bytes 6-7: tick, nS */
+#define SENT_CAN_STATS_BASE_ID      0x160
+#define SENT_CAN_STATS_PERIOD_MS    100
+
+/* Timing frame at SENT_CAN_PROF_ID (SENT_PROFILING builds only), DLC 8, with
+ * statistic frames. Worst cases since boot, CPU cycles, all little endian, saturated:
+ * bytes 0-1: capture ISR
+ * bytes 2-3: decoder, per pulse
+ * bytes 4-5: decoder wakeup latency
+ * bytes 6-7: mailbox high water mark, intervals */
+#define SENT_CAN_PROF_ID            0x168
+
+struct sent_can_cfg {
+    uint32_t id;
+    /* minimal time between transmitted frames, CPU clocks. 0 - every frame is sent */
+    uint32_t minPeriod;
+};
+
+struct sent_can_state {
+    /* last frame sequence number handled */
+    uint32_t seq;
+    /* sync time of last transmitted frame */
+    uint32_t lastTxSyncTime;
+    bool sentOnce;
+    /* rolling counter, 4 bit, advances for each transmitted frame */
+    uint8_t counter;
+
+    /* stats */
+    uint32_t txCnt;
+    /* skipped by rate cap, not an error */
+    uint32_t rateSkipCnt;
+    /* overwritten in frame ring before publisher got to them */
+    uint32_t lostCnt;
+    /* no free CAN mailbox */
+    uint32_t txFullCnt;
+    /* frames waiting in ring on wakeup, last and worst */
+    uint32_t queueDepth;
+    uint32_t maxQueueDepth;
+};
+
+/* Same as SENT_GetFrame() */
+typedef bool (*sent_frame_reader)(uint32_t n, uint32_t seq, struct sent_frame *frame);
+/* Queue frame for transmission, false if no room */
+typedef bool (*sent_can_tx)(uint32_t id, const uint8_t *data, void *arg);
+
+void SENT_CanPack(const struct sent_frame *frame, uint8_t counter, uint32_t now, uint8_t *data);
+void SENT_CanPackStats(const struct sent_channel_stats *stats, uint8_t *data);
+void SENT_CanPackProf(const struct sent_prof *prof, uint8_t *data);
+
+/* Handle frames of channel n published since last call, up to lastSeq.
+ * Ring keeps depth newest frames, older ones are counted lost without
+ * reading them. now is current time in CPU clocks. Returns number of
+ * transmitted frames */
+int SENT_CanPublish(uint32_t n, const struct sent_can_cfg *cfg, struct sent_can_state *state,
+    uint32_t lastSeq, uint32_t depth, uint32_t now, sent_frame_reader read, sent_can_tx tx, void *arg);
@@ -0,0 +1,66 @@
+/*
+ * sent_capture.h
+ *
+ * Common interface of SENT capture backends. Each decoder channel gets its
+ * backend and input at startup from sent_channel_cfg in sent.cpp, so one
+ * build can mix them: cheapest one that can serve each pin.
+ * No ChibiOS/HAL dependencies here: this is also built into unit_tests.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+typedef enum {
+    /* timer input capture, interrupt per edge (sent_hw_icu.cpp) */
+    SENT_CAPTURE_ICU = 0,
+    /* EXTI interrupt per edge timed by DWT cycle counter (sent_hw_pal.cpp) */
+    SENT_CAPTURE_PAL,
+    /* timer input capture to circular DMA buffer, interrupt per half buffer (sent_hw_dma.cpp) */
+    SENT_CAPTURE_DMA,
+    SENT_CAPTURE_NUM,
+} sent_capture_type;
+
+/* Board pins SENT sensor can be connected to */
+typedef enum {
+    SENT_INPUT_PA7 = 0,     /* TIM3 CH2 */
+    SENT_INPUT_PB6,         /* TIM4 CH1 */
+    SENT_INPUT_PA8,         /* TIM1 CH1 */
+    SENT_INPUT_PA1,         /* TIM2 CH2 */
+    SENT_INPUT_PA6,         /* EXTI only, its TIM3 CH1 is taken by PA7 */
+    SENT_INPUT_NUM,
+} sent_input;
+
+struct sent_capture_counters {
+    /* edges dropped as glitches */
+    uint32_t glitches;
+    /* intervals passed to decoder as SENT_GAP_INTERVAL */
+    uint32_t gaps;
+    /* captures overwritten before they were read */
+    uint32_t overruns;
+};
+
+class SentCaptureBackend {
+public:
+    virtual const char *name() const = 0;
+
+    /* Start capture of falling edges on input for decoder channel ch. Edges
+     * closer than minClocks to previous one are glitches for backends that
+     * filter them, 0 - no filter. False if backend has no way to capture
+     * that input */
+    virtual bool start(uint8_t ch, sent_input input, uint32_t minClocks) = 0;
+
+    /* Decoder thread: up to max intervals captured in bulk since last call,
+     * endTime is capture time of last one. Backends posting each edge with
+     * SENT_ISR_Handler() have nothing here */
+    virtual size_t collect(uint8_t ch, uint16_t *out, size_t max, uint32_t *endTime) {
+        return 0;
+    }
+
+    virtual void getCounters(uint8_t ch, struct sent_capture_counters *counters) {
+        counters->glitches = 0;
+        counters->gaps = 0;
+        counters->overruns = 0;
+    }
+};
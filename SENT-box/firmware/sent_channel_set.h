@@ -0,0 +1,98 @@
+/*
+ * sent_channel_set.h
+ *
+ * Decoder state of N SENT inputs. Per pulse state of all channels is kept
+ * in one packed array, slow channel mailboxes and error counters in other,
+ * so decoding any channel touches the same few lines of hot state however
+ * many channels there are.
+ * No ChibiOS/HAL dependencies here: this is also built into unit_tests.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "sent_decoder.h"
+
+template <size_t N>
+class SentChannelSet {
+    static_assert(N > 0, "at least one channel");
+
+public:
+    SentChannelSet() {
+        reset();
+    }
+
+    void reset() {
+        memset(m_hot, 0, sizeof(m_hot));
+        memset(m_cold, 0, sizeof(m_cold));
+    }
+
+    static constexpr size_t size() {
+        return N;
+    }
+
+    struct sent_channel_hot *hot(uint32_t n) {
+        return &m_hot[n];
+    }
+
+    const struct sent_channel_hot *hot(uint32_t n) const {
+        return &m_hot[n];
+    }
+
+    struct sent_channel_cold *cold(uint32_t n) {
+        return &m_cold[n];
+    }
+
+    const struct sent_channel_cold *cold(uint32_t n) const {
+        return &m_cold[n];
+    }
+
+    /* Anchor channel n to real time, see SENT_SetEdgeTime() */
+    void setEdgeTime(uint32_t n, const uint16_t *clocks, size_t cnt, uint32_t endTime) {
+        SENT_SetEdgeTime(&m_hot[n], clocks, cnt, endTime);
+    }
+
+    /* Feed batch of channel n to decoder of its profile, returns frames with valid CRC */
+    int decode(uint32_t n, sent_split_decoder decoder, const uint16_t *clocks, size_t cnt,
+        sent_frame_cb cb, void *arg) {
+        return decoder(&m_hot[n], &m_cold[n], clocks, cnt, cb, arg);
+    }
+
+    /* Decoder side counters of channel n. intervalOverflow belongs to capture
+     * and is left untouched */
+    void getStats(uint32_t n, struct sent_channel_stats *stats) const {
+        const struct sent_channel_hot *ch = &m_hot[n];
+        const struct sent_channel_cold *cold = &m_cold[n];
+
+        stats->tickNs = ch->tickClocks * 1000 / SENT_TIMER_CLOCK_MHZ;
+#if SENT_STATISTIC_COUNTERS
+        stats->pulseCnt = ch->PulseCnt;
+        stats->shortIntervalErr = cold->ShortIntervalErr;
+        stats->longIntervalErr = cold->LongIntervalErr;
+        stats->syncErr = cold->SyncErr;
+        stats->crcErr = cold->CrcErrCnt;
+        stats->frameCnt = cold->FrameCnt;
+        stats->slowCrcErr = cold->ScCrcErrCnt;
+        stats->slowEvict = cold->ScEvictCnt;
+        stats->lostFrames = cold->LostFrameCnt;
+#else
+        (void)cold;
+        stats->pulseCnt = 0;
+        stats->shortIntervalErr = 0;
+        stats->longIntervalErr = 0;
+        stats->syncErr = 0;
+        stats->crcErr = 0;
+        stats->frameCnt = 0;
+        stats->slowCrcErr = 0;
+        stats->slowEvict = 0;
+        stats->lostFrames = 0;
+#endif
+    }
+
+private:
+    struct sent_channel_hot m_hot[N];
+    struct sent_channel_cold m_cold[N];
+};
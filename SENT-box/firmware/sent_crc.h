@@ -0,0 +1,115 @@
+/*
+ * sent_crc.h
+ *
+ * SENT CRC4 variants, lookup tables generated at compile time.
+ * No ChibiOS/HAL dependencies here: this is also built into unit_tests.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "sent.h"
+
+/* x^4 + x^3 + x^2 + 1 */
+#define SENT_CRC4_POLY  0x1d
+
+/* Both variants are same state update, crc = nibble[crc ^ n], they only
+ * differ in seed and nibbles fed:
+ * - legacy: seed SENT_CRC_SEED, over status and data nibbles
+ * - recommended (J2716-2010): over data nibbles only, augmented with one
+ *   zero nibble at the end. Zero nibble is moved to front by linearity,
+ *   that is seed SENT_CRC_SEED already advanced over it */
+/* Unaugmented variant is recommended one without the zero nibble, see
+ * sent_crc4_unaugmented() */
+struct sent_crc4_tables {
+    /* crc after one nibble n: nibble[crc ^ n] */
+    uint8_t nibble[16];
+    /* crc after nibbles a, b: pair[((crc ^ a) << 4) | b] */
+    uint8_t pair[256];
+};
+
+/* v * x^4 mod poly: CRC register shifted by one nibble */
+constexpr uint8_t SENT_Crc4Shift(uint8_t v)
+{
+    for (int i = 0; i < 4; i++) {
+        v <<= 1;
+        if (v & 0x10) {
+            v ^= SENT_CRC4_POLY;
+        }
+    }
+    return v;
+}
+
+constexpr sent_crc4_tables SENT_Crc4MakeTables()
+{
+    sent_crc4_tables t = {};
+
+    for (int i = 0; i < 16; i++) {
+        t.nibble[i] = SENT_Crc4Shift(i);
+    }
+    for (int i = 0; i < 256; i++) {
+        t.pair[i] = t.nibble[t.nibble[i >> 4] ^ (i & 0x0f)];
+    }
+    return t;
+}
+
+inline constexpr sent_crc4_tables SENT_Crc4Tables = SENT_Crc4MakeTables();
+
+#define SENT_CRC4_SEED_LEGACY       SENT_CRC_SEED
+#define SENT_CRC4_SEED_RECOMMENDED  (SENT_Crc4Tables.nibble[SENT_CRC_SEED])
+
+static_assert(SENT_Crc4Tables.nibble[1] == 13 && SENT_Crc4Tables.nibble[15] == 5, "SENT CRC4 table");
+
+/* Incremental update with next nibble as it is received */
+static inline constexpr uint8_t SENT_Crc4Update(uint8_t crc, uint8_t nibble)
+{
+    return SENT_Crc4Tables.nibble[crc ^ nibble];
+}
+
+/* Incremental update with two nibbles, first one received first */
+static inline constexpr uint8_t SENT_Crc4Update2(uint8_t crc, uint8_t first, uint8_t second)
+{
+    return SENT_Crc4Tables.pair[((crc ^ first) << 4) | second];
+}
+
+/* crc advanced over n nibbles, two per lookup */
+static inline constexpr uint8_t SENT_Crc4(uint8_t crc, const uint8_t *nibbles, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 1 < n; i += 2) {
+        crc = SENT_Crc4Update2(crc, nibbles[i], nibbles[i + 1]);
+    }
+    if (i < n) {
+        crc = SENT_Crc4Update(crc, nibbles[i]);
+    }
+    return crc;
+}
+
+/* Legacy CRC: status and data nibbles, works for Si7215 */
+static inline uint8_t sent_crc4(const uint8_t* pdata, uint16_t ndata)
+{
+    return SENT_Crc4(SENT_CRC4_SEED_LEGACY, pdata, ndata);
+}
+
+/* Recommended CRC: data nibbles without status, used by GM sensors */
+static inline uint8_t sent_crc4_gm(const uint8_t* pdata, uint16_t ndata)
+{
+    return SENT_Crc4(SENT_CRC4_SEED_RECOMMENDED, pdata, ndata);
+}
+
+/* Recommended CRC without its final zero nibble round: seed, then
+ * crc = nibble[crc] ^ n over data nibbles. Used by GM throttle body.
+ * nibble[] of it is recommended CRC, so decoder checks it against
+ * recommended CRC register */
+static inline uint8_t sent_crc4_unaugmented(const uint8_t* pdata, uint16_t ndata)
+{
+    uint8_t crc = SENT_CRC_SEED;
+
+    for (uint16_t i = 0; i < ndata; i++) {
+        crc = SENT_Crc4Tables.nibble[crc] ^ pdata[i];
+    }
+    return crc;
+}
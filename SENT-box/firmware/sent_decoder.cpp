@@ -0,0 +1,609 @@
+/*
+ * sent_decoder.cpp
+ *
+ *  Created on: 16 May 2022
+ *      Author: alexv
+ */
+
+#include "sent_decoder.h"
+
+template <class Profile>
+static int SENT_SlowChannelDecoder(struct sent_channel_cold *ch, uint8_t status, uint32_t time);
+
+/* Measure tick from sync pulse. Division by constant is cheap, division by
+ * tick is replaced with reciprocal for every following pulse.
+ * With tick tracking sync pulse is one more sample for the filter, unless
+ * it is too far from filtered tick */
+template <class Profile>
+static inline void SENT_SetTick(struct sent_channel_hot *ch, uint16_t syncClocks)
+{
+    if (Profile::tickTracking) {
+        uint32_t measured = ((uint32_t)syncClocks << SENT_TICK_FRAC_BITS) / (SENT_SYNC_INTERVAL + SENT_OFFSET_INTERVAL);
+        int32_t diff = (int32_t)(measured - ch->tickFilt);
+
+        if ((ch->tickFilt == 0) ||
+            ((uint32_t)((diff < 0) ? -diff : diff) > (ch->tickFilt >> SENT_TICK_TRACK_WINDOW_SHIFT))) {
+            ch->tickFilt = measured;
+        } else {
+            ch->tickFilt += diff >> SENT_TICK_FILTER_SHIFT;
+        }
+        ch->tickClocks = (ch->tickFilt + (1 << (SENT_TICK_FRAC_BITS - 1))) >> SENT_TICK_FRAC_BITS;
+        ch->tickRecip = SENT_TickRecipFrac(ch->tickFilt);
+    } else {
+        ch->tickClocks = (syncClocks + 56 / 2) / (SENT_SYNC_INTERVAL + SENT_OFFSET_INTERVAL);
+        ch->tickRecip = SENT_TickRecip(ch->tickClocks);
+    }
+    ch->syncTime = ch->edgeTime;
+}
+
+/* Frame with valid CRC ended at endTime: its length in clocks over ticks it
+ * decoded to is tick averaged over whole frame, much less affected by edge
+ * jitter than single sync pulse. Filtered across frames it follows clock drift */
+static inline void SENT_TrackTick(struct sent_channel_hot *ch, uint8_t dataNibbles, uint32_t endTime)
+{
+    uint32_t ticks = (2 + dataNibbles) * SENT_OFFSET_INTERVAL + ch->nibbleSum;
+
+    uint32_t est = ((endTime - ch->frameSyncTime) << SENT_TICK_FRAC_BITS) / ticks;
+    ch->tickFilt += (int32_t)(est - ch->tickFilt) >> SENT_TICK_FILTER_SHIFT;
+}
+
+/* Data nibble d of frame into signals of profile layout */
+template <class Profile>
+static inline void SENT_FoldSignals(struct sent_channel_hot *ch, uint8_t d, uint8_t nibble)
+{
+    switch (Profile::layout) {
+        case SENT_LAYOUT_DUAL12:
+            /* see SENT_UnpackDual12() */
+            if (d < 3) {
+                ch->sig0 = (ch->sig0 << 4) | nibble;
+            } else {
+                ch->sig1 |= nibble << (4 * (d - 3));
+            }
+            break;
+        case SENT_LAYOUT_SI7215:
+            /* 12 bit field, 8 bit counter, both MSB first, then inverted first nibble */
+            if (d < 3) {
+                ch->sig0 = (ch->sig0 << 4) | nibble;
+            } else if (d < 5) {
+                ch->sig1 = (ch->sig1 << 4) | nibble;
+            }
+            break;
+        case SENT_LAYOUT_RAW:
+        default:
+            break;
+    }
+}
+
+/* Nibble index is received: fold nibble before it into CRC and signals.
+ * One nibble behind, nibble is known to be status or data and not CRC by
+ * then, also in variable length frames. Frame end is left with compare
+ * of CRC nibble only */
+template <class Profile>
+static inline void SENT_FoldNibble(struct sent_channel_hot *ch, uint8_t index, uint8_t interval)
+{
+    if (Profile::tickTracking) {
+        ch->nibbleSum = (index == 0) ? interval : ch->nibbleSum + interval;
+    }
+
+    if (index == 0) {
+        ch->crcLegacy = SENT_CRC4_SEED_LEGACY;
+        ch->crcRecommended = SENT_CRC4_SEED_RECOMMENDED;
+        ch->sig0 = 0;
+        ch->sig1 = 0;
+        return;
+    }
+
+    uint8_t prev = ch->nibbles[index - 1];
+
+    if ((Profile::crc == SENT_CRC_LEGACY) || (Profile::crc == SENT_CRC_ANY)) {
+        ch->crcLegacy = SENT_Crc4Update(ch->crcLegacy, prev);
+    }
+    if (index == 1) {
+        /* status is only covered by legacy CRC */
+        return;
+    }
+    if (Profile::crc != SENT_CRC_LEGACY) {
+        ch->crcRecommended = SENT_Crc4Update(ch->crcRecommended, prev);
+    }
+    SENT_FoldSignals<Profile>(ch, index - 2, prev);
+}
+
+/* Check CRC nibble against variant(s) profile allows, decided at compile time */
+template <class Profile>
+static inline bool SENT_CheckCrc(const struct sent_channel_hot *ch, uint8_t crc)
+{
+    switch (Profile::crc) {
+        case SENT_CRC_LEGACY:
+            return crc == ch->crcLegacy;
+        case SENT_CRC_RECOMMENDED:
+            return crc == ch->crcRecommended;
+        case SENT_CRC_UNAUGMENTED:
+            return SENT_Crc4Tables.nibble[crc] == ch->crcRecommended;
+        case SENT_CRC_ANY:
+        default:
+            return (crc == ch->crcLegacy) || (crc == ch->crcRecommended);
+    }
+}
+
+/* Good frame: frames lost since previous good one are the counter step
+ * minus one. Covers frames with bad CRC and ones dropped while out of sync,
+ * but not whole multiples of counter period */
+template <class Profile>
+static inline void SENT_CheckCounter(const struct sent_channel_hot *ch, struct sent_channel_cold *cold)
+{
+    constexpr uint8_t mask = (1 << Profile::counterBits) - 1;
+    uint8_t counter = ch->sig1 & mask;
+
+    #if SENT_STATISTIC_COUNTERS
+        if (cold->counterValid) {
+            cold->LostFrameCnt += (uint8_t)(counter - cold->counter - 1) & mask;
+        }
+    #endif // SENT_STATISTIC_COUNTERS
+    cold->counter = counter;
+    cold->counterValid = true;
+}
+
+/* Checks of profile layout on top of CRC: Si7215 repeats first data nibble
+ * inverted as last one */
+template <class Profile>
+static inline bool SENT_CheckLayout(const struct sent_channel_hot *ch)
+{
+    if (Profile::layout == SENT_LAYOUT_SI7215) {
+        return ((~ch->nibbles[1 + 5]) & 0x0f) == ch->nibbles[1 + 0];
+    }
+    return true;
+}
+
+/* All nibbles of frame are received, last one is CRC and ended at endTime */
+template <class Profile>
+static inline int SENT_FrameDone(struct sent_channel_hot *ch, struct sent_channel_cold *cold, uint8_t dataNibbles,
+    uint32_t endTime)
+{
+    #if SENT_STATISTIC_COUNTERS
+        cold->FrameCnt++;
+    #endif // SENT_STATISTIC_COUNTERS
+    ch->frameDataNibbles = dataNibbles;
+    /* same pulse may already start next frame, keep sync time of this one */
+    ch->frameSyncTime = ch->syncTime;
+
+    /* frame failing layout check would publish signals that are not there,
+     * it is counted as CRC error */
+    if ((SENT_CheckCrc<Profile>(ch, ch->nibbles[1 + dataNibbles])) && (SENT_CheckLayout<Profile>(ch))) {
+        // Full packet has been received
+        if (Profile::tickTracking) {
+            SENT_TrackTick(ch, dataNibbles, endTime);
+        }
+        if (Profile::counterBits) {
+            SENT_CheckCounter<Profile>(ch, cold);
+        }
+        return 1;
+    }
+
+    #if SENT_STATISTIC_COUNTERS
+        cold->CrcErrCnt++;
+    #endif // SENT_STATISTIC_COUNTERS
+    return -1;
+}
+
+/* Single pulse step, inlined into both the per-pulse and the batch entry points */
+template <class Profile>
+static inline __attribute__((always_inline)) int SENT_DecodePulse(struct sent_channel_hot *ch, struct sent_channel_cold *cold, uint16_t clocks)
+{
+    int ret = 0;
+
+    #if SENT_STATISTIC_COUNTERS
+        ch->PulseCnt++;
+    #endif
+
+    ch->edgeTime += clocks;
+
+    /* Capture lost edges or line was idle too long for 16 bits. Right after CRC
+     * nibble this is only a long pause (and end of variable length frame), takes
+     * same path as any long pulse below. Otherwise frame in progress and serial
+     * message are lost, but no pulse was malformed, so no error is counted */
+    if ((clocks == SENT_GAP_INTERVAL) && (ch->state != SM_SENT_PAUSE_STATE) &&
+        ((Profile::dataNibbles != SENT_DATA_NIBBLES_AUTO) ||
+         (ch->state < SM_SENT_STATUS_STATE + 3) || (ch->state > SM_SENT_CRC_STATE))) {
+        ch->state = SM_SENT_INIT_STATE;
+        cold->scShift2 = 0;
+        cold->scShift3 = 0;
+        return -1;
+    }
+
+    /* pulse looks like sync with allowed +/-20% deviation from nominal tick.
+     * Does not depend on tick measured so far, so it also finds sync after a
+     * pause pulse that was taken for sync */
+    bool syncLike = (clocks >= (Profile::syncClocks * 80 / 100)) &&
+                    (clocks <= (Profile::syncClocks * 120 / 100));
+
+    /* special case for out-of-sync state */
+    if ((ch->state == SM_SENT_INIT_STATE) && (syncLike)) {
+        /* calculate tick time */
+        SENT_SetTick<Profile>(ch, clocks);
+        /* next state */
+        ch->state = SM_SENT_STATUS_STATE;
+        /* done for this pulse */
+        return 0;
+    }
+
+    if (ch->tickClocks == 0) {
+        /* no sync pulse seen yet, nothing to measure against */
+        return 0;
+    }
+
+    int interval = SENT_PulseTicks(clocks, ch->tickClocks, ch->tickRecip) - SENT_OFFSET_INTERVAL;
+
+    if (interval < 0) {
+        #if SENT_STATISTIC_COUNTERS
+            cold->ShortIntervalErr++;
+        #endif //SENT_STATISTIC_COUNTERS
+        ch->state = SM_SENT_INIT_STATE;
+        return -1;
+    }
+
+    switch(ch->state)
+    {
+        case SM_SENT_INIT_STATE:
+            /* handles above, should not get in here */
+            break;
+
+        case SM_SENT_PAUSE_STATE:
+            if ((interval != SENT_SYNC_INTERVAL) && (!syncLike))
+            {
+                /* pause pulse, sync should follow */
+                ch->state = SM_SENT_SYNC_STATE;
+                break;
+            }
+            /* pause is optional, this is sync already */
+            /* Falls through. */
+        case SM_SENT_SYNC_STATE:
+            if ((interval == SENT_SYNC_INTERVAL) || (syncLike))
+            {// sync interval - 56 ticks
+                /* measured tick interval will be used until next sync pulse */
+                SENT_SetTick<Profile>(ch, clocks);
+                ch->state = SM_SENT_STATUS_STATE;
+            }
+            else
+            {
+                #if SENT_STATISTIC_COUNTERS
+                    // Increment sync interval err count
+                    cold->SyncErr++;
+                    if (interval > SENT_SYNC_INTERVAL)
+                    {
+                        cold->LongIntervalErr++;
+                    }
+                    else
+                    {
+                        cold->ShortIntervalErr++;
+                    }
+                #endif // SENT_STATISTIC_COUNTERS
+                /* wait for next sync and recalibrate tickClocks */
+                ch->state = SM_SENT_INIT_STATE;
+            }
+            break;
+
+        case SM_SENT_STATUS_STATE:
+        case SM_SENT_SIG1_DATA1_STATE:
+        case SM_SENT_SIG1_DATA2_STATE:
+        case SM_SENT_SIG1_DATA3_STATE:
+        case SM_SENT_SIG2_DATA1_STATE:
+        case SM_SENT_SIG2_DATA2_STATE:
+        case SM_SENT_SIG2_DATA3_STATE:
+        case SM_SENT_CRC_STATE:
+        {
+            uint8_t index = ch->state - SM_SENT_STATUS_STATE;
+
+            if(interval <= SENT_MAX_INTERVAL)
+            {
+                SENT_FoldNibble<Profile>(ch, index, interval);
+                ch->nibbles[index] = interval;
+
+                /* status, data nibbles, CRC. Variable length frame is done when buffer is full */
+                if (((Profile::dataNibbles != SENT_DATA_NIBBLES_AUTO) && (index == 1 + Profile::dataNibbles)) ||
+                    (index == SENT_MSG_PAYLOAD_SIZE - 1))
+                {
+                    ret = SENT_FrameDone<Profile>(ch, cold, index - 1, ch->edgeTime);
+                    ch->state = Profile::pausePulse ? SM_SENT_PAUSE_STATE : SM_SENT_SYNC_STATE;
+                }
+                else
+                {
+                    /* TODO: refactor */
+                    ch->state = (SM_SENT_enum)((int)ch->state + 1);
+                }
+                break;
+            }
+
+            /* too long for a nibble */
+            if ((Profile::dataNibbles == SENT_DATA_NIBBLES_AUTO) && (index >= 3))
+            {
+                /* variable length frame ends with sync or pause, last nibble was CRC */
+                ret = SENT_FrameDone<Profile>(ch, cold, index - 2, ch->edgeTime - clocks);
+                ch->state = SM_SENT_SYNC_STATE;
+            }
+            else if (index != 0)
+            {
+                /* frame is truncated */
+                #if SENT_STATISTIC_COUNTERS
+                    cold->LongIntervalErr++;
+                #endif
+                ch->state = SM_SENT_INIT_STATE;
+            }
+            else if (!syncLike)
+            {
+                #if SENT_STATISTIC_COUNTERS
+                    cold->LongIntervalErr++;
+                #endif
+                ch->state = SM_SENT_INIT_STATE;
+            }
+
+            if (syncLike)
+            {
+                /* resync right on this pulse instead of waiting for next one, so no
+                 * frame is lost. Right after sync this means previous "sync" was a
+                 * pause pulse close to sync length, not an error */
+                SENT_SetTick<Profile>(ch, clocks);
+                ch->state = SM_SENT_STATUS_STATE;
+            }
+            break;
+        }
+    }
+
+    if (ret > 0) {
+        /* valid packet received, can process slow channels */
+        SENT_SlowChannelDecoder<Profile>(cold, ch->nibbles[0], ch->frameSyncTime);
+    } else if (ret < 0) {
+        /* packet is incorrect, reset slow channel state machine */
+        cold->scShift2 = 0;
+        cold->scShift3 = 0;
+    }
+
+    return ret;
+}
+
+template <class Profile>
+int SENT_Decoder(struct sent_channel *ch, uint16_t clocks)
+{
+    return SENT_DecodePulse<Profile>(ch, ch, clocks);
+}
+
+template <class Profile>
+int SENT_DecodeBatch(struct sent_channel_hot *ch, struct sent_channel_cold *cold,
+    const uint16_t *clocks, size_t n, sent_frame_cb cb, void *arg)
+{
+    int frames = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        if (SENT_DecodePulse<Profile>(ch, cold, clocks[i]) > 0) {
+            frames++;
+            if (cb) {
+                cb(ch, arg);
+            }
+        }
+    }
+
+    return frames;
+}
+
+template <class Profile>
+int SENT_DecodeBatch(struct sent_channel *ch, const uint16_t *clocks, size_t n, sent_frame_cb cb, void *arg)
+{
+    return SENT_DecodeBatch<Profile>(ch, ch, clocks, n, cb, arg);
+}
+
+#define SENT_DECODER_INSTANTIATE(profile) \
+    template int SENT_Decoder<profile>(struct sent_channel *, uint16_t); \
+    template int SENT_DecodeBatch<profile>(struct sent_channel_hot *, struct sent_channel_cold *, \
+        const uint16_t *, size_t, sent_frame_cb, void *); \
+    template int SENT_DecodeBatch<profile>(struct sent_channel *, const uint16_t *, size_t, sent_frame_cb, void *)
+
+SENT_DECODER_INSTANTIATE(SentProfileDefault);
+SENT_DECODER_INSTANTIATE(SentProfileGmEtb);
+SENT_DECODER_INSTANTIATE(SentProfileGmFuelPressure);
+SENT_DECODER_INSTANTIATE(SentProfileSi7215);
+SENT_DECODER_INSTANTIATE(SentProfileFord);
+SENT_DECODER_INSTANTIATE(SentProfileVariableLength);
+SENT_DECODER_INSTANTIATE(SentProfileTracked<SentProfileGmEtb>);
+SENT_DECODER_INSTANTIATE(SentProfileTracked<SentProfileGmFuelPressure>);
+SENT_DECODER_INSTANTIATE(SentProfileTracked<SentProfileSi7215>);
+SENT_DECODER_INSTANTIATE(SentProfileTracked<SentProfileFord>);
+SENT_DECODER_INSTANTIATE(SentProfileTracked<SentProfileVariableLength>);
+
+int SENT_Decoder(struct sent_channel *ch, uint16_t clocks)
+{
+    return SENT_DecodePulse<SentProfileDefault>(ch, ch, clocks);
+}
+
+int SENT_DecodeBatch(struct sent_channel *ch, const uint16_t *clocks, size_t n, sent_frame_cb cb, void *arg)
+{
+    return SENT_DecodeBatch<SentProfileDefault>(ch, clocks, n, cb, arg);
+}
+
+static inline uint32_t SENT_SlowMsgHash(sent_slow_format format, uint8_t id)
+{
+    /* 4 bit IDs of different formats land on different slots */
+    return (id ^ (id >> 4) ^ (format * 5)) & (SENT_SLOW_MSG_SLOTS - 1);
+}
+
+int SENT_SlowMsgFind(const struct sent_channel_cold *ch, sent_slow_format format, uint8_t id)
+{
+    uint32_t h = SENT_SlowMsgHash(format, id);
+
+    for (uint32_t p = 0; p < SENT_SLOW_MSG_PROBE; p++) {
+        uint32_t i = (h + p) & (SENT_SLOW_MSG_SLOTS - 1);
+        const struct sent_slow_msg *msg = &ch->scMsg[i];
+
+        if ((ch->scMsgFlags & (1 << i)) && (msg->id == id) && (msg->format == format)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+void SENT_SlowMsgStore(struct sent_channel_cold *ch, sent_slow_format format, uint8_t id, uint16_t data, uint32_t time)
+{
+    uint32_t seq = ++ch->scMsgSeq;
+
+    /* age out one slot per message, whole table is swept every SENT_SLOW_MSG_SLOTS messages */
+    uint32_t sweep = seq & (SENT_SLOW_MSG_SLOTS - 1);
+    if (seq - ch->scMsg[sweep].seq > SENT_SLOW_MSG_MAX_AGE) {
+        ch->scMsgFlags &= ~(1 << sweep);
+    }
+
+    /* one pass over probe window: same message, else free slot, else least recently updated */
+    uint32_t h = SENT_SlowMsgHash(format, id);
+    int slot = -1;
+    int victim = -1;
+    uint32_t victimAge = 0;
+
+    for (uint32_t p = 0; p < SENT_SLOW_MSG_PROBE; p++) {
+        uint32_t i = (h + p) & (SENT_SLOW_MSG_SLOTS - 1);
+
+        if ((ch->scMsgFlags & (1 << i)) == 0) {
+            if (victimAge != UINT32_MAX) {
+                victim = i;
+                victimAge = UINT32_MAX;
+            }
+        } else if ((ch->scMsg[i].id == id) && (ch->scMsg[i].format == format)) {
+            slot = i;
+            break;
+        } else if ((victim < 0) || (seq - ch->scMsg[i].seq > victimAge)) {
+            victim = i;
+            victimAge = seq - ch->scMsg[i].seq;
+        }
+    }
+
+    if (slot < 0) {
+        slot = victim;
+        #if SENT_STATISTIC_COUNTERS
+            if (ch->scMsgFlags & (1 << slot)) {
+                ch->ScEvictCnt++;
+            }
+        #endif
+        ch->scMsg[slot].id = id;
+        ch->scMsg[slot].format = format;
+        ch->scMsg[slot].count = 0;
+        ch->scMsgFlags |= (1 << slot);
+    }
+
+    struct sent_slow_msg *msg = &ch->scMsg[slot];
+    msg->data = data;
+    msg->time = time;
+    msg->count++;
+    msg->seq = seq;
+}
+
+static inline void SENT_SlowCrcError(struct sent_channel_cold *ch)
+{
+    #if SENT_STATISTIC_COUNTERS
+        ch->ScCrcErrCnt++;
+    #else
+        (void)ch;
+    #endif
+}
+
+template <class Profile>
+static int SENT_SlowChannelDecoder(struct sent_channel_cold *ch, uint8_t status, uint32_t time)
+{
+    /* bit 2 and bit 3 from status nibble are used to transfer short messages */
+    bool b2 = !!(status & (1 << 2));
+    bool b3 = !!(status & (1 << 3));
+
+    /* shift in new data */
+    ch->scShift2 = (ch->scShift2 << 1) | b2;
+    ch->scShift3 = (ch->scShift3 << 1) | b3;
+
+    if (1) {
+        /* Short Serial Message format */
+
+        /* 0b1000.0000.0000.0000? */
+        if ((ch->scShift3 & 0xffff) == 0x8000) {
+            /* Done receiving: ID, data, CRC nibbles.
+             * CRC is same as fast channel CRC over 3 nibbles, variant per profile */
+            uint8_t msg[4] = {
+                (uint8_t)((ch->scShift2 >> 12) & 0x0f),
+                (uint8_t)((ch->scShift2 >> 8) & 0x0f),
+                (uint8_t)((ch->scShift2 >> 4) & 0x0f),
+                (uint8_t)((ch->scShift2 >> 0) & 0x0f),
+            };
+            bool crcOk;
+
+            switch (Profile::crc) {
+                case SENT_CRC_LEGACY:
+                    crcOk = (msg[3] == sent_crc4(msg, 3));
+                    break;
+                case SENT_CRC_RECOMMENDED:
+                    crcOk = (msg[3] == sent_crc4_gm(msg, 3));
+                    break;
+                case SENT_CRC_UNAUGMENTED:
+                    crcOk = (msg[3] == sent_crc4_unaugmented(msg, 3));
+                    break;
+                default:
+                    crcOk = (msg[3] == sent_crc4(msg, 3)) || (msg[3] == sent_crc4_gm(msg, 3));
+                    break;
+            }
+
+            if (crcOk) {
+                SENT_SlowMsgStore(ch, SENT_SLOW_SHORT, msg[0], (msg[1] << 4) | msg[2], time);
+            } else {
+                SENT_SlowCrcError(ch);
+            }
+        }
+    }
+    if (1) {
+        /* Enhanced Serial Message format */
+
+        /* 0b11.1111.0xxx.xx0x.xxx0 ? */
+        if ((ch->scShift3 & 0x3f821) == 0x3f000) {
+            uint8_t id;
+            uint16_t data;
+
+            /* 6 bit CRC comes in bit 2 of first 6 frames, covers the rest */
+            if (((ch->scShift2 >> 12) & 0x3f) != sent_crc6(ch->scShift2 & 0x0fff, ch->scShift3 & 0x0fff)) {
+                SENT_SlowCrcError(ch);
+                return 0;
+            }
+
+            /* C: configuration bit is used to indicate 16 bit format */
+            ch->sc16Bit = !!(ch->scShift3 & (1 << 10));
+            if (!ch->sc16Bit) {
+                /* 12 bit message, 8 bit ID */
+                id = ((ch->scShift3 >> 1) & 0x0f) |
+                     ((ch->scShift3 >> 2) & 0xf0);
+                data = ch->scShift2 & 0x0fff; /* 12 bit */
+
+                SENT_SlowMsgStore(ch, SENT_SLOW_ENHANCED_12, id, data, time);
+            } else {
+                /* 16 bit message, 4 bit ID */
+                data = (ch->scShift2 & 0x0fff) |
+                       (((ch->scShift3 >> 1) & 0x0f) << 12);
+                id = (ch->scShift3 >> 6) & 0x0f;
+
+                SENT_SlowMsgStore(ch, SENT_SLOW_ENHANCED_16, id, data, time);
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* x^6 + x^4 + x^3 + 1, seed 010101, message augmented with six zero bits */
+uint8_t sent_crc6(uint16_t bits2, uint16_t bits3)
+{
+    uint32_t crc = 0x15;
+
+    for (int i = 11; i >= -3; i--) {
+        /* two message bits per frame, zeros for augmentation */
+        uint32_t in = (i >= 0) ? ((((bits2 >> i) & 1) << 1) | ((bits3 >> i) & 1)) : 0;
+
+        crc = (crc << 2) | in;
+        if (crc & 0x80) {
+            crc ^= 0x59 << 1;
+        }
+        if (crc & 0x40) {
+            crc ^= 0x59;
+        }
+    }
+
+    return crc & 0x3f;
+}
@@ -0,0 +1,211 @@
+/*
+ * sent_decoder.h
+ *
+ * SENT decoder state machine, CRC and slow channel decoder.
+ * No ChibiOS/HAL dependencies here: this is also built into unit_tests.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "sent.h"
+#include "sent_crc.h"
+#include "sent_profile.h"
+
+/* Slow channel message formats, ID spaces of formats are separate */
+typedef enum {
+    SENT_SLOW_SHORT = 0,        /* 4 bit ID, 8 bit data */
+    SENT_SLOW_ENHANCED_12,      /* 8 bit ID, 12 bit data */
+    SENT_SLOW_ENHANCED_16,      /* 4 bit ID, 16 bit data */
+} sent_slow_format;
+
+#define SENT_SLOW_FORMATS       3
+
+/* Size of ID space of format */
+static inline uint32_t SENT_SlowIdCount(sent_slow_format format)
+{
+    return (format == SENT_SLOW_ENHANCED_12) ? 256 : 16;
+}
+
+/* Mailbox table: slot is picked by hash of format and ID, probing few
+ * next slots. Message not refreshed for SENT_SLOW_MSG_MAX_AGE serial
+ * messages is dropped, when all probed slots are live oldest one is reused */
+#define SENT_SLOW_MSG_SLOTS     16
+#define SENT_SLOW_MSG_PROBE     4
+#define SENT_SLOW_MSG_MAX_AGE   64
+
+struct sent_slow_msg {
+    uint16_t data;
+    uint8_t id;
+    uint8_t format;
+    /* frameSyncTime of frame completing last update */
+    uint32_t time;
+    /* updates since message got slot */
+    uint32_t count;
+    /* scMsgSeq at last update */
+    uint32_t seq;
+};
+
+/* Decoder state is split by access rate. Hot part is touched by every
+ * pulse and is kept small, so state of all channels packs into few cache
+ * lines (see SentChannelSet). Cold part is only touched on frame end,
+ * errors and by readers of slow channel and stats */
+struct sent_channel_hot {
+    SM_SENT_enum state;
+    uint8_t nibbles[SENT_MSG_PAYLOAD_SIZE];
+    /* data nibbles in last frame, differs from profile only for SENT_DATA_NIBBLES_AUTO */
+    uint8_t frameDataNibbles;
+    /* Running CRC of both variants and signals of frame being received, nibble
+     * is folded in when next one arrives. Complete on frame end, signals stay
+     * valid until status nibble of next frame */
+    uint8_t crcLegacy;
+    uint8_t crcRecommended;
+    /* sum of nibble values so far, for tick tracking */
+    uint8_t nibbleSum;
+    uint16_t sig0;
+    uint16_t sig1;
+    /* Tick interval in CPU clocks - adjusted on SYNC */
+    uint32_t tickClocks;
+    /* SENT_TickRecip(tickClocks), updated together with tickClocks */
+    uint32_t tickRecip;
+
+    /* Capture time of last edge fed to decoder, capture clocks. Advanced by each
+     * interval, caller anchors it to real time with SENT_SetEdgeTime() */
+    uint32_t edgeTime;
+    /* edgeTime of falling edge ending last sync pulse */
+    uint32_t syncTime;
+    /* syncTime of last completed frame */
+    uint32_t frameSyncTime;
+    /* Filtered tick, 1/2^SENT_TICK_FRAC_BITS clocks. Profiles with tick tracking only, 0 - no estimate yet */
+    uint32_t tickFilt;
+
+#if SENT_STATISTIC_COUNTERS
+    /* counted on every pulse, so lives with hot state */
+    uint32_t PulseCnt;
+#endif // SENT_STATISTIC_COUNTERS
+};
+
+struct sent_channel_cold {
+    /* slow channel stuff */
+    struct sent_slow_msg scMsg[SENT_SLOW_MSG_SLOTS];
+    uint16_t scMsgFlags;    /* bit i set if scMsg[i] holds message */
+    uint32_t scMsgSeq;      /* serial messages received with valid CRC */
+    uint32_t scShift2;   /* shift register for bit 2 from status nibble */
+    uint32_t scShift3;   /* shift register for bit 3 from status nibble */
+    bool sc16Bit;       /* C-flag */
+
+    /* rolling counter of last good frame, profiles with counterBits only */
+    uint8_t counter;
+    bool counterValid;
+
+#if SENT_STATISTIC_COUNTERS
+    /* stats */
+    uint32_t ShortIntervalErr;
+    uint32_t LongIntervalErr;
+    uint32_t SyncErr;
+    uint32_t CrcErrCnt;
+    uint32_t FrameCnt;
+    uint32_t ScCrcErrCnt;   /* slow channel messages with bad CRC */
+    uint32_t ScEvictCnt;    /* live slow channel messages pushed out by new ID */
+    uint32_t LostFrameCnt;  /* frames missing from rolling counter sequence */
+#endif // SENT_STATISTIC_COUNTERS
+};
+
+/* Single channel with both parts in one place */
+struct sent_channel : sent_channel_hot, sent_channel_cold {
+};
+
+/* ceil(2^32 / tickClocks), tickClocks should be at least 2 */
+static inline uint32_t SENT_TickRecip(uint32_t tickClocks)
+{
+    return 0xffffffffUL / tickClocks + 1;
+}
+
+/* Tick tracking: fraction bits of tickFilt, filter gain 1/2^SENT_TICK_FILTER_SHIFT
+ * per frame. Sync pulse further than 1/2^SENT_TICK_TRACK_WINDOW_SHIFT from filtered
+ * tick means track is lost (sensor restarted, other sensor), filter restarts from it */
+#define SENT_TICK_FRAC_BITS             8
+#define SENT_TICK_FILTER_SHIFT          3
+#define SENT_TICK_TRACK_WINDOW_SHIFT    5
+
+/* ceil(2^(32 + SENT_TICK_FRAC_BITS) / tickFilt): reciprocal of fractional tick. Rounding
+ * in SENT_PulseTicks() is then exact to 2^-SENT_TICK_FRAC_BITS clock, not to the bit */
+static inline uint32_t SENT_TickRecipFrac(uint32_t tickFilt)
+{
+    return (uint32_t)((((uint64_t)1 << (32 + SENT_TICK_FRAC_BITS)) - 1) / tickFilt + 1);
+}
+
+/* Pulse length in ticks rounded to nearest: same as (clocks + tickClocks / 2) / tickClocks
+ * but with multiply and shift instead of division. Exact for any 16 bit clocks
+ * while tickClocks < 32768, rounding error of reciprocal never reaches next integer */
+static inline uint32_t SENT_PulseTicks(uint16_t clocks, uint32_t tickClocks, uint32_t tickRecip)
+{
+    return ((uint64_t)(clocks + tickClocks / 2) * tickRecip) >> 32;
+}
+
+/* Called for each frame with valid CRC, frame nibbles are in ch->nibbles,
+ * signals of profile layout in ch->sig0 and ch->sig1 */
+typedef void (*sent_frame_cb)(struct sent_channel_hot *ch, void *arg);
+
+/* Anchor edge time before decoding batch: last of n intervals ends with edge captured at endTime */
+static inline void SENT_SetEdgeTime(struct sent_channel_hot *ch, const uint16_t *clocks, size_t n, uint32_t endTime)
+{
+    uint32_t sum = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        sum += clocks[i];
+    }
+    ch->edgeTime = endTime - sum;
+}
+
+/* Feed one falling edge to falling edge interval (in CPU clocks) to the decoder.
+ * Returns 1 when full frame with valid CRC is received, -1 on error, 0 otherwise */
+template <class Profile>
+int SENT_Decoder(struct sent_channel *ch, uint16_t clocks);
+
+/* Feed n intervals of one channel at once, cb (if not null) is called for every good frame.
+ * Returns number of frames with valid CRC */
+template <class Profile>
+int SENT_DecodeBatch(struct sent_channel *ch, const uint16_t *clocks, size_t n, sent_frame_cb cb, void *arg);
+/* Same with hot and cold parts of channel kept apart */
+template <class Profile>
+int SENT_DecodeBatch(struct sent_channel_hot *ch, struct sent_channel_cold *cold,
+    const uint16_t *clocks, size_t n, sent_frame_cb cb, void *arg);
+
+/* Same as above with SentProfileDefault */
+int SENT_Decoder(struct sent_channel *ch, uint16_t clocks);
+int SENT_DecodeBatch(struct sent_channel *ch, const uint16_t *clocks, size_t n, sent_frame_cb cb, void *arg);
+
+/* SENT_DecodeBatch<Profile> for per channel dispatch, one indirect call per batch */
+typedef int (*sent_batch_decoder)(struct sent_channel *ch, const uint16_t *clocks, size_t n, sent_frame_cb cb, void *arg);
+typedef int (*sent_split_decoder)(struct sent_channel_hot *ch, struct sent_channel_cold *cold,
+    const uint16_t *clocks, size_t n, sent_frame_cb cb, void *arg);
+
+/* Profiles instantiated in sent_decoder.cpp */
+#define SENT_DECODER_EXTERN(profile) \
+    extern template int SENT_Decoder<profile>(struct sent_channel *, uint16_t); \
+    extern template int SENT_DecodeBatch<profile>(struct sent_channel_hot *, struct sent_channel_cold *, \
+        const uint16_t *, size_t, sent_frame_cb, void *); \
+    extern template int SENT_DecodeBatch<profile>(struct sent_channel *, const uint16_t *, size_t, sent_frame_cb, void *)
+
+SENT_DECODER_EXTERN(SentProfileDefault);
+SENT_DECODER_EXTERN(SentProfileGmEtb);
+SENT_DECODER_EXTERN(SentProfileGmFuelPressure);
+SENT_DECODER_EXTERN(SentProfileSi7215);
+SENT_DECODER_EXTERN(SentProfileFord);
+SENT_DECODER_EXTERN(SentProfileVariableLength);
+SENT_DECODER_EXTERN(SentProfileTracked<SentProfileGmEtb>);
+SENT_DECODER_EXTERN(SentProfileTracked<SentProfileGmFuelPressure>);
+SENT_DECODER_EXTERN(SentProfileTracked<SentProfileSi7215>);
+SENT_DECODER_EXTERN(SentProfileTracked<SentProfileFord>);
+SENT_DECODER_EXTERN(SentProfileTracked<SentProfileVariableLength>);
+
+/* Slot of slow channel message, -1 if it was not received or already aged out */
+int SENT_SlowMsgFind(const struct sent_channel_cold *ch, sent_slow_format format, uint8_t id);
+/* Received serial message with valid CRC in frame synced at time, called by decoder */
+void SENT_SlowMsgStore(struct sent_channel_cold *ch, sent_slow_format format, uint8_t id, uint16_t data, uint32_t time);
+
+/* Enhanced serial message CRC over bit 2 and bit 3 of 12 last frames, bit 2 first */
+uint8_t sent_crc6(uint16_t bits2, uint16_t bits3);
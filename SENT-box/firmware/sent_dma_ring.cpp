@@ -0,0 +1,57 @@
+/*
+ * sent_dma_ring.cpp
+ *
+ * Circular DMA capture buffer to interval conversion
+ */
+
+#include "sent_dma_ring.h"
+
+void SENT_DmaRingInit(struct sent_dma_ring *r, const volatile uint16_t *buf, uint16_t size)
+{
+    r->buf = buf;
+    r->size = size;
+    r->nextHalf = 0;
+    r->haveLast = false;
+    r->last = 0;
+    r->overruns = 0;
+}
+
+size_t SENT_DmaRingHalf(struct sent_dma_ring *r, uint8_t half, uint16_t dmaRemaining, uint16_t *out)
+{
+    const uint16_t halfSize = r->size / 2;
+    const uint16_t start = half ? halfSize : 0;
+    /* next entry DMA is going to write */
+    const uint16_t dmaPos = (r->size - dmaRemaining) % r->size;
+    size_t n = 0;
+
+    /* missed event or DMA is already overwriting this half */
+    if ((half != r->nextHalf) ||
+        ((dmaPos >= start) && (dmaPos < start + halfSize))) {
+        r->overruns++;
+        r->nextHalf = !half;
+        if (r->haveLast) {
+            out[n++] = SENT_DMA_GAP_INTERVAL;
+        }
+        r->haveLast = false;
+        return n;
+    }
+    r->nextHalf = !half;
+
+    uint16_t last = r->last;
+    size_t i = 0;
+    if (!r->haveLast) {
+        /* very first capture, nothing to measure from */
+        last = r->buf[start];
+        i = 1;
+        r->haveLast = true;
+    }
+    for (; i < halfSize; i++) {
+        uint16_t capture = r->buf[start + i];
+        /* 16 bit counter wraps, unsigned subtraction handles it */
+        out[n++] = (uint16_t)(capture - last);
+        last = capture;
+    }
+    r->last = last;
+
+    return n;
+}
@@ -0,0 +1,41 @@
+/*
+ * sent_dma_ring.h
+ *
+ * Consumer side of a circular DMA buffer of 16 bit timer input captures.
+ * DMA writes absolute counter values, half/full transfer events hand one half
+ * of the buffer over to the decoder thread which converts it into intervals.
+ * No ChibiOS/HAL dependencies here: this is also built into unit_tests.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "sent.h"
+
+/* Emitted in place of the lost pulses when the consumer fell behind DMA */
+#define SENT_DMA_GAP_INTERVAL   SENT_GAP_INTERVAL
+
+struct sent_dma_ring {
+    const volatile uint16_t *buf;
+    /* entries in buffer, even */
+    uint16_t size;
+    /* half we expect next, 0 - first, 1 - second */
+    uint8_t nextHalf;
+    /* last capture of previously processed half is valid */
+    bool haveLast;
+    uint16_t last;
+
+    uint32_t overruns;
+};
+
+void SENT_DmaRingInit(struct sent_dma_ring *r, const volatile uint16_t *buf, uint16_t size);
+
+/* Convert one half of the buffer to intervals.
+ * half: 0 on half transfer event, 1 on transfer complete event.
+ * dmaRemaining: DMA remaining transfer counter (NDTR) sampled now, used to check
+ * DMA has not come back to the half being read.
+ * out: room for size / 2 intervals.
+ * Returns number of intervals written to out */
+size_t SENT_DmaRingHalf(struct sent_dma_ring *r, uint8_t half, uint16_t dmaRemaining, uint16_t *out);
@@ -0,0 +1,65 @@
+/*
+ * sent_edge_capture.h
+ *
+ * Edge timestamps of free running 32 bit cycle counter (DWT CYCCNT) to
+ * intervals, for capture on any EXTI line. Interval is kept in 32 bits
+ * until it is known to fit: longer one is passed as SENT_GAP_INTERVAL.
+ * Edges too close to previous one are dropped as glitches.
+ * No ChibiOS/HAL dependencies here: this is also built into unit_tests.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "sent.h"
+
+struct sent_edge_capture {
+    /* counter at last accepted edge */
+    uint32_t last;
+    bool haveLast;
+    /* edges closer than this to last accepted one are glitches, 0 - no filter */
+    uint32_t minClocks;
+
+    uint32_t glitches;
+    uint32_t gaps;
+};
+
+static inline void SENT_EdgeCaptureInit(struct sent_edge_capture *c, uint32_t minClocks)
+{
+    c->last = 0;
+    c->haveLast = false;
+    c->minClocks = minClocks;
+    c->glitches = 0;
+    c->gaps = 0;
+}
+
+/* Falling edge seen with counter at now. Returns true with interval since
+ * last accepted edge in *clocks, false if there is nothing to decode: first
+ * edge or glitch. Glitch does not move last edge, so next edge still gets
+ * whole interval. Counter wrap is handled by unsigned difference, gap of
+ * whole counter period (~60 s at 72 MHz) and more can not be told apart */
+static inline bool SENT_EdgeCapture(struct sent_edge_capture *c, uint32_t now, uint16_t *clocks)
+{
+    uint32_t delta = now - c->last;
+
+    if (!c->haveLast) {
+        c->haveLast = true;
+        c->last = now;
+        return false;
+    }
+
+    if (delta < c->minClocks) {
+        c->glitches++;
+        return false;
+    }
+
+    c->last = now;
+    if (delta >= SENT_GAP_INTERVAL) {
+        c->gaps++;
+        *clocks = SENT_GAP_INTERVAL;
+    } else {
+        *clocks = delta;
+    }
+    return true;
+}
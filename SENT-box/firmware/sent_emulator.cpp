@@ -0,0 +1,216 @@
+/*
+ * sent_emulator.cpp
+ *
+ * SENT transmitter model
+ */
+
+#include <cstring>
+
+#include "sent_emulator.h"
+
+static inline uint32_t SENT_EmuRandom(struct sent_emulator *emu)
+{
+    /* xorshift32, never 0 */
+    uint32_t x = emu->rnd;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    emu->rnd = x;
+    return x;
+}
+
+static inline bool SENT_EmuInject(struct sent_emulator *emu, uint32_t rate)
+{
+    return (rate) && ((SENT_EmuRandom(emu) & (SENT_EMU_RATE_ONE - 1)) < rate);
+}
+
+void SENT_EmuInit(struct sent_emulator *emu, const struct sent_emu_cfg *cfg)
+{
+    memset(emu, 0, sizeof(*emu));
+    emu->cfg = *cfg;
+    emu->tickFrac = cfg->tickFrac;
+    emu->drift = cfg->tickDrift;
+    emu->rnd = cfg->seed ? cfg->seed : 1;
+}
+
+static inline uint8_t SENT_EmuCrc(sent_crc_type crc, const uint8_t *nibbles, uint8_t n)
+{
+    switch (crc) {
+        case SENT_CRC_LEGACY:
+            return sent_crc4(nibbles, n);
+        case SENT_CRC_UNAUGMENTED:
+            return sent_crc4_unaugmented(nibbles, n);
+        default:
+            return sent_crc4_gm(nibbles, n);
+    }
+}
+
+/* Serial message bits, sent in bit 2 and bit 3 of status nibble, inverse of SENT_SlowChannelDecoder() */
+static void SENT_EmuSlowLoad(struct sent_emulator *emu, const struct sent_emu_slow_msg *msg)
+{
+    if (msg->format == SENT_SLOW_SHORT) {
+        /* bit 3: 1 then 15 zeros. Bit 2: ID, 8 bit data, CRC nibbles */
+        uint8_t nibbles[3] = {
+            (uint8_t)(msg->id & 0x0f),
+            (uint8_t)((msg->data >> 4) & 0x0f),
+            (uint8_t)(msg->data & 0x0f),
+        };
+        uint8_t crc = SENT_EmuCrc(emu->cfg.crc, nibbles, 3);
+
+        emu->scBits3 = 0x8000;
+        emu->scBits2 = (nibbles[0] << 12) | (nibbles[1] << 8) | (nibbles[2] << 4) | crc;
+        emu->scLeft = 16;
+        return;
+    }
+
+    /* bit 3: 111111 0 C xxxx 0 xxxx 0, bit 2: 6 bit CRC and 12 bit data */
+    uint32_t bits3 = 0x3f000;
+    if (msg->format == SENT_SLOW_ENHANCED_12) {
+        bits3 |= ((msg->id & 0xf0) << 2) | ((msg->id & 0x0f) << 1);
+    } else {
+        bits3 |= (1 << 10) | ((msg->id & 0x0f) << 6) | (((msg->data >> 12) & 0x0f) << 1);
+    }
+    uint32_t bits2 = msg->data & 0x0fff;
+
+    emu->scBits3 = bits3;
+    emu->scBits2 = (sent_crc6(bits2, bits3 & 0x0fff) << 12) | bits2;
+    emu->scLeft = 18;
+}
+
+/* Status nibble bits 2 and 3 of next frame */
+static uint8_t SENT_EmuSlowBits(struct sent_emulator *emu)
+{
+    if ((emu->scLeft == 0) && (emu->cfg.slowNum)) {
+        SENT_EmuSlowLoad(emu, &emu->cfg.slow[emu->scNext]);
+        emu->scNext = (emu->scNext + 1) % emu->cfg.slowNum;
+    }
+    if (emu->scLeft == 0) {
+        return 0;
+    }
+
+    emu->scLeft--;
+    uint8_t bits = (((emu->scBits2 >> emu->scLeft) & 1) << 2) |
+                   (((emu->scBits3 >> emu->scLeft) & 1) << 3);
+    if (emu->scLeft == 0) {
+        emu->slowMsgCnt++;
+    }
+
+    return bits;
+}
+
+static void SENT_EmuDrift(struct sent_emulator *emu)
+{
+    if (emu->drift == 0) {
+        return;
+    }
+    emu->tickFrac += emu->drift;
+
+    int32_t off = (int32_t)(emu->tickFrac - emu->cfg.tickFrac);
+    if (((off > 0) && (emu->drift > 0) && ((uint32_t)off >= emu->cfg.driftSpan)) ||
+        ((off < 0) && (emu->drift < 0) && ((uint32_t)-off >= emu->cfg.driftSpan))) {
+        emu->drift = -emu->drift;
+    }
+}
+
+size_t SENT_EmuFrame(struct sent_emulator *emu, uint8_t status, const uint8_t *data, uint16_t *clocks)
+{
+    const struct sent_emu_cfg *cfg = &emu->cfg;
+    uint8_t n = cfg->dataNibbles;
+    uint8_t nibbles[SENT_MSG_PAYLOAD_SIZE];
+    uint32_t ticks[SENT_EMU_MAX_PULSES];
+    size_t cnt = 0;
+
+    SENT_EmuDrift(emu);
+
+    nibbles[0] = (status & 0x03) | SENT_EmuSlowBits(emu);
+    memcpy(nibbles + 1, data, n);
+    /* legacy CRC covers status too */
+    nibbles[1 + n] = (cfg->crc == SENT_CRC_LEGACY) ? SENT_EmuCrc(cfg->crc, nibbles, 1 + n) :
+        SENT_EmuCrc(cfg->crc, nibbles + 1, n);
+    if (SENT_EmuInject(emu, cfg->crcErrRate)) {
+        nibbles[1 + n] ^= 1 + (SENT_EmuRandom(emu) % 15);
+        emu->crcErrCnt++;
+    }
+
+    uint32_t frameTicks = SENT_SYNC_INTERVAL + SENT_OFFSET_INTERVAL;
+    ticks[cnt++] = frameTicks;
+    for (uint8_t i = 0; i < 2 + n; i++) {
+        ticks[cnt] = SENT_OFFSET_INTERVAL + nibbles[i];
+        frameTicks += ticks[cnt++];
+    }
+    if (cfg->pauseTicks) {
+        if (!cfg->constLength) {
+            ticks[cnt++] = cfg->pauseTicks;
+        } else if (cfg->pauseTicks >= frameTicks + SENT_OFFSET_INTERVAL) {
+            ticks[cnt++] = cfg->pauseTicks - frameTicks;
+        } else {
+            /* pause is never shorter than a nibble */
+            ticks[cnt++] = SENT_OFFSET_INTERVAL;
+        }
+    }
+
+    /* edge times before jitter, in 1/2^SENT_TICK_FRAC_BITS clocks */
+    uint64_t edges[SENT_EMU_MAX_PULSES];
+    for (size_t i = 0; i < cnt; i++) {
+        emu->time += (uint64_t)ticks[i] * emu->tickFrac;
+        edges[i] = emu->time;
+        if (cfg->jitter) {
+            edges[i] += (int32_t)(SENT_EmuRandom(emu) % (2 * cfg->jitter + 1)) - (int32_t)cfg->jitter;
+        }
+    }
+
+    if (SENT_EmuInject(emu, cfg->dropRate)) {
+        /* any edge but the last one, so next frame still starts where it should */
+        size_t i = SENT_EmuRandom(emu) % (cnt - 1);
+        memmove(&edges[i], &edges[i + 1], (cnt - 1 - i) * sizeof(edges[0]));
+        cnt--;
+        emu->dropCnt++;
+    }
+    if (SENT_EmuInject(emu, cfg->glitchRate)) {
+        /* short spike one tick after some edge */
+        size_t i = SENT_EmuRandom(emu) % cnt;
+        memmove(&edges[i + 1], &edges[i], (cnt - i) * sizeof(edges[0]));
+        edges[i] = ((i > 0) ? edges[i - 1] : emu->lastEdge) + emu->tickFrac;
+        cnt++;
+        emu->glitchCnt++;
+    }
+
+    /* interval is difference of edge times rounded down to whole clocks, as timer captures them */
+    uint64_t last = emu->lastEdge >> SENT_TICK_FRAC_BITS;
+    for (size_t i = 0; i < cnt; i++) {
+        uint64_t edge = edges[i] >> SENT_TICK_FRAC_BITS;
+        uint64_t interval = (edge > last) ? edge - last : 1;
+
+        clocks[i] = (interval > 0xffff) ? 0xffff : (uint16_t)interval;
+        last += clocks[i];
+    }
+    emu->lastEdge = last << SENT_TICK_FRAC_BITS;
+
+    emu->frameCnt++;
+    return cnt;
+}
+
+void SENT_EmuRead(struct sent_emulator *emu, uint16_t *clocks, size_t n, sent_emu_source source, void *arg)
+{
+    while (n) {
+        if (emu->pendingPos == emu->pendingCnt) {
+            uint8_t status = 0;
+            uint8_t data[SENT_MSG_DATA_SIZE] = {};
+
+            if (source) {
+                source(&status, data, arg);
+            }
+            emu->pendingCnt = SENT_EmuFrame(emu, status, data, emu->pending);
+            emu->pendingPos = 0;
+        }
+
+        size_t cnt = emu->pendingCnt - emu->pendingPos;
+        if (cnt > n) {
+            cnt = n;
+        }
+        memcpy(clocks, emu->pending + emu->pendingPos, cnt * sizeof(clocks[0]));
+        emu->pendingPos += cnt;
+        clocks += cnt;
+        n -= cnt;
+    }
+}
@@ -0,0 +1,119 @@
+/*
+ * sent_emulator.h
+ *
+ * SENT transmitter model: frames, slow channel messages, tick drift, edge
+ * jitter and injected errors turned into falling edge to falling edge
+ * intervals, same as capture backends feed to decoder.
+ * No ChibiOS/HAL dependencies here: this is also built into unit_tests.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "sent_decoder.h"
+
+/* sync, status, up to 6 data nibbles, CRC, pause and one glitch edge */
+#define SENT_EMU_MAX_PULSES     (1 + SENT_MSG_PAYLOAD_SIZE + 1 + 1)
+
+/* Error injection rates are per frame, out of SENT_EMU_RATE_ONE */
+#define SENT_EMU_RATE_ONE       65536
+
+/* Slow channel message, emulator sends messages of the list one after another */
+struct sent_emu_slow_msg {
+    uint8_t format;     /* sent_slow_format */
+    uint8_t id;
+    uint16_t data;
+};
+
+struct sent_emu_cfg {
+    /* nominal tick, 1/2^SENT_TICK_FRAC_BITS capture clocks */
+    uint32_t tickFrac;
+    /* tick change per frame, same units. Direction reverses when tick gets
+     * driftSpan away from nominal */
+    int32_t tickDrift;
+    uint32_t driftSpan;
+    /* each edge is moved by random time up to +/- jitter, 1/2^SENT_TICK_FRAC_BITS clocks */
+    uint32_t jitter;
+
+    /* data nibbles between status and CRC, 1..SENT_MSG_DATA_SIZE */
+    uint8_t dataNibbles;
+    /* CRC variant, SENT_CRC_ANY sends recommended */
+    sent_crc_type crc;
+    /* pause pulse ticks, 0 - no pause. With constLength pause fills frame up
+     * to pauseTicks counted from start of sync */
+    uint32_t pauseTicks;
+    bool constLength;
+
+    const struct sent_emu_slow_msg *slow;
+    uint32_t slowNum;
+
+    /* corrupted CRC nibble */
+    uint32_t crcErrRate;
+    /* extra falling edge shortly after one of frame edges */
+    uint32_t glitchRate;
+    /* one of frame falling edges is lost, two pulses merge */
+    uint32_t dropRate;
+
+    uint32_t seed;
+};
+
+/* Status and data nibbles of next frame, called once per frame */
+typedef void (*sent_emu_source)(uint8_t *status, uint8_t *data, void *arg);
+
+struct sent_emulator {
+    struct sent_emu_cfg cfg;
+    uint32_t tickFrac;
+    int32_t drift;
+    uint32_t rnd;
+
+    /* 1/2^SENT_TICK_FRAC_BITS clocks: nominal time of last edge, and last
+     * edge as capture timer saw it, with jitter and in whole clocks */
+    uint64_t time;
+    uint64_t lastEdge;
+
+    /* slow channel bits of message being sent, first bit is highest */
+    uint32_t scBits2;
+    uint32_t scBits3;
+    uint8_t scLeft;
+    uint32_t scNext;
+
+    /* generated frame not read yet */
+    uint16_t pending[SENT_EMU_MAX_PULSES];
+    uint8_t pendingCnt;
+    uint8_t pendingPos;
+
+    /* stats */
+    uint32_t frameCnt;
+    uint32_t slowMsgCnt;
+    uint32_t crcErrCnt;
+    uint32_t glitchCnt;
+    uint32_t dropCnt;
+};
+
+void SENT_EmuInit(struct sent_emulator *emu, const struct sent_emu_cfg *cfg);
+
+/* Intervals of one frame from sync to CRC or pause, returns number written
+ * to clocks, at most SENT_EMU_MAX_PULSES */
+size_t SENT_EmuFrame(struct sent_emulator *emu, uint8_t status, const uint8_t *data, uint16_t *clocks);
+
+/* Exactly n intervals of continuous stream, frames split between calls are
+ * continued on next call. Frame content is taken from source */
+void SENT_EmuRead(struct sent_emulator *emu, uint16_t *clocks, size_t n, sent_emu_source source, void *arg);
+
+/* Config matching what decoder of Profile expects */
+template <class Profile>
+void SENT_EmuDefaultCfg(struct sent_emu_cfg *cfg)
+{
+    *cfg = {};
+    cfg->tickFrac = Profile::tickClocks << SENT_TICK_FRAC_BITS;
+    cfg->dataNibbles = (Profile::dataNibbles == SENT_DATA_NIBBLES_AUTO) ? SENT_MSG_DATA_SIZE : Profile::dataNibbles;
+    cfg->crc = (Profile::crc == SENT_CRC_ANY) ? SENT_CRC_RECOMMENDED : Profile::crc;
+    if (Profile::pausePulse) {
+        /* longest frame is 56 + 8 * 27 ticks, pause is at least 12 ticks */
+        cfg->pauseTicks = 290;
+        cfg->constLength = true;
+    }
+    cfg->seed = 1;
+}
@@ -0,0 +1,107 @@
+/*
+ * sent_frame_ring.h
+ *
+ * Decoded frames with capture timestamp, published by decoder thread and
+ * read by sequence number from any number of consumer threads.
+ * No ChibiOS/HAL dependencies here: this is also built into unit_tests.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#include "sent.h"
+
+struct sent_frame {
+    /* capture time of falling edge ending sync pulse, CPU clocks */
+    uint32_t syncTime;
+    /* signals decoded according to profile layout */
+    int32_t sig0;
+    int32_t sig1;
+    /* status, data nibbles and CRC */
+    uint8_t nibbles[SENT_MSG_PAYLOAD_SIZE];
+    uint8_t dataNibbles;
+};
+
+/* Single writer, readers never block writer. Slot being rewritten while
+ * reader copies it is detected by its sequence number and read fails */
+template <size_t N>
+class SentFrameRing {
+    static_assert((N & (N - 1)) == 0, "ring size should be power of 2");
+
+public:
+    /* Writer side, returns sequence number given to frame */
+    uint32_t push(const struct sent_frame &frame) {
+        uint32_t seq = m_last.load(std::memory_order_relaxed) + 1;
+        if (seq == 0) {
+            /* 0 is never used, means "nothing yet" */
+            seq = 1;
+        }
+        slot &s = m_slots[seq & (N - 1)];
+
+        s.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.frame = frame;
+        s.seq.store(seq, std::memory_order_release);
+        m_last.store(seq, std::memory_order_release);
+
+        return seq;
+    }
+
+    /* Sequence number of newest frame, 0 if nothing published yet */
+    uint32_t lastSeq() const {
+        return m_last.load(std::memory_order_acquire);
+    }
+
+    /* Copy frame seq. False if it is not published yet or already overwritten */
+    bool read(uint32_t seq, struct sent_frame *out) const {
+        if ((seq == 0) || ((int32_t)(lastSeq() - seq) < 0)) {
+            return false;
+        }
+        const slot &s = m_slots[seq & (N - 1)];
+
+        if (s.seq.load(std::memory_order_acquire) != seq) {
+            return false;
+        }
+        *out = s.frame;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        return s.seq.load(std::memory_order_relaxed) == seq;
+    }
+
+private:
+    struct slot {
+        std::atomic<uint32_t> seq{0};
+        struct sent_frame frame;
+    };
+
+    std::atomic<uint32_t> m_last{0};
+    slot m_slots[N];
+};
+
+/* Sync edge to consumer latency, updated by one consumer */
+struct sent_latency {
+    uint32_t min;
+    uint32_t max;
+    uint32_t count;
+    uint64_t sum;
+};
+
+static inline void SENT_LatencyAdd(struct sent_latency *lat, uint32_t clocks)
+{
+    if ((lat->count == 0) || (clocks < lat->min)) {
+        lat->min = clocks;
+    }
+    if (clocks > lat->max) {
+        lat->max = clocks;
+    }
+    lat->sum += clocks;
+    lat->count++;
+}
+
+static inline uint32_t SENT_LatencyAvg(const struct sent_latency *lat)
+{
+    return lat->count ? (uint32_t)(lat->sum / lat->count) : 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * sent_hw_dma.cpp
+ *
+ * Timer input capture writes counter value of each falling edge to circular
+ * buffer by DMA. No interrupt per edge, decoder thread is woken on half and
+ * full transfer events and converts half of the buffer to intervals at once.
+ */
+
+#include "ch.h"
+#include "hal.h"
+
+#include "sent.h"
+#include "sent_hw_dma.h"
+#include "sent_dma_ring.h"
+#include "sent_spsc_ring.h"
+
+#define SENT_DMA_IRQ_PRIORITY   6
+
+/* ~111 nS digital filter on inputs: fCK_INT, N = 8 */
+#define SENT_DMA_IC_FILTER      3
+
+struct sent_dma_input {
+    stm32_tim_t *tim;
+    uint32_t dmaId;
+    ioline_t line;
+    /* capture/compare unit used: 0 - CC1, 1 - CC2 */
+    uint8_t cc;
+    /* CCxS: 1 - own TIx input, 2 - other input of the pair */
+    uint8_t ccs;
+};
+
+/* indexed by sent_input */
+static const struct sent_dma_input sent_dma_inputs[SENT_INPUT_NUM] = {
+    { SENT_DMA_CH1_TIM, SENT_DMA_CH1_DMA, PAL_LINE(GPIOA, 7), 0, 2 },
+    { SENT_DMA_CH2_TIM, SENT_DMA_CH2_DMA, PAL_LINE(GPIOB, 6), 0, 1 },
+    { SENT_DMA_CH3_TIM, SENT_DMA_CH3_DMA, PAL_LINE(GPIOA, 8), 0, 1 },
+    { SENT_DMA_CH4_TIM, SENT_DMA_CH4_DMA, PAL_LINE(GPIOA, 1), 1, 1 },
+    /* PA6: TIM3 CC1 is taken by PA7 */
+    { nullptr, 0, 0, 0, 0 },
+};
+
+/* DMA half/full transfer events, time is of last capture in that half */
+struct sent_dma_event {
+    uint32_t time;
+    uint8_t half;
+};
+
+static uint16_t sent_dma_buf[SENT_CHANNELS_NUM][SENT_DMA_BUF_SIZE];
+static struct sent_dma_ring sent_dma_rings[SENT_CHANNELS_NUM];
+static const stm32_dma_stream_t *sent_dma_streams[SENT_CHANNELS_NUM];
+/* DMA ISR to decoder thread */
+static SentSpscRing<struct sent_dma_event, 4> sent_dma_events[SENT_CHANNELS_NUM];
+
+static void sentDmaIsr(void *p, uint32_t flags)
+{
+    uint32_t entry = port_rt_get_counter_value();
+    uint8_t ch = (uintptr_t)p;
+    struct sent_dma_event event = { entry, 0 };
+
+    if (flags & STM32_DMA_ISR_HTIF) {
+        event.half = 0;
+        sent_dma_events[ch].push(event);
+    }
+    if (flags & STM32_DMA_ISR_TCIF) {
+        event.half = 1;
+        sent_dma_events[ch].push(event);
+    }
+    /* once per half buffer, so decoder is woken every time: cheap enough, and
+     * every DMA ISR is timed */
+    SENT_CaptureReady_ISR_Handler(ch, entry);
+}
+
+static void sentDmaEnableTimer(stm32_tim_t *tim)
+{
+    if (tim == STM32_TIM1) {
+        rccEnableTIM1(true);
+    } else if (tim == STM32_TIM2) {
+        rccEnableTIM2(true);
+    } else if (tim == STM32_TIM3) {
+        rccEnableTIM3(true);
+    } else if (tim == STM32_TIM4) {
+        rccEnableTIM4(true);
+    }
+}
+
+class SentDmaBackend : public SentCaptureBackend {
+public:
+    const char *name() const override {
+        return "DMA";
+    }
+
+    bool start(uint8_t ch, sent_input input, uint32_t minClocks) override {
+        if ((ch >= SENT_CHANNELS_NUM) || (input >= SENT_INPUT_NUM) ||
+            (sent_dma_inputs[input].tim == nullptr)) {
+            return false;
+        }
+
+        const struct sent_dma_input *in = &sent_dma_inputs[input];
+        stm32_tim_t *tim = in->tim;
+
+        sentDmaEnableTimer(tim);
+        palSetLineMode(in->line, PAL_MODE_INPUT_PULLUP);
+
+        SENT_DmaRingInit(&sent_dma_rings[ch], sent_dma_buf[ch], SENT_DMA_BUF_SIZE);
+
+        const stm32_dma_stream_t *dma = dmaStreamAlloc(in->dmaId, SENT_DMA_IRQ_PRIORITY,
+            sentDmaIsr, (void *)(uintptr_t)ch);
+        if (dma == NULL) {
+            /* stream already in use */
+            return false;
+        }
+        sent_dma_streams[ch] = dma;
+
+        dmaStreamSetPeripheral(dma, &tim->CCR[in->cc]);
+        dmaStreamSetMemory0(dma, sent_dma_buf[ch]);
+        dmaStreamSetTransactionSize(dma, SENT_DMA_BUF_SIZE);
+        dmaStreamSetMode(dma,
+            STM32_DMA_CR_PL(2) | STM32_DMA_CR_DIR_P2M |
+            STM32_DMA_CR_PSIZE_HWORD | STM32_DMA_CR_MSIZE_HWORD |
+            STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC |
+            STM32_DMA_CR_HTIE | STM32_DMA_CR_TCIE);
+        dmaStreamEnable(dma);
+
+        /* free running 16 bit counter at 72 MHz, capture on falling edge */
+        tim->CR1 = 0;
+        tim->PSC = 0;
+        tim->ARR = 0xffff;
+        if (in->cc == 0) {
+            tim->CCMR1 = STM32_TIM_CCMR1_CC1S(in->ccs) | STM32_TIM_CCMR1_IC1F(SENT_DMA_IC_FILTER);
+            tim->CCER = STM32_TIM_CCER_CC1E | STM32_TIM_CCER_CC1P;
+            tim->DIER = STM32_TIM_DIER_CC1DE;
+        } else {
+            tim->CCMR1 = STM32_TIM_CCMR1_CC2S(in->ccs) | STM32_TIM_CCMR1_IC2F(SENT_DMA_IC_FILTER);
+            tim->CCER = STM32_TIM_CCER_CC2E | STM32_TIM_CCER_CC2P;
+            tim->DIER = STM32_TIM_DIER_CC2DE;
+        }
+        tim->EGR = STM32_TIM_EGR_UG;
+        tim->CR1 = STM32_TIM_CR1_CEN;
+        return true;
+    }
+
+    /* Converts captures of one half posted by DMA ISR, out should have room for SENT_DMA_BUF_SIZE / 2 */
+    size_t collect(uint8_t ch, uint16_t *out, size_t max, uint32_t *endTime) override {
+        struct sent_dma_event event;
+
+        if ((ch >= SENT_CHANNELS_NUM) || (max < SENT_DMA_BUF_SIZE / 2)) {
+            return 0;
+        }
+
+        while (sent_dma_events[ch].pop(&event, 1)) {
+            size_t cnt = SENT_DmaRingHalf(&sent_dma_rings[ch], event.half,
+                dmaStreamGetTransactionSize(sent_dma_streams[ch]), out);
+            if (cnt) {
+                *endTime = event.time;
+                return cnt;
+            }
+        }
+
+        return 0;
+    }
+
+    void getCounters(uint8_t ch, struct sent_capture_counters *counters) override {
+        counters->glitches = 0;
+        counters->gaps = 0;
+        counters->overruns = sent_dma_rings[ch].overruns + sent_dma_events[ch].getOverflowCnt();
+    }
+};
+
+static SentDmaBackend sent_dma_backend;
+
+SentCaptureBackend *SENT_DmaBackend(void)
+{
+    return &sent_dma_backend;
+}
@@ -0,0 +1,37 @@
+/*
+ * sent_hw_dma.h
+ *
+ * Timer input capture to circular DMA buffer SENT capture backend
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "sent_capture.h"
+
+/* captures per channel, DMA raises event each SENT_DMA_BUF_SIZE / 2 falling edges.
+ * 16 edges is two GM frames, ~3 ms worst case latency */
+#define SENT_DMA_BUF_SIZE   32
+
+/* Sent input1 - PA7 - TIM3 CH2 input, captured by IC1 mapped to TI2 (TIM3_CH2 has no DMA request on F103)
+ * DMA1 channel 6 - TIM3_CH1 */
+#define SENT_DMA_CH1_TIM        STM32_TIM3
+#define SENT_DMA_CH1_DMA        STM32_DMA_STREAM_ID(1, 6)
+
+/* Sent input2 - PB6 - TIM4 CH1, DMA1 channel 1 - TIM4_CH1 */
+#define SENT_DMA_CH2_TIM        STM32_TIM4
+#define SENT_DMA_CH2_DMA        STM32_DMA_STREAM_ID(1, 1)
+
+/* Sent input3 - PA8 - TIM1 CH1, DMA1 channel 2 - TIM1_CH1 */
+#define SENT_DMA_CH3_TIM        STM32_TIM1
+#define SENT_DMA_CH3_DMA        STM32_DMA_STREAM_ID(1, 2)
+
+/* Sent input4 - PA1 - TIM2 CH2, DMA1 channel 7 - TIM2_CH2 */
+#define SENT_DMA_CH4_TIM        STM32_TIM2
+#define SENT_DMA_CH4_DMA        STM32_DMA_STREAM_ID(1, 7)
+
+/* Captures are converted to intervals by collect() in decoder thread, one
+ * buffer half per call. Counters report DMA overruns and lost half events */
+SentCaptureBackend *SENT_DmaBackend(void);
@@ -0,0 +1,112 @@
+/*
+ * sent_hw_emu.cpp
+ *
+ * SENT emulator output. Timer runs PWM with active low output, line goes
+ * low at start of each period and high after SENT_EMU_LOW_TICKS. DMA on
+ * compare match writes period of current pulse to ARR, so no interrupt per
+ * pulse: emulator refills half of the buffer on DMA half/full events.
+ */
+
+#include "ch.h"
+#include "hal.h"
+
+#include "sent.h"
+#include "sent_hw_emu.h"
+#include "sent_emulator.h"
+
+#if SENT_EMU_OUTPUT
+
+#if SENT_DEV == SENT_SILABS_SENS
+#error "TIM1 is used by SENT input 3"
+#endif
+
+#define SENT_EMU_IRQ_PRIORITY   7
+
+/* sensor emulated on output, same as inputs decode */
+typedef SentProfileGmEtb SentEmuProfile;
+
+static const struct sent_emu_slow_msg sent_emu_slow[] = {
+    { SENT_SLOW_ENHANCED_12, 0x01, 0x123 },
+    { SENT_SLOW_ENHANCED_12, 0x23, 0xabc },
+    { SENT_SLOW_ENHANCED_16, 0x05, 0x1234 },
+};
+
+static struct sent_emulator sent_emu;
+static uint16_t sent_emu_buf[SENT_EMU_BUF_SIZE];
+static uint16_t sent_emu_sig0;
+
+/* sig0 ramps, sig1 is fixed */
+static void SENT_EmuRamp(uint8_t *status, uint8_t *data, void *arg)
+{
+    (void)arg;
+
+    *status = 0;
+    SENT_PackDual12(sent_emu_sig0, 0x800, data);
+    sent_emu_sig0 = (sent_emu_sig0 + 1) & 0x0fff;
+}
+
+static void SENT_EmuFill(uint16_t *buf, size_t n)
+{
+    SENT_EmuRead(&sent_emu, buf, n, SENT_EmuRamp, nullptr);
+    for (size_t i = 0; i < n; i++) {
+        /* timer period is ARR + 1 */
+        buf[i]--;
+    }
+}
+
+static void sentEmuDmaIsr(void *p, uint32_t flags)
+{
+    (void)p;
+
+    /* DMA is already past the half being refilled */
+    if (flags & STM32_DMA_ISR_HTIF) {
+        SENT_EmuFill(sent_emu_buf, SENT_EMU_BUF_SIZE / 2);
+    }
+    if (flags & STM32_DMA_ISR_TCIF) {
+        SENT_EmuFill(sent_emu_buf + SENT_EMU_BUF_SIZE / 2, SENT_EMU_BUF_SIZE / 2);
+    }
+}
+
+void InitSentEmulator(void)
+{
+    struct sent_emu_cfg cfg;
+    SENT_EmuDefaultCfg<SentEmuProfile>(&cfg);
+    cfg.slow = sent_emu_slow;
+    cfg.slowNum = sizeof(sent_emu_slow) / sizeof(sent_emu_slow[0]);
+    SENT_EmuInit(&sent_emu, &cfg);
+    SENT_EmuFill(sent_emu_buf, SENT_EMU_BUF_SIZE);
+
+    stm32_tim_t *tim = SENT_EMU_TIM;
+
+    rccEnableTIM1(true);
+    palSetLineMode(SENT_EMU_LINE, PAL_MODE_STM32_ALTERNATE_PUSHPULL);
+
+    const stm32_dma_stream_t *dma = dmaStreamAlloc(SENT_EMU_DMA, SENT_EMU_IRQ_PRIORITY,
+        sentEmuDmaIsr, nullptr);
+    osalDbgAssert(dma != NULL, "SENT emulator DMA stream already in use");
+
+    dmaStreamSetPeripheral(dma, &tim->ARR);
+    dmaStreamSetMemory0(dma, sent_emu_buf);
+    dmaStreamSetTransactionSize(dma, SENT_EMU_BUF_SIZE);
+    dmaStreamSetMode(dma,
+        STM32_DMA_CR_PL(2) | STM32_DMA_CR_DIR_M2P |
+        STM32_DMA_CR_PSIZE_HWORD | STM32_DMA_CR_MSIZE_HWORD |
+        STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC |
+        STM32_DMA_CR_HTIE | STM32_DMA_CR_TCIE);
+    dmaStreamEnable(dma);
+
+    /* 72 MHz, same clock as capture timers. ARR is not preloaded: DMA writes
+     * it on CC1 match, in the middle of pulse it belongs to */
+    tim->CR1 = 0;
+    tim->PSC = 0;
+    tim->ARR = 0xffff;
+    tim->CCR[0] = SENT_EMU_LOW_TICKS * SentEmuProfile::tickClocks;
+    tim->CCMR1 = STM32_TIM_CCMR1_OC1M(6);
+    tim->CCER = STM32_TIM_CCER_CC1E | STM32_TIM_CCER_CC1P;
+    tim->BDTR = STM32_TIM_BDTR_MOE;
+    tim->DIER = STM32_TIM_DIER_CC1DE;
+    tim->EGR = STM32_TIM_EGR_UG;
+    tim->CR1 = STM32_TIM_CR1_CEN;
+}
+
+#endif // SENT_EMU_OUTPUT
@@ -0,0 +1,20 @@
+/*
+ * sent_hw_emu.h
+ *
+ * SENT emulator output: TIM1 CH1 PWM on PA8, period of each pulse is
+ * reloaded by DMA. Wire PA8 to one of SENT inputs for loopback test.
+ */
+
+#pragma once
+
+/* DMA1 channel 2 - TIM1_CH1, free while TIM1 is not SENT input 3 */
+#define SENT_EMU_TIM            STM32_TIM1
+#define SENT_EMU_DMA            STM32_DMA_STREAM_ID(1, 2)
+#define SENT_EMU_LINE           PAL_LINE(GPIOA, 8)
+
+/* intervals per DMA buffer, half of it is refilled on each DMA event */
+#define SENT_EMU_BUF_SIZE       32
+/* line is pulled low for this many ticks at start of each pulse */
+#define SENT_EMU_LOW_TICKS      5
+
+void InitSentEmulator(void);
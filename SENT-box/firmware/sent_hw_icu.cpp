@@ -11,115 +11,77 @@
 #include "sent.h"
 #include "sent_hw_icu.h"
 
-#if SENT_MODE_ICU
-
-static void icuperiodcb_in1(ICUDriver *icup);
-static void icuperiodcb_in2(ICUDriver *icup);
-#if SENT_DEV == SENT_SILABS_SENS
-static void icuperiodcb_in3(ICUDriver *icup);
-static void icuperiodcb_in4(ICUDriver *icup);
-#endif
-
-static ICUConfig icucfg_in1 =
-{
-  .mode = ICU_INPUT_ACTIVE_LOW,
-  .frequency = SENT_ICU_FREQ,
-  .width_cb = NULL,
-  .period_cb = icuperiodcb_in1,
-  .overflow_cb = NULL,
-  .channel = SENT_ICUD_CH1_CH,
-  .dier = 0U,
-  .arr = 0xFFFFFFFFU,
+struct sent_icu_input {
+    ICUDriver *icu;
+    icuchannel_t channel;
+    icumode_t mode;
+    /* period is halved, as Si7215 board setup always did for these inputs */
+    uint8_t shift;
 };
 
-static ICUConfig icucfg_in2 =
-{
-  ICU_INPUT_ACTIVE_HIGH,
-  SENT_ICU_FREQ,
-  NULL,
-  icuperiodcb_in2,
-  NULL,
-  SENT_ICUD_CH2_CH,
-  0U,
-  0xFFFFFFFFU
+/* indexed by sent_input */
+static const struct sent_icu_input sent_icu_inputs[SENT_INPUT_NUM] = {
+    { &SENT_ICUD_CH1_D, SENT_ICUD_CH1_CH, ICU_INPUT_ACTIVE_LOW, 0 },     /* PA7 */
+    { &SENT_ICUD_CH2_D, SENT_ICUD_CH2_CH, ICU_INPUT_ACTIVE_HIGH, 0 },    /* PB6 */
+    { &SENT_ICUD_CH3_D, SENT_ICUD_CH3_CH, ICU_INPUT_ACTIVE_HIGH, 1 },    /* PA8 */
+    { &SENT_ICUD_CH4_D, SENT_ICUD_CH4_CH, ICU_INPUT_ACTIVE_HIGH, 1 },    /* PA1 */
+    { nullptr, ICU_CHANNEL_1, ICU_INPUT_ACTIVE_HIGH, 0 },                /* PA6: no free timer */
 };
 
-#if SENT_DEV == SENT_SILABS_SENS
-static ICUConfig icucfg_in3 =
-{
-  ICU_INPUT_ACTIVE_HIGH,
-  SENT_ICU_FREQ,
-  NULL,
-  icuperiodcb_in3,
-  NULL,
-  SENT_ICUD_CH3_CH,
-  0U,
-  0xFFFFFFFFU
-};
+/* decoder channel of each input */
+static uint8_t sent_icu_ch[SENT_INPUT_NUM];
+static ICUConfig sent_icu_cfg[SENT_INPUT_NUM];
 
-static ICUConfig icucfg_in4 =
+template <uint8_t Input>
+static void icuperiodcb_in(ICUDriver *icup)
 {
-  ICU_INPUT_ACTIVE_HIGH,
-  SENT_ICU_FREQ,
-  NULL,
-  icuperiodcb_in4,
-  NULL,
-  SENT_ICUD_CH4_CH,
-  0U,
-  0xFFFFFFFFU
-};
-#endif // SENT_DEV
+  uint32_t entry = port_rt_get_counter_value();
 
-static void icuperiodcb_in1(ICUDriver *icup)
-{
-  SENT_ISR_Handler(SENT_CH1, icuGetPeriodX(icup));
+  SENT_ISR_Handler(sent_icu_ch[Input], icuGetPeriodX(icup) >> sent_icu_inputs[Input].shift, entry);
 }
 
-static void icuperiodcb_in2(ICUDriver *icup)
-{
-  SENT_ISR_Handler(SENT_CH2, icuGetPeriodX(icup));
-}
+static const icucallback_t sent_icu_cb[SENT_INPUT_NUM] = {
+    icuperiodcb_in<SENT_INPUT_PA7>,
+    icuperiodcb_in<SENT_INPUT_PB6>,
+    icuperiodcb_in<SENT_INPUT_PA8>,
+    icuperiodcb_in<SENT_INPUT_PA1>,
+    icuperiodcb_in<SENT_INPUT_PA6>,
+};
 
-#if SENT_DEV == SENT_SILABS_SENS
-static void icuperiodcb_in3(ICUDriver *icup)
-{
-  SENT_ISR_Handler(SENT_CH3, icuGetPeriodX(icup) >> 1);
-}
+class SentIcuBackend : public SentCaptureBackend {
+public:
+    const char *name() const override {
+        return "ICU";
+    }
+
+    bool start(uint8_t ch, sent_input input, uint32_t minClocks) override {
+        if ((input >= SENT_INPUT_NUM) || (sent_icu_inputs[input].icu == nullptr)) {
+            return false;
+        }
+
+        const struct sent_icu_input *in = &sent_icu_inputs[input];
+        ICUConfig *cfg = &sent_icu_cfg[input];
+
+        sent_icu_ch[input] = ch;
+        cfg->mode = in->mode;
+        cfg->frequency = SENT_ICU_FREQ;
+        cfg->width_cb = NULL;
+        cfg->period_cb = sent_icu_cb[input];
+        cfg->overflow_cb = NULL;
+        cfg->channel = in->channel;
+        cfg->dier = 0U;
+        cfg->arr = 0xFFFFFFFFU;
+
+        icuStart(in->icu, cfg);
+        icuStartCapture(in->icu);
+        icuEnableNotifications(in->icu);
+        return true;
+    }
+};
 
-static void icuperiodcb_in4(ICUDriver *icup)
-{
-  SENT_ISR_Handler(SENT_CH4, icuGetPeriodX(icup) >> 1);
-}
-#endif
+static SentIcuBackend sent_icu_backend;
 
-void InitSent()
+SentCaptureBackend *SENT_IcuBackend(void)
 {
-
-    //palSetLineMode(HAL_SENT_CH1_LINE, PAL_MODE_INPUT_PULLUP);
-    //palSetLineMode(HAL_SENT_CH2_LINE, PAL_MODE_INPUT_PULLUP);
-
-    icuStart(&SENT_ICUD_CH1_D, &icucfg_in1);
-    icuStartCapture(&SENT_ICUD_CH1_D);
-    icuEnableNotifications(&SENT_ICUD_CH1_D);
-
-#if 0
-    icuStart(&SENT_ICUD_CH2_D, &icucfg_in2);
-    icuStartCapture(&SENT_ICUD_CH2_D);
-    icuEnableNotifications(&SENT_ICUD_CH2_D);
-#endif
-
-#if SENT_DEV == SENT_SILABS_SENS
-    icuStart(&SENT_ICUD_CH3_D, &icucfg_in3);
-    icuStartCapture(&SENT_ICUD_CH3_D);
-    icuEnableNotifications(&SENT_ICUD_CH3_D);
-
-    icuStart(&SENT_ICUD_CH4_D, &icucfg_in4);
-    icuStartCapture(&SENT_ICUD_CH4_D);
-    icuEnableNotifications(&SENT_ICUD_CH4_D);
-#endif
-
-  /* Start decoder thread */
-  SentDecoder_Init();
+    return &sent_icu_backend;
 }
-
-#endif // SENT_MODE_ICU
\ No newline at end of file
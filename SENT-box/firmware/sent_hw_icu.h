@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include "sent_capture.h"
+
 #define SENT_ICU_FREQ       72000000 // == CPU freq
 
 // Sent input1 - TIM3 CH1 - PA7
@@ -24,3 +26,5 @@
 // Sent input4 - TIM2 CH2 - PA1
 #define SENT_ICUD_CH4_D ICUD2
 #define SENT_ICUD_CH4_CH ICU_CHANNEL_2
+
+SentCaptureBackend *SENT_IcuBackend(void);
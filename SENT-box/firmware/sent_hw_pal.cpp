@@ -1,5 +1,5 @@
 /*
- * sent.cpp
+ * sent_hw_pal.cpp
  *
  *  Created on: 16 May 2022
  *      Author: alexv
@@ -10,49 +10,81 @@
 
 #include "sent.h"
 #include "sent_hw_pal.h"
+#include "sent_edge_capture.h"
 
-#if SENT_MODE_PAL
+struct sent_pal_input {
+    ioline_t line;
+};
 
-uint32_t cyccnt_ch_prev[SENT_CH_MAX] = {0};
+/* indexed by sent_input, any of them can be EXTI line */
+static const struct sent_pal_input sent_pal_inputs[SENT_INPUT_NUM] = {
+    { HAL_SENT_CH2_LINE },      /* PA7 */
+    { PAL_LINE(GPIOB, 6) },
+    { PAL_LINE(GPIOA, 8) },
+    { PAL_LINE(GPIOA, 1) },
+    { HAL_SENT_CH1_LINE },      /* PA6 */
+};
+
+static struct sent_edge_capture sent_pal_capture[SENT_CHANNELS_NUM];
+
+/* Channel started on each EXTI line, -1 - free. Pins with same number share
+ * EXTI line (PA6 and PB6 are both EXTI6), only one of them can raise events */
+static int8_t sent_pal_exti_ch[16] = { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
 
 #pragma GCC push_options
 #pragma GCC optimize ("O2")
 
 static void palperiodcb_in(void *arg)
 {
-  uint32_t cyccnt_ch;
-  uint16_t cyccnt_ch_period;
-  int ch = (int)arg;
+  uint32_t ch = (uint32_t)(uintptr_t)arg;
+  uint32_t now = port_rt_get_counter_value();
+  uint16_t clocks;
 
-  cyccnt_ch = port_rt_get_counter_value();
-
-  if(cyccnt_ch > cyccnt_ch_prev[ch])
-  {
-      cyccnt_ch_period = (uint16_t)((cyccnt_ch - cyccnt_ch_prev[ch]));
-  }
-  else
+  if (SENT_EdgeCapture(&sent_pal_capture[ch], now, &clocks))
   {
-      cyccnt_ch_period = (uint16_t)((0xFFFFFFFF - cyccnt_ch_prev[ch] + cyccnt_ch));
+      SENT_ISR_Handler(ch, clocks, now);
   }
-
-  cyccnt_ch_prev[ch] = cyccnt_ch;
-
-  SENT_ISR_Handler(ch, cyccnt_ch_period);
 }
 #pragma GCC pop_options
 
-void InitSent()
-{
-  palSetLineMode(HAL_SENT_CH1_LINE, PAL_MODE_INPUT_PULLUP);
-  palEnableLineEvent(HAL_SENT_CH1_LINE, PAL_EVENT_MODE_FALLING_EDGE);
-  palSetLineCallback(HAL_SENT_CH1_LINE, (palcallback_t)palperiodcb_in, (void *)SENT_CH1);
+class SentPalBackend : public SentCaptureBackend {
+public:
+    const char *name() const override {
+        return "PAL";
+    }
 
-  palSetLineMode(HAL_SENT_CH2_LINE, PAL_MODE_INPUT_PULLUP);
-  palEnableLineEvent(HAL_SENT_CH2_LINE, PAL_EVENT_MODE_FALLING_EDGE);
-  palSetLineCallback(HAL_SENT_CH2_LINE, (palcallback_t)palperiodcb_in, (void *)SENT_CH1);
+    bool start(uint8_t ch, sent_input input, uint32_t minClocks) override {
+        if ((ch >= SENT_CHANNELS_NUM) || (input >= SENT_INPUT_NUM)) {
+            return false;
+        }
 
-  /* Start decoder thread */
-  SentDecoder_Init();
-}
+        ioline_t line = sent_pal_inputs[input].line;
+        uint32_t exti = PAL_PAD(line);
+
+        /* second pin on same EXTI line would silently take it over */
+        if ((sent_pal_exti_ch[exti] >= 0) && (sent_pal_exti_ch[exti] != ch)) {
+            return false;
+        }
+        sent_pal_exti_ch[exti] = ch;
+
+        SENT_EdgeCaptureInit(&sent_pal_capture[ch], minClocks);
+
+        palSetLineMode(line, PAL_MODE_INPUT_PULLUP);
+        palEnableLineEvent(line, PAL_EVENT_MODE_FALLING_EDGE);
+        palSetLineCallback(line, (palcallback_t)palperiodcb_in, (void *)(uintptr_t)ch);
+        return true;
+    }
 
-#endif // SENT_MODE_PAL
\ No newline at end of file
+    void getCounters(uint8_t ch, struct sent_capture_counters *counters) override {
+        counters->glitches = sent_pal_capture[ch].glitches;
+        counters->gaps = sent_pal_capture[ch].gaps;
+        counters->overruns = 0;
+    }
+};
+
+static SentPalBackend sent_pal_backend;
+
+SentCaptureBackend *SENT_PalBackend(void)
+{
+    return &sent_pal_backend;
+}
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "io_pins.h"
+#include "sent_capture.h"
 
 #define HAL_SENT_CH1_LINE               PAL_LINE(HAL_SENT_CH1_LINE_PORT, HAL_SENT_CH1_LINE_PIN)
 
@@ -128,3 +129,7 @@
 #endif // SENT_SILABS_SENS
 
 uint8_t SENT_GetTickValue(uint16_t dwt_val);
+
+/* EXTI capture timed by cycle counter, can take any input. Counters report
+ * edges dropped as glitches, intervals too long for 16 bits passed as gaps */
+SentCaptureBackend *SENT_PalBackend(void);
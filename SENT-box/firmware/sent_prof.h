@@ -0,0 +1,107 @@
+/*
+ * sent_prof.h
+ *
+ * Timing instrumentation of capture ISR and decoder thread, in CPU cycles
+ * of the DWT cycle counter. Compiled in with SENT_PROFILING only.
+ * Each histogram has one writer: ISR or decoder thread. Readers copy it
+ * without lock, fields of one copy may be few updates apart.
+ * No ChibiOS/HAL dependencies here: this is also built into unit_tests,
+ * which provide SENT_ProfCycles() with fake counter.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "sent.h"
+
+/* bin i counts samples of 2^i .. 2^(i+1)-1 cycles, bin 0 also 0 cycles,
+ * last bin everything longer */
+#define SENT_PROF_BINS      16
+
+struct sent_prof_hist {
+    uint32_t min;
+    uint32_t max;
+    uint32_t count;
+    uint32_t bins[SENT_PROF_BINS];
+};
+
+typedef enum {
+    /* capture ISR, from backend callback entry (ICU period, PAL edge, DMA
+     * half) to exit of SENT_ISR_Handler() or SENT_CaptureReady_ISR_Handler().
+     * HAL dispatch before callback is not included, nor PAL edges taken
+     * as glitch or gap, which do not reach sent.cpp */
+    SENT_PROF_ISR = 0,
+    /* decoder per pulse, batch time over its pulses */
+    SENT_PROF_PULSE,
+    /* decoder thread signalled by ISR to running */
+    SENT_PROF_WAKE,
+    SENT_PROF_NUM,
+} sent_prof_section;
+
+struct sent_prof {
+    struct sent_prof_hist hist[SENT_PROF_NUM];
+    /* most intervals ever waiting in ISR to decoder ring of any channel */
+    uint32_t mailboxHighWater;
+
+    /* counter when ISR woke decoder thread, valid while wakePending */
+    volatile uint32_t wakeTime;
+    volatile bool wakePending;
+};
+
+/* Free running cycle counter: port_rt_get_counter_value() on target */
+uint32_t SENT_ProfCycles(void);
+
+static inline uint32_t SENT_ProfBin(uint32_t cycles)
+{
+    uint32_t bin = (cycles > 1) ? 31 - __builtin_clz(cycles) : 0;
+
+    return (bin < SENT_PROF_BINS) ? bin : SENT_PROF_BINS - 1;
+}
+
+static inline void SENT_ProfHistAdd(struct sent_prof_hist *h, uint32_t cycles)
+{
+    if ((h->count == 0) || (cycles < h->min)) {
+        h->min = cycles;
+    }
+    if (cycles > h->max) {
+        h->max = cycles;
+    }
+    h->count++;
+    h->bins[SENT_ProfBin(cycles)]++;
+}
+
+/* Section started at start took cycles since, n items were handled in it */
+static inline void SENT_ProfEnd(struct sent_prof *prof, sent_prof_section section, uint32_t start, uint32_t n)
+{
+    uint32_t cycles = SENT_ProfCycles() - start;
+
+    SENT_ProfHistAdd(&prof->hist[section], n ? cycles / n : cycles);
+}
+
+static inline void SENT_ProfMailbox(struct sent_prof *prof, uint32_t waiting)
+{
+    if (waiting > prof->mailboxHighWater) {
+        prof->mailboxHighWater = waiting;
+    }
+}
+
+/* ISR: decoder thread is signalled. Latency is from first signal of those
+ * coalesced into one wakeup */
+static inline void SENT_ProfWakeSignal(struct sent_prof *prof)
+{
+    if (!prof->wakePending) {
+        prof->wakeTime = SENT_ProfCycles();
+        prof->wakePending = true;
+    }
+}
+
+/* Decoder thread: woken up, by ISR or by timeout */
+static inline void SENT_ProfWakeRun(struct sent_prof *prof)
+{
+    if (prof->wakePending) {
+        SENT_ProfEnd(prof, SENT_PROF_WAKE, prof->wakeTime, 1);
+        prof->wakePending = false;
+    }
+}
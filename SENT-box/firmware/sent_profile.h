@@ -0,0 +1,95 @@
+/*
+ * sent_profile.h
+ *
+ * Compile time description of SENT sensor frame format. Decoder is
+ * instantiated per profile, so different sensors can be decoded side
+ * by side in one image without runtime checks in the per-pulse path.
+ * No ChibiOS/HAL dependencies here: this is also built into unit_tests.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "sent.h"
+
+typedef enum {
+    /* seed, then c = T[c ^ x] over status and data nibbles, works for Si7215 */
+    SENT_CRC_LEGACY = 0,
+    /* J2716 2010 recommended: data nibbles only, one extra round with 0 */
+    SENT_CRC_RECOMMENDED,
+    /* recommended without the extra round with 0, GM throttle body */
+    SENT_CRC_UNAUGMENTED,
+    /* accept frame if legacy or recommended matches */
+    SENT_CRC_ANY,
+} sent_crc_type;
+
+typedef enum {
+    /* frame is not decoded to signals, nibbles only */
+    SENT_LAYOUT_RAW = 0,
+    /* two 12 bit signals: first MSB..LSB, second LSB..MSB (GM fuel pressure, ETB) */
+    SENT_LAYOUT_DUAL12,
+    /* Si7215: 12 bit magnetic field, 8 bit rolling counter, inverted first nibble */
+    SENT_LAYOUT_SI7215,
+} sent_signal_layout;
+
+/* SENT_LAYOUT_DUAL12: sig0 in first 3 data nibbles MSB..LSB, sig1 in next 3 nibbles LSB..MSB.
+ * data points to first data nibble, right after status */
+static inline void SENT_UnpackDual12(const uint8_t *data, int32_t *sig0, int32_t *sig1)
+{
+    *sig0 = (data[0] << 8) | (data[1] << 4) | (data[2] << 0);
+    *sig1 = (data[3] << 0) | (data[4] << 4) | (data[5] << 8);
+}
+
+static inline void SENT_PackDual12(uint16_t sig0, uint16_t sig1, uint8_t *data)
+{
+    data[0] = (sig0 >> 8) & 0x0f;
+    data[1] = (sig0 >> 4) & 0x0f;
+    data[2] = (sig0 >> 0) & 0x0f;
+    data[3] = (sig1 >> 0) & 0x0f;
+    data[4] = (sig1 >> 4) & 0x0f;
+    data[5] = (sig1 >> 8) & 0x0f;
+}
+
+/* frame length is not known in advance: frame ends with sync or pause pulse,
+ * last nibble received is CRC */
+#define SENT_DATA_NIBBLES_AUTO  0
+
+template <uint8_t DataNibbles, uint32_t TickNs, sent_crc_type Crc, bool PausePulse, sent_signal_layout Layout>
+struct SentProfile {
+    static_assert(DataNibbles <= SENT_MSG_DATA_SIZE, "data nibbles do not fit frame buffer");
+
+    /* data nibbles between status and CRC nibble, or SENT_DATA_NIBBLES_AUTO */
+    static constexpr uint8_t dataNibbles = DataNibbles;
+    /* nominal tick, capture timer clocks */
+    static constexpr uint32_t tickClocks = TickNs * SENT_TIMER_CLOCK_MHZ / 1000;
+    /* nominal sync pulse, capture timer clocks */
+    static constexpr uint32_t syncClocks = (SENT_SYNC_INTERVAL + SENT_OFFSET_INTERVAL) * tickClocks;
+    static constexpr sent_crc_type crc = Crc;
+    /* sensor sends pause pulse between CRC nibble and next sync */
+    static constexpr bool pausePulse = PausePulse;
+    static constexpr sent_signal_layout layout = Layout;
+    /* refine tick from whole frames and filter it, see SENT_TrackTick() */
+    static constexpr bool tickTracking = false;
+    /* bits of rolling counter in low bits of sig1, 0 - none. Frames lost
+     * between two good ones are counted, see SENT_CheckCounter() */
+    static constexpr uint8_t counterBits = (Layout == SENT_LAYOUT_SI7215) ? 8 : 0;
+};
+
+/* Same sensor with tick tracked across frames: for sensors with jittery sync
+ * pulse or drifting clock. Costs one division per frame */
+template <class Profile>
+struct SentProfileTracked : Profile {
+    static constexpr bool tickTracking = true;
+};
+
+/* Decoder behaviour before profiles were introduced: 2.7 uS tick, either CRC */
+typedef SentProfile<6, 2700, SENT_CRC_ANY, false, SENT_LAYOUT_DUAL12> SentProfileDefault;
+
+/* GM throttle body, 3.25 uS tick */
+typedef SentProfile<6, 3250, SENT_CRC_UNAUGMENTED, false, SENT_LAYOUT_DUAL12> SentProfileGmEtb;
+typedef SentProfile<6, 2700, SENT_CRC_RECOMMENDED, false, SENT_LAYOUT_DUAL12> SentProfileGmFuelPressure;
+typedef SentProfile<6, 5000, SENT_CRC_LEGACY, false, SENT_LAYOUT_SI7215> SentProfileSi7215;
+typedef SentProfile<6, 3000, SENT_CRC_ANY, true, SENT_LAYOUT_DUAL12> SentProfileFord;
+/* unknown sensor around 3 uS tick: frame length is taken from position of next sync/pause */
+typedef SentProfile<SENT_DATA_NIBBLES_AUTO, 3000, SENT_CRC_ANY, true, SENT_LAYOUT_RAW> SentProfileVariableLength;
@@ -0,0 +1,165 @@
+/*
+ * sent_raw_stream.h
+ *
+ * Raw capture intervals for streaming to host as recordings: decoder thread
+ * taps intervals it decodes, UART thread sends them. Places where intervals
+ * were lost (capture ring or this ring overflow, streaming switched on) are
+ * kept in the stream, so host never glues two pieces of signal together.
+ * No ChibiOS/HAL dependencies here: this is also built into unit_tests.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#include "sent_spsc_ring.h"
+
+/* Captured edge: falling edge to falling edge interval and time edge was seen by ISR */
+struct sent_edge {
+    uint32_t time;
+    uint16_t clocks;
+};
+
+template <size_t N>
+class SentRawStream {
+public:
+    /* Any context */
+    void enable(bool on) {
+        m_on.store(on, std::memory_order_relaxed);
+    }
+
+    bool isEnabled() const {
+        return m_on.load(std::memory_order_relaxed);
+    }
+
+    /* Producer (decoder thread): edges just taken from capture ring, which has
+     * dropped captureOverflows edges since start */
+    void tap(const struct sent_edge *edges, size_t cnt, uint32_t captureOverflows) {
+        if (!begin(captureOverflows, true)) {
+            return;
+        }
+        for (size_t i = 0; i < cnt; i++) {
+            put(edges[i]);
+        }
+    }
+
+    /* Same for intervals only known to end at endTime (DMA capture). Here
+     * captureOverflows counts lost DMA buffer halves */
+    void tap(const uint16_t *clocks, size_t cnt, uint32_t endTime, uint32_t captureOverflows) {
+        if (!begin(captureOverflows, false)) {
+            return;
+        }
+        uint32_t time = endTime;
+        for (size_t i = 0; i < cnt; i++) {
+            time -= clocks[i];
+        }
+        for (size_t i = 0; i < cnt; i++) {
+            time += clocks[i];
+            struct sent_edge edge = { time, clocks[i] };
+            put(edge);
+        }
+    }
+
+    /* Consumer: up to max intervals in capture order, endTime is time of last one.
+     * Returned intervals never span a gap: if they follow one, gap is set and lost
+     * is number of intervals known to be lost there (0 if not known) */
+    size_t read(uint16_t *clocks, size_t max, uint32_t *endTime, bool *gap, uint32_t *lost) {
+        size_t cnt = 0;
+
+        *gap = false;
+        *lost = 0;
+        while (cnt < max) {
+            struct sent_edge edge;
+
+            if (m_heldValid) {
+                edge = m_held;
+                m_heldValid = false;
+            } else if (m_ring.pop(&edge, 1) == 0) {
+                break;
+            }
+
+            if (edge.clocks == 0) {
+                if (cnt) {
+                    /* starts next chunk */
+                    m_held = edge;
+                    m_heldValid = true;
+                    break;
+                }
+                *gap = true;
+                *lost += edge.time;
+                continue;
+            }
+            clocks[cnt++] = edge.clocks;
+            *endTime = edge.time;
+        }
+
+        if ((cnt == 0) && (*gap)) {
+            /* nothing to attach gap to yet, keep it for next read */
+            m_held.time = *lost;
+            m_held.clocks = 0;
+            m_heldValid = true;
+            *gap = false;
+            *lost = 0;
+        }
+
+        return cnt;
+    }
+
+private:
+    /* overflows count lost edges if countKnown, otherwise only tell there was a loss */
+    bool begin(uint32_t captureOverflows, bool countKnown) {
+        uint32_t dropped = captureOverflows - m_captureOverflows;
+        m_captureOverflows = captureOverflows;
+
+        if (!isEnabled()) {
+            /* host should not join whatever comes next with what it got before */
+            m_gap = true;
+            m_lost = 0;
+            return false;
+        }
+        if (dropped) {
+            /* capture ring is drained completely each time, lost edges were
+             * somewhere around start of this batch */
+            m_gap = true;
+            m_lost += countKnown ? dropped : 0;
+        }
+        return true;
+    }
+
+    void put(struct sent_edge edge) {
+        if (m_gap) {
+            if (m_ring.isFull()) {
+                m_lost++;
+                return;
+            }
+            struct sent_edge marker = { m_lost, 0 };
+            m_ring.push(marker);
+            m_gap = false;
+            m_lost = 0;
+        }
+        if (m_ring.isFull()) {
+            m_gap = true;
+            m_lost++;
+            return;
+        }
+        if (edge.clocks == 0) {
+            /* 0 is gap marker, 16 bit capture of 65536 clocks interval wraps to it */
+            edge.clocks = 0xffff;
+        }
+        m_ring.push(edge);
+    }
+
+    SentSpscRing<struct sent_edge, N> m_ring;
+    std::atomic<bool> m_on{false};
+
+    /* producer side */
+    uint32_t m_captureOverflows = 0;
+    bool m_gap = true;
+    uint32_t m_lost = 0;
+
+    /* consumer side */
+    struct sent_edge m_held;
+    bool m_heldValid = false;
+};
@@ -0,0 +1,78 @@
+/*
+ * sent_spsc_ring.h
+ *
+ * Wait-free single producer / single consumer ring, used to pass captured
+ * intervals from ISR to decoder thread without taking the kernel lock.
+ * No ChibiOS/HAL dependencies here: this is also built into unit_tests.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+template <typename T, size_t N>
+class SentSpscRing {
+    static_assert((N & (N - 1)) == 0, "ring size should be power of 2");
+
+public:
+    /* Producer side. Returns true if ring was empty before this push, so consumer
+     * should be woken up. On full ring value is dropped and counted. */
+    bool push(T value) {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        uint32_t tail = m_tail.load(std::memory_order_acquire);
+
+        if (head - tail >= N) {
+            /* only producer writes it, no read-modify-write needed */
+            m_overflows.store(m_overflows.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        m_buf[head & (N - 1)] = value;
+        m_head.store(head + 1, std::memory_order_release);
+
+        return head == tail;
+    }
+
+    /* Consumer side. Takes up to max values, returns number taken */
+    size_t pop(T *out, size_t max) {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        uint32_t head = m_head.load(std::memory_order_acquire);
+        size_t n = head - tail;
+
+        if (n > max) {
+            n = max;
+        }
+        for (size_t i = 0; i < n; i++) {
+            out[i] = m_buf[(tail + i) & (N - 1)];
+        }
+        m_tail.store(tail + n, std::memory_order_release);
+
+        return n;
+    }
+
+    /* Producer side: next push would be dropped */
+    bool isFull() const {
+        return m_head.load(std::memory_order_relaxed) - m_tail.load(std::memory_order_acquire) >= N;
+    }
+
+    bool isEmpty() const {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    /* Values waiting, from either side */
+    size_t count() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    uint32_t getOverflowCnt() const {
+        return m_overflows.load(std::memory_order_relaxed);
+    }
+
+private:
+    /* free running indexes, wrap naturally */
+    std::atomic<uint32_t> m_head{0};
+    std::atomic<uint32_t> m_tail{0};
+    std::atomic<uint32_t> m_overflows{0};
+    T m_buf[N];
+};
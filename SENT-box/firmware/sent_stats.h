@@ -0,0 +1,137 @@
+/*
+ * sent_stats.h
+ *
+ * Per channel statistic snapshot, published by decoder thread and copied
+ * whole by UART and CAN publishers, so all counters of one read belong to
+ * the same moment. Also keeps rates of frames, errors and lost frames over
+ * a sliding window.
+ * No ChibiOS/HAL dependencies here: this is also built into unit_tests.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#include "sent.h"
+
+/* Rates are over last SENT_STATS_WINDOW_SLOTS slots of SENT_STATS_SLOT_MS */
+#define SENT_STATS_WINDOW_SLOTS     8
+#define SENT_STATS_SLOT_MS          125
+
+#define SENT_STATS_SLOT_CLOCKS      (SENT_STATS_SLOT_MS * 1000 * SENT_TIMER_CLOCK_MHZ)
+
+/* Counters behind rates: all decoder errors that cost a frame */
+static inline uint32_t SENT_StatsErrors(const struct sent_channel_stats *stats)
+{
+    return stats->crcErr + stats->syncErr + stats->shortIntervalErr + stats->longIntervalErr;
+}
+
+/* part of total in percent, 0 while there is nothing in total */
+static inline uint32_t SENT_StatsPercent(uint32_t part, uint32_t total)
+{
+    return total ? (uint32_t)((uint64_t)part * 100 / total) : 0;
+}
+
+/* Single writer, readers never block writer. Two slots with own sequence
+ * numbers, same scheme as SentFrameRing: writer fills the slot readers are
+ * not pointed at, copy of slot rewritten meanwhile is detected and retried */
+template <size_t WindowSlots = SENT_STATS_WINDOW_SLOTS>
+class SentStatsBlock {
+public:
+    /* Writer side: counters at now (CPU clocks). Rates are filled in here,
+     * straight into the slot, so no copy of stats is kept on writer stack */
+    void publish(const struct sent_channel_stats &stats, uint32_t now) {
+        uint32_t seq = m_last.load(std::memory_order_relaxed) + 1;
+        if (seq == 0) {
+            /* 0 is never used, means "nothing yet" */
+            seq = 1;
+        }
+        slot &dst = m_slots[seq & 1];
+
+        dst.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        dst.stats = stats;
+        updateWindow(dst.stats, now);
+        dst.seq.store(seq, std::memory_order_release);
+        m_last.store(seq, std::memory_order_release);
+    }
+
+    /* Reader side: consistent copy of last published counters, false if nothing published yet */
+    bool read(struct sent_channel_stats *out) const {
+        while (true) {
+            uint32_t seq = m_last.load(std::memory_order_acquire);
+            if (seq == 0) {
+                return false;
+            }
+            const slot &src = m_slots[seq & 1];
+
+            if (src.seq.load(std::memory_order_acquire) != seq) {
+                /* writer got through twice since m_last was read */
+                continue;
+            }
+            *out = src.stats;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (src.seq.load(std::memory_order_relaxed) == seq) {
+                return true;
+            }
+        }
+    }
+
+    /* Times snapshot was published */
+    uint32_t publishCnt() const {
+        return m_last.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct sample {
+        uint32_t time;
+        uint32_t frames;
+        uint32_t errors;
+        uint32_t lost;
+    };
+
+    /* per second over window, 0 while window is empty */
+    static uint32_t rate(uint32_t delta, uint32_t clocks) {
+        return clocks ? (uint32_t)((uint64_t)delta * SENT_TIMER_CLOCK_MHZ * 1000000 / clocks) : 0;
+    }
+
+    /* Writer only. Sample at start of each slot, rate is from oldest sample to now */
+    void updateWindow(struct sent_channel_stats &s, uint32_t now) {
+        struct sample cur = { now, s.frameCnt, SENT_StatsErrors(&s), s.lostFrames };
+
+        /* counters went back: decoder was reset, old samples mean nothing */
+        if ((m_samples) && ((cur.frames < m_window[m_newest].frames) || (cur.errors < m_window[m_newest].errors) ||
+            (cur.lost < m_window[m_newest].lost))) {
+            m_samples = 0;
+        }
+        if ((m_samples == 0) || (now - m_window[m_newest].time >= SENT_STATS_SLOT_CLOCKS)) {
+            m_newest = (m_newest + 1) % (WindowSlots + 1);
+            m_window[m_newest] = cur;
+            if (m_samples <= WindowSlots) {
+                m_samples++;
+            }
+        }
+
+        const struct sample &oldest = m_window[(m_newest + WindowSlots + 2 - m_samples) % (WindowSlots + 1)];
+        uint32_t clocks = now - oldest.time;
+
+        s.frameRate = rate(cur.frames - oldest.frames, clocks);
+        s.errRate = rate(cur.errors - oldest.errors, clocks);
+        s.lostRate = rate(cur.lost - oldest.lost, clocks);
+    }
+
+    struct slot {
+        std::atomic<uint32_t> seq{0};
+        struct sent_channel_stats stats;
+    };
+
+    std::atomic<uint32_t> m_last{0};
+    slot m_slots[2];
+
+    /* writer side window, one more sample than slots, so window spans WindowSlots whole slots */
+    struct sample m_window[WindowSlots + 1] = {};
+    uint32_t m_newest = 0;
+    uint32_t m_samples = 0;
+};
@@ -0,0 +1,169 @@
+/*
+ * sent_telemetry.cpp
+ *
+ * Binary telemetry packet builders and framing
+ */
+
+#include "sent_telemetry.h"
+
+uint16_t SENT_TlmCrc16(const uint8_t *data, size_t n)
+{
+    uint16_t crc = 0xffff;
+
+    for (size_t i = 0; i < n; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+static inline uint8_t *SENT_TlmPut16(uint8_t *p, uint16_t val)
+{
+    p[0] = val & 0xff;
+    p[1] = val >> 8;
+    return p + 2;
+}
+
+static inline uint8_t *SENT_TlmPut32(uint8_t *p, uint32_t val)
+{
+    p = SENT_TlmPut16(p, val & 0xffff);
+    return SENT_TlmPut16(p, val >> 16);
+}
+
+static inline uint16_t SENT_TlmSat16(uint32_t val)
+{
+    return (val > 0xffff) ? 0xffff : val;
+}
+
+static uint8_t *SENT_TlmPutHeader(uint8_t *p, sent_tlm_type type, uint8_t seq, uint32_t time)
+{
+    *p++ = type;
+    *p++ = seq;
+    return SENT_TlmPut32(p, time);
+}
+
+size_t SENT_TlmPackFrames(uint8_t seq, uint32_t time, const struct sent_tlm_frame *frames, uint32_t n, uint8_t *payload)
+{
+    uint8_t *p = SENT_TlmPutHeader(payload, SENT_TLM_FRAMES, seq, time);
+
+    for (uint32_t i = 0; i < n; i++) {
+        const struct sent_tlm_frame *f = &frames[i];
+
+        p = SENT_TlmPut32(p, f->seq);
+        p = SENT_TlmPut32(p, f->syncTime);
+        for (int j = 0; j < SENT_MSG_PAYLOAD_SIZE; j += 2) {
+            *p++ = (f->nibbles[j] & 0x0f) | (f->nibbles[j + 1] << 4);
+        }
+        p = SENT_TlmPut16(p, f->sig0);
+        p = SENT_TlmPut16(p, f->sig1);
+    }
+
+    return p - payload;
+}
+
+size_t SENT_TlmPackStats(uint8_t seq, uint32_t time, const struct sent_channel_stats *stats, uint32_t n, uint8_t *payload)
+{
+    uint8_t *p = SENT_TlmPutHeader(payload, SENT_TLM_STATS, seq, time);
+
+    for (uint32_t i = 0; i < n; i++) {
+        const struct sent_channel_stats *s = &stats[i];
+
+        p = SENT_TlmPut16(p, s->tickNs);
+        p = SENT_TlmPut32(p, s->pulseCnt);
+        p = SENT_TlmPut32(p, s->shortIntervalErr);
+        p = SENT_TlmPut32(p, s->longIntervalErr);
+        p = SENT_TlmPut32(p, s->syncErr);
+        p = SENT_TlmPut32(p, s->crcErr);
+        p = SENT_TlmPut32(p, s->frameCnt);
+        p = SENT_TlmPut32(p, s->intervalOverflow);
+        p = SENT_TlmPut32(p, s->lostFrames);
+        p = SENT_TlmPut16(p, SENT_TlmSat16(s->frameRate));
+        p = SENT_TlmPut16(p, SENT_TlmSat16(s->errRate));
+        p = SENT_TlmPut16(p, SENT_TlmSat16(s->lostRate));
+    }
+
+    return p - payload;
+}
+
+size_t SENT_TlmPackSlow(uint8_t seq, uint32_t time, uint8_t ch, const struct sent_tlm_slow *slow, uint8_t *payload)
+{
+    uint8_t *p = SENT_TlmPutHeader(payload, SENT_TLM_SLOW, seq, time);
+
+    *p++ = ch;
+    *p++ = slow->count;
+    for (uint32_t i = 0; i < slow->count; i++) {
+        const struct sent_slow_msg *msg = &slow->msg[i];
+
+        *p++ = msg->format;
+        *p++ = msg->id;
+        p = SENT_TlmPut16(p, msg->data);
+        p = SENT_TlmPut32(p, msg->time);
+        p = SENT_TlmPut32(p, msg->count);
+    }
+
+    return p - payload;
+}
+
+size_t SENT_TlmPackProf(uint8_t seq, uint32_t time, uint8_t section, const struct sent_prof_hist *hist,
+    uint32_t highWater, uint8_t *payload)
+{
+    uint8_t *p = SENT_TlmPutHeader(payload, SENT_TLM_PROF, seq, time);
+
+    *p++ = section;
+    p = SENT_TlmPut32(p, hist->min);
+    p = SENT_TlmPut32(p, hist->max);
+    p = SENT_TlmPut32(p, hist->count);
+    for (int i = 0; i < SENT_PROF_BINS; i++) {
+        p = SENT_TlmPut32(p, hist->bins[i]);
+    }
+    p = SENT_TlmPut16(p, SENT_TlmSat16(highWater));
+
+    return p - payload;
+}
+
+size_t SENT_TlmPackIntervals(uint8_t seq, uint32_t time, uint8_t ch, bool gap, uint32_t lost, uint32_t endTime,
+    const uint16_t *clocks, size_t n, uint8_t *payload)
+{
+    uint8_t *p = SENT_TlmPutHeader(payload, SENT_TLM_INTERVALS, seq, time);
+
+    *p++ = ch;
+    *p++ = gap ? SENT_TLM_INTERVALS_GAP : 0;
+    p = SENT_TlmPut16(p, (lost > 0xffff) ? 0xffff : lost);
+    p = SENT_TlmPut32(p, endTime);
+    for (size_t i = 0; i < n; i++) {
+        p = SENT_TlmPut16(p, clocks[i]);
+    }
+
+    return p - payload;
+}
+
+size_t SENT_TlmEncode(uint8_t *payload, size_t n, uint8_t *out)
+{
+    uint16_t crc = SENT_TlmCrc16(payload, n);
+    SENT_TlmPut16(payload + n, crc);
+    n += 2;
+
+    /* COBS: each 0x00 is replaced by distance to next one, code byte in front of block */
+    size_t code = 0;
+    size_t len = 1;
+
+    for (size_t i = 0; i < n; i++) {
+        if (payload[i] == 0) {
+            out[code] = len - code;
+            code = len++;
+        } else {
+            out[len++] = payload[i];
+            if (len - code == 0xff) {
+                out[code] = 0xff;
+                code = len++;
+            }
+        }
+    }
+    out[code] = len - code;
+    out[len++] = 0;
+
+    return len;
+}
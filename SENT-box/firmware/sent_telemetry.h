@@ -0,0 +1,125 @@
+/*
+ * sent_telemetry.h
+ *
+ * Binary telemetry stream over UART, replaces text status lines.
+ * No ChibiOS/HAL dependencies here: this is also built into unit_tests,
+ * host side decoder is unit_tests/sent_telemetry_decoder.h
+ *
+ * Each packet is: payload, CRC16 of payload (little endian), all COBS encoded
+ * and terminated with 0x00. Host resyncs on any 0x00 byte.
+ *
+ * Payload starts with common header, all fields little endian:
+ *   type      u8   SENT_TLM_*
+ *   seq       u8   packet counter, gaps mean lost packets
+ *   time      u32  CPU clocks (SENT_TIMER_CLOCK_MHZ) when packet was built
+ *
+ * SENT_TLM_FRAMES, newest frame of each channel, channel count from length:
+ *   seq       u32  frame sequence number, see SENT_GetFrameSeq()
+ *   syncTime  u32  capture time of frame sync edge, CPU clocks
+ *   nibbles   4 x u8, two nibbles per byte, status first, low nibble first
+ *   sig0      s16
+ *   sig1      s16
+ *
+ * SENT_TLM_STATS, error counters of each channel, channel count from length:
+ *   tickNs    u16
+ *   pulses, short, long, sync errors, CRC errors, frames, overflows: 7 x u32
+ *   lost      u32  frames missing from sensor rolling counter sequence
+ *   rates     3 x u16  frames, errors, lost frames per second, saturated
+ *
+ * SENT_TLM_SLOW, live slow channel messages of one channel, by format then ID:
+ *   channel   u8
+ *   count     u8   number of messages
+ *   for each message:
+ *     format  u8   sent_slow_format
+ *     id      u8
+ *     data    u16
+ *     time    u32  sync time of frame completing last update, CPU clocks
+ *     updates u32  updates since message got its mailbox slot
+ *
+ * SENT_TLM_INTERVALS, raw capture intervals of one channel (raw streaming mode):
+ *   channel   u8
+ *   flags     u8   SENT_TLM_INTERVALS_GAP: intervals were lost before first one
+ *   lost      u16  number of lost intervals if known, saturated
+ *   endTime   u32  capture time of last interval end, CPU clocks
+ *   clocks    u16  each interval, count from length
+ *
+ * SENT_TLM_PROF, one timing histogram (SENT_PROFILING builds only), see sent_prof.h:
+ *   section   u8   sent_prof_section
+ *   min, max, count: 3 x u32, CPU cycles
+ *   bins      16 x u32
+ *   highWater u16  mailbox high water mark, saturated
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "sent.h"
+#include "sent_decoder.h"
+#include "sent_prof.h"
+
+typedef enum {
+    SENT_TLM_FRAMES = 1,
+    SENT_TLM_STATS,
+    SENT_TLM_SLOW,
+    SENT_TLM_INTERVALS,
+    SENT_TLM_PROF,
+} sent_tlm_type;
+
+#define SENT_TLM_INTERVALS_GAP  0x01
+
+#define SENT_TLM_MAX_CHANNELS   4
+/* whole mailbox fits into one packet */
+#define SENT_TLM_SLOW_MSGS      SENT_SLOW_MSG_SLOTS
+
+#define SENT_TLM_HEADER_SIZE    6
+#define SENT_TLM_FRAME_SIZE     16
+#define SENT_TLM_STATS_SIZE     40
+#define SENT_TLM_SLOW_MSG_SIZE  12
+#define SENT_TLM_INTERVALS_HEADER_SIZE  8
+#define SENT_TLM_PROF_SIZE      (1 + 3 * 4 + SENT_PROF_BINS * 4 + 2)
+
+#define SENT_TLM_STATS_PAYLOAD  (SENT_TLM_HEADER_SIZE + SENT_TLM_MAX_CHANNELS * SENT_TLM_STATS_SIZE)
+#define SENT_TLM_SLOW_PAYLOAD   (SENT_TLM_HEADER_SIZE + 2 + SENT_TLM_SLOW_MSGS * SENT_TLM_SLOW_MSG_SIZE)
+/* largest payload is stats of all channels or full slow channel mailbox */
+#define SENT_TLM_MAX_PAYLOAD    ((SENT_TLM_STATS_PAYLOAD > SENT_TLM_SLOW_PAYLOAD) ? \
+                                  SENT_TLM_STATS_PAYLOAD : SENT_TLM_SLOW_PAYLOAD)
+/* intervals that fit into largest payload */
+#define SENT_TLM_MAX_INTERVALS  ((SENT_TLM_MAX_PAYLOAD - SENT_TLM_HEADER_SIZE - SENT_TLM_INTERVALS_HEADER_SIZE) / 2)
+static_assert(SENT_TLM_HEADER_SIZE + SENT_TLM_PROF_SIZE <= SENT_TLM_MAX_PAYLOAD, "profiling packet does not fit");
+/* payload + CRC, COBS overhead (one byte per 254) and delimiter */
+#define SENT_TLM_MAX_PACKET     (SENT_TLM_MAX_PAYLOAD + 2 + 1 + 1)
+
+struct sent_tlm_frame {
+    uint32_t seq;
+    uint32_t syncTime;
+    uint8_t nibbles[SENT_MSG_PAYLOAD_SIZE];
+    int16_t sig0;
+    int16_t sig1;
+};
+
+struct sent_tlm_slow {
+    uint8_t count;
+    /* seq is not sent */
+    struct sent_slow_msg msg[SENT_TLM_SLOW_MSGS];
+};
+
+/* CRC16-CCITT, poly 0x1021, init 0xffff */
+uint16_t SENT_TlmCrc16(const uint8_t *data, size_t n);
+
+/* Payload builders, return payload length */
+size_t SENT_TlmPackFrames(uint8_t seq, uint32_t time, const struct sent_tlm_frame *frames, uint32_t n, uint8_t *payload);
+size_t SENT_TlmPackStats(uint8_t seq, uint32_t time, const struct sent_channel_stats *stats, uint32_t n, uint8_t *payload);
+size_t SENT_TlmPackSlow(uint8_t seq, uint32_t time, uint8_t ch, const struct sent_tlm_slow *slow, uint8_t *payload);
+/* n should not exceed SENT_TLM_MAX_INTERVALS */
+size_t SENT_TlmPackIntervals(uint8_t seq, uint32_t time, uint8_t ch, bool gap, uint32_t lost, uint32_t endTime,
+    const uint16_t *clocks, size_t n, uint8_t *payload);
+
+size_t SENT_TlmPackProf(uint8_t seq, uint32_t time, uint8_t section, const struct sent_prof_hist *hist,
+    uint32_t highWater, uint8_t *payload);
+
+/* Append CRC to payload of n bytes (payload buffer needs 2 spare bytes), COBS encode
+ * to out and terminate with 0. out should hold n + 2 + n / 254 + 2 bytes.
+ * Returns bytes to send */
+size_t SENT_TlmEncode(uint8_t *payload, size_t n, uint8_t *out);
@@ -1,18 +1,22 @@
 #include "ch.h"
 #include "hal.h"
-#include "chprintf.h"
 
 #include "uart.h"
 #include "sent.h"
+#include "sent_frame_ring.h"
+#include "sent_telemetry.h"
 #include "io_pins.h"
 #include "mcu-util.h"
 
+static void UartTxEnd(UARTDriver *uartp);
+static void UartRxChar(UARTDriver *uartp, uint16_t c);
+
 static const UARTConfig uartCfg =
 {
-    .txend1_cb = nullptr,
+    .txend1_cb = UartTxEnd,
     .txend2_cb = nullptr,
     .rxend_cb = nullptr,
-    .rxchar_cb = nullptr,
+    .rxchar_cb = UartRxChar,
     .rxerr_cb = nullptr,
     .timeout_cb = nullptr,
 
@@ -27,100 +31,185 @@ static const UARTConfig uartCfg =
     .rxhalf_cb = nullptr,
 };
 
-#define BUFFER_SIZE 300
+/* Telemetry packet period. One packet is built while previous is on the wire */
+#define TLM_PERIOD_MS       1
+/* Every that many periods send stats and slow channel of each channel instead of frames */
+#define TLM_STATS_PERIODS   100
+
+static uint8_t tlmPayload[SENT_TLM_MAX_PAYLOAD + 2];
+static uint8_t tlmBuffer[2][SENT_TLM_MAX_PACKET];
+
+static BSEMAPHORE_DECL(uartTxDone, false);
+
+/* Host switches modes with single character commands */
+#define UART_CMD_TELEMETRY  't'
+#define UART_CMD_RAW        'r'
 
-static char printBuffer[BUFFER_SIZE];
+/* stream raw capture intervals instead of telemetry */
+static volatile bool uartRawMode = false;
 
 static THD_WORKING_AREA(waUartThread, 256);
 
-static void UartThread(void*)
+static void UartTxEnd(UARTDriver *uartp)
 {
-    while(true)
-    {
-        size_t writeCount = 0;
-#if SENT_DEV == SENT_GM_ETB
-        if (1)
-        {
-            uint8_t ptr[8];
-
-            SENT_GetRawNibbles(ptr);
-            writeCount += chsnprintf(printBuffer + writeCount, BUFFER_SIZE - writeCount,
-                "nibbles: ST=%x D=%x:%x:%x:%x:%x:%x CRC=%x",
-                ptr[0], ptr[1], ptr[2], ptr[3], ptr[4], ptr[5], ptr[6], ptr[7]
-                );
-
-            writeCount += chsnprintf(printBuffer + writeCount, BUFFER_SIZE - writeCount,
-                " Errs Short: %06d Long: %06d Sync: %06d CRC: %06d (%03d %%). Frames: %06d\r\n",
-                SENT_GetShortIntervalErrCnt(), SENT_GetLongIntervalErrCnt(), SENT_GetSyncErrCnt(), SENT_GetCrcErrCnt(),
-                SENT_GetCrcErrCnt() * 100 / SENT_GetFrameCnt(0),
-                SENT_GetFrameCnt(0)
-                );
+    (void)uartp;
+
+    chSysLockFromISR();
+    chBSemSignalI(&uartTxDone);
+    chSysUnlockFromISR();
+}
+
+static void UartRxChar(UARTDriver *uartp, uint16_t c)
+{
+    (void)uartp;
+
+    if ((c == UART_CMD_RAW) || (c == UART_CMD_TELEMETRY)) {
+        uartRawMode = (c == UART_CMD_RAW);
+        SENT_SetRawStream(uartRawMode);
+    }
+}
 
+static size_t UartPackFrames(uint8_t seq, uint32_t now)
+{
+    /* newest frame of each channel, kept if there is nothing new */
+    static struct sent_tlm_frame frames[SENT_CHANNELS_NUM];
+
+    for (uint32_t n = 0; n < SENT_CHANNELS_NUM; n++) {
+        struct sent_frame frame;
+        uint32_t frameSeq = SENT_GetFrameSeq(n);
+
+        if ((frameSeq == frames[n].seq) || (!SENT_GetFrame(n, frameSeq, &frame))) {
+            continue;
+        }
+        if (n == 0) {
+            SENT_AccountLatency(SENT_CONSUMER_UART, &frame);
         }
-        if(SENT_IsRawData())
-        {
-            #if 0
-            writeCount += chsnprintf(printBuffer + writeCount, BUFFER_SIZE - writeCount,
-                " Si7215: %04d * 0.1 mT cnt %03d. Tick = %04d nS. Errs Short: %06d Long: %06d Sync: %06d CRC: %06d. Frames: %06d\r\n",
-                Si7215_GetMagneticField(0), Si7215_GetCounter(0),
-                SENT_GetTickTimeNs(),
-                SENT_GetShortIntervalErrCnt(), SENT_GetLongIntervalErrCnt(), SENT_GetSyncErrCnt(), SENT_GetCrcErrCnt(),
-                SENT_GetFrameCnt(0)
-                );
-            #else
-            uint32_t gm_pressure = gm_GetPressure(0);
-            writeCount += chsnprintf(printBuffer + writeCount, BUFFER_SIZE - writeCount,
-                " GM: St %x, Sig0 %04d, Sig1 %04d, %d.%03d Atm Tick = %04d nS.\r\n",
-                gm_GetStat(0), gm_GetSig0(0), gm_GetSig1(0), gm_pressure / 1000, gm_pressure % 1000,
-                SENT_GetTickTimeNs()
-                );
-
-            uint16_t mask = SENT_GetSlowMessagesFlags(0);
-            int i;
-            for (i = 0; i < 16; i++) {
-                if (mask & (1 << i)) {  
-                    uint16_t id = SENT_GetSlowMessageID(0, i);
-                    uint16_t msg = SENT_GetSlowMessage(0, i);
-                    if ((id == 16) || (id == 22))
-                    {
-                        /* these messages looks loke temperature */
-                        writeCount += chsnprintf(printBuffer + writeCount, BUFFER_SIZE - writeCount,
-                            "  msg %d: 0x%04x (%d), T = %d.%05dC ?\r\n",
-                            id, msg, msg, msg / 32, (msg % 32) * 3125
-                            );
-                    }
-                    else
-                    {
-                        writeCount += chsnprintf(printBuffer + writeCount, BUFFER_SIZE - writeCount,
-                            "  msg %d: 0x%04x (%d)\r\n",
-                            SENT_GetSlowMessageID(0, i), SENT_GetSlowMessage(0, i), SENT_GetSlowMessage(0, i)
-                            );
-                    }
-                }
+        frames[n].seq = frameSeq;
+        frames[n].syncTime = frame.syncTime;
+        for (int i = 0; i < SENT_MSG_PAYLOAD_SIZE; i++) {
+            frames[n].nibbles[i] = frame.nibbles[i];
+        }
+        frames[n].sig0 = frame.sig0;
+        frames[n].sig1 = frame.sig1;
+    }
+
+    return SENT_TlmPackFrames(seq, now, frames, SENT_CHANNELS_NUM, tlmPayload);
+}
+
+static size_t UartPackStats(uint8_t seq, uint32_t now)
+{
+    /* too big for stack of this thread */
+    static struct sent_channel_stats stats[SENT_CHANNELS_NUM];
+
+    for (uint32_t n = 0; n < SENT_CHANNELS_NUM; n++) {
+        SENT_GetChannelStats(n, &stats[n]);
+    }
+
+    return SENT_TlmPackStats(seq, now, stats, SENT_CHANNELS_NUM, tlmPayload);
+}
+
+static size_t UartPackSlow(uint8_t seq, uint32_t now, uint32_t n)
+{
+    /* too big for stack of this thread */
+    static struct sent_tlm_slow slow;
+
+    /* Walk ID spaces instead of mailbox slots: host gets messages in stable
+     * order, each copied whole with its time and update count. 288 lookups
+     * of at most SENT_SLOW_MSG_PROBE slots each, fine at telemetry rate */
+    slow.count = 0;
+    for (uint32_t format = 0; format < SENT_SLOW_FORMATS; format++) {
+        uint32_t ids = SENT_SlowIdCount((sent_slow_format)format);
+
+        for (uint32_t id = 0; (id < ids) && (slow.count < SENT_TLM_SLOW_MSGS); id++) {
+            if (SENT_GetSlowMessageById(n, format, id, &slow.msg[slow.count])) {
+                slow.count++;
             }
-            #endif
         }
-        else
-        {
-            writeCount += chsnprintf(printBuffer + writeCount, BUFFER_SIZE - writeCount,
-                "ETB %04d %04d pos=%03d err %06d %06d s_e=%06d c_err=%06d sync=%06d rate=%04d\r\n",
-                SENT_GetOpenThrottleVal(), SENT_GetClosedThrottleVal(), SENT_GetThrottleValPrec(),
-                SENT_GetShortIntervalErrCnt(), SENT_GetLongIntervalErrCnt(), SENT_GetSyncErrCnt(), SENT_GetCrcErrCnt(),
-                SENT_GetSyncCnt(),
-                SENT_GetErrPercent()
-                );
+    }
+
+    return SENT_TlmPackSlow(seq, now, n, &slow, tlmPayload);
+}
+
+#if SENT_PROFILING
+static size_t UartPackProf(uint8_t seq, uint32_t now, uint32_t section)
+{
+    static struct sent_prof prof;
+
+    SENT_GetProf(&prof);
+    return SENT_TlmPackProf(seq, now, section, &prof.hist[section], prof.mailboxHighWater, tlmPayload);
+}
+#endif
+
+/* Next channel with captured intervals, round robin. 0 if there is nothing to send */
+static size_t UartPackIntervals(uint8_t seq, uint32_t now)
+{
+    static uint32_t next = 0;
+    static uint16_t clocks[SENT_TLM_MAX_INTERVALS];
+
+    for (uint32_t i = 0; i < SENT_CHANNELS_NUM; i++) {
+        uint32_t n = next;
+        uint32_t endTime, lost;
+        bool gap;
+
+        next = (next + 1) % SENT_CHANNELS_NUM;
+        size_t cnt = SENT_GetRawIntervals(n, clocks, SENT_TLM_MAX_INTERVALS, &endTime, &gap, &lost);
+        if (cnt) {
+            return SENT_TlmPackIntervals(seq, now, n, gap, lost, endTime, clocks, cnt, tlmPayload);
         }
-#elif SENT_DEV == SENT_SILABS_SENS
-        writeCount += chsnprintf(printBuffer + writeCount, BUFFER_SIZE - writeCount,
-            "%04d %04d %04d %04d err %06d %06d %06d %06d %06d\r\n",
-            SENT_GetData(SENT_CH1), SENT_GetData(SENT_CH2),  SENT_GetData(SENT_CH3),  SENT_GetData(SENT_CH4),
-            SENT_GetMinIntervalErrCnt(), SENT_GetMaxIntervalErrCnt(), SENT_GetSyncErrCnt(),
-            SENT_GetCrcErrCnt(), SENT_GetSyncCnt()
-            );
+    }
+
+    return 0;
+}
+
+static void UartThread(void*)
+{
+    systime_t prev = chVTGetSystemTime();
+    uint32_t period = 0;
+    uint8_t seq = 0;
+    int buf = 0;
+
+    while(true)
+    {
+        uint32_t now = port_rt_get_counter_value();
+        bool raw = uartRawMode;
+        size_t len;
+
+        if (raw) {
+            len = UartPackIntervals(seq, now);
+        } else {
+            uint32_t slot = period % TLM_STATS_PERIODS;
+
+            if (slot == 0) {
+                len = UartPackStats(seq, now);
+            } else if (slot <= SENT_CHANNELS_NUM) {
+                len = UartPackSlow(seq, now, slot - 1);
+#if SENT_PROFILING
+            } else if (slot <= SENT_CHANNELS_NUM + SENT_PROF_NUM) {
+                len = UartPackProf(seq, now, slot - SENT_CHANNELS_NUM - 1);
 #endif
-        uartStartSend(&UARTD1, writeCount, printBuffer);
+            } else {
+                len = UartPackFrames(seq, now);
+            }
+            period++;
+        }
+
+        if (len) {
+            len = SENT_TlmEncode(tlmPayload, len, tlmBuffer[buf]);
+
+            /* other buffer may still be on the wire */
+            chBSemWait(&uartTxDone);
+            uartStartSend(&UARTD1, len, tlmBuffer[buf]);
 
-        chThdSleepMilliseconds(100);
+            buf ^= 1;
+            seq++;
+        }
+
+        if ((raw) && (len)) {
+            /* intervals go as fast as line allows, paced by transmit end */
+            prev = chVTGetSystemTime();
+        } else {
+            prev = chThdSleepUntilWindowed(prev, chTimeAddX(prev, TIME_MS2I(TLM_PERIOD_MS)));
+        }
     }
 }
 
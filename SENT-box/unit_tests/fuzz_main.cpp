@@ -0,0 +1,120 @@
+/**
+ * @file fuzz_main.cpp
+ *
+ * Standalone driver for fuzz target when libFuzzer is not used: runs given
+ * corpus files and directories, or one input from stdin as AFL expects.
+ *
+ * usage: fuzz_sent_decoder [-seed <dir>] [file or dir ...]
+ * -seed writes corpus made of bundled recordings to dir
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "fuzz_sent_decoder.h"
+
+#define FUZZ_SEED_INTERVALS	2048
+
+static bool readFile(FILE *fp, std::vector<uint8_t> &data) {
+	uint8_t buf[4096];
+	size_t n;
+
+	data.clear();
+	while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+		data.insert(data.end(), buf, buf + n);
+	}
+	return !ferror(fp);
+}
+
+static int runFile(const char *path) {
+	FILE *fp = fopen(path, "rb");
+	if (!fp) {
+		printf("Failed to open %s\r\n", path);
+		return -1;
+	}
+	std::vector<uint8_t> data;
+	bool ok = readFile(fp, data);
+	fclose(fp);
+	if (!ok) {
+		return -1;
+	}
+	LLVMFuzzerTestOneInput(data.data(), data.size());
+	return 0;
+}
+
+static int runPath(const char *path) {
+	struct stat st;
+	if (stat(path, &st) != 0) {
+		printf("Failed to open %s\r\n", path);
+		return -1;
+	}
+	if (!S_ISDIR(st.st_mode)) {
+		return runFile(path);
+	}
+
+	DIR *dir = opendir(path);
+	int result = 0;
+	struct dirent *e;
+	while ((dir) && ((e = readdir(dir)) != nullptr)) {
+		if (e->d_name[0] == '.') {
+			continue;
+		}
+		std::string name = std::string(path) + "/" + e->d_name;
+		if (runFile(name.c_str()) != 0) {
+			result = -1;
+		}
+	}
+	if (dir) {
+		closedir(dir);
+	}
+	return result;
+}
+
+static int writeSeeds(const char *dir) {
+	std::vector<std::vector<uint8_t>> seeds;
+	sentFuzzSeeds(seeds, FUZZ_SEED_INTERVALS);
+	mkdir(dir, 0755);
+
+	for (size_t i = 0; i < seeds.size(); i++) {
+		char name[32];
+		snprintf(name, sizeof(name), "/seed-%03d", (int)i);
+		std::string path = std::string(dir) + name;
+		FILE *fp = fopen(path.c_str(), "wb");
+		if (!fp) {
+			printf("Failed to create %s\r\n", path.c_str());
+			return -1;
+		}
+		fwrite(seeds[i].data(), 1, seeds[i].size(), fp);
+		fclose(fp);
+	}
+	printf("%d seeds written to %s\r\n", (int)seeds.size(), dir);
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	if ((argc == 3) && (strcmp(argv[1], "-seed") == 0)) {
+		return writeSeeds(argv[2]);
+	}
+
+	if (argc == 1) {
+		std::vector<uint8_t> data;
+		if (!readFile(stdin, data)) {
+			return -1;
+		}
+		LLVMFuzzerTestOneInput(data.data(), data.size());
+		return 0;
+	}
+
+	int result = 0;
+	for (int i = 1; i < argc; i++) {
+		if (runPath(argv[i]) != 0) {
+			result = -1;
+		}
+	}
+	return result;
+}
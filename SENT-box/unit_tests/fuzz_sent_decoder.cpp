@@ -0,0 +1,181 @@
+/**
+ * @file fuzz_sent_decoder.cpp
+ *
+ * libFuzzer/AFL target: arbitrary interval streams through decoders of every
+ * profile on up to 8 channels, state invariants checked after each batch
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "fuzz_sent_decoder.h"
+#include "sent_channel_set.h"
+#include "sent_test.h"
+#include "sent_test_helpers.h"
+
+#define FUZZ_CHANNELS	8
+
+#define FUZZ_CHECK(cond) do { \
+	if (!(cond)) { \
+		fprintf(stderr, "%s:%d: fuzz invariant failed: %s\n", __FILE__, __LINE__, #cond); \
+		abort(); \
+	} \
+} while (0)
+
+static const sent_split_decoder decoders[] = {
+	SENT_DecodeBatch<SentProfileDefault>,
+	SENT_DecodeBatch<SentProfileGmEtb>,
+	SENT_DecodeBatch<SentProfileGmFuelPressure>,
+	SENT_DecodeBatch<SentProfileSi7215>,
+	SENT_DecodeBatch<SentProfileFord>,
+	SENT_DecodeBatch<SentProfileVariableLength>,
+	SENT_DecodeBatch<SentProfileTracked<SentProfileGmEtb>>,
+	SENT_DecodeBatch<SentProfileTracked<SentProfileGmFuelPressure>>,
+	SENT_DecodeBatch<SentProfileTracked<SentProfileSi7215>>,
+	SENT_DecodeBatch<SentProfileTracked<SentProfileFord>>,
+	SENT_DecodeBatch<SentProfileTracked<SentProfileVariableLength>>,
+};
+
+#define FUZZ_DECODERS	(sizeof(decoders) / sizeof(decoders[0]))
+
+/* table indexes of profiles recordings were taken with */
+#define FUZZ_GM_ETB			1
+#define FUZZ_FUEL_PRESSURE	2
+#define FUZZ_FORD			4
+
+static void checkFrame(struct sent_channel_hot *ch, void *arg) {
+	FUZZ_CHECK(ch->frameDataNibbles <= SENT_MSG_DATA_SIZE);
+	for (size_t i = 0; i < SENT_MSG_PAYLOAD_SIZE; i++) {
+		FUZZ_CHECK(ch->nibbles[i] <= SENT_MAX_INTERVAL);
+	}
+	(*(uint32_t *)arg)++;
+}
+
+static void checkChannel(const SentChannelSet<FUZZ_CHANNELS> &set, uint32_t n, uint32_t pulses, uint32_t frames) {
+	const struct sent_channel_hot *ch = set.hot(n);
+	const struct sent_channel_cold *cold = set.cold(n);
+	struct sent_channel_stats stats;
+
+	FUZZ_CHECK((ch->state >= SM_SENT_INIT_STATE) && (ch->state <= SM_SENT_PAUSE_STATE));
+	FUZZ_CHECK(ch->frameDataNibbles <= SENT_MSG_DATA_SIZE);
+
+	set.getStats(n, &stats);
+	FUZZ_CHECK(stats.pulseCnt == pulses);
+	FUZZ_CHECK(stats.crcErr <= stats.frameCnt);
+	FUZZ_CHECK(stats.frameCnt - stats.crcErr == frames);
+	FUZZ_CHECK(stats.frameCnt <= pulses);
+
+	/* every live message is found where hash and probing put it */
+	for (uint32_t i = 0; i < SENT_SLOW_MSG_SLOTS; i++) {
+		if (cold->scMsgFlags & (1 << i)) {
+			const struct sent_slow_msg *msg = &cold->scMsg[i];
+			FUZZ_CHECK(msg->format <= SENT_SLOW_ENHANCED_16);
+			FUZZ_CHECK(SENT_SlowMsgFind(cold, (sent_slow_format)msg->format, msg->id) == (int)i);
+		}
+	}
+}
+
+static void fuzzDecoder(const uint8_t *data, size_t size) {
+	static SentChannelSet<FUZZ_CHANNELS> set;
+	uint32_t channels = (data[0] & 0x07) + 1;
+	size_t batch = 1 << ((data[0] >> 3) & 0x07);
+	uint32_t pulses[FUZZ_CHANNELS] = {};
+	uint32_t frames[FUZZ_CHANNELS] = {};
+	uint16_t clocks[1 << 7];
+
+	set.reset();
+	const uint8_t *p = data + SENT_FUZZ_HEADER_SIZE;
+	size_t total = (size - SENT_FUZZ_HEADER_SIZE) / 2;
+
+	/* batches go to channels round robin */
+	for (uint32_t k = 0; total; k++) {
+		uint32_t n = k % channels;
+		size_t cnt = (batch < total) ? batch : total;
+
+		for (size_t i = 0; i < cnt; i++, p += 2) {
+			clocks[i] = p[0] | (p[1] << 8);
+		}
+		set.setEdgeTime(n, clocks, cnt, k * 0x10000);
+		int ok = set.decode(n, decoders[(data[1] + n) % FUZZ_DECODERS], clocks, cnt, checkFrame, &frames[n]);
+		FUZZ_CHECK(ok >= 0);
+		pulses[n] += cnt;
+		total -= cnt;
+		checkChannel(set, n, pulses[n], frames[n]);
+	}
+}
+
+static void fuzzSlowMailbox(const uint8_t *data, size_t size) {
+	struct sent_channel_cold cold;
+
+	memset(&cold, 0, sizeof(cold));
+	for (size_t i = SENT_FUZZ_HEADER_SIZE; i + 4 <= size; i += 4) {
+		sent_slow_format format = (sent_slow_format)(data[i] % 3);
+		uint8_t id = data[i + 1];
+		uint16_t value = data[i + 2] | (data[i + 3] << 8);
+
+		SENT_SlowMsgStore(&cold, format, id, value, i);
+		int slot = SENT_SlowMsgFind(&cold, format, id);
+		FUZZ_CHECK((slot >= 0) && (slot < SENT_SLOW_MSG_SLOTS));
+		FUZZ_CHECK(cold.scMsg[slot].data == value);
+		FUZZ_CHECK(cold.scMsg[slot].time == i);
+	}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+	if (size < SENT_FUZZ_HEADER_SIZE) {
+		return 0;
+	}
+
+	if (data[0] & 0x40) {
+		fuzzSlowMailbox(data, size);
+	} else {
+		fuzzDecoder(data, size);
+	}
+
+	return 0;
+}
+
+void sentFuzzMakeInput(uint8_t flags, uint8_t profile, const uint16_t *intervals, size_t n, std::vector<uint8_t> &out) {
+	out.clear();
+	out.push_back(flags);
+	out.push_back(profile);
+	for (size_t i = 0; i < n; i++) {
+		out.push_back(intervals[i] & 0xff);
+		out.push_back(intervals[i] >> 8);
+	}
+}
+
+void sentFuzzSeeds(std::vector<std::vector<uint8_t>> &seeds, size_t maxIntervals) {
+	const struct {
+		const char *fileName;
+		uint8_t profile;
+	} recordings[] = {
+		{ "SENT-ETB.csv", FUZZ_GM_ETB },
+		{ "SENT-fuel-pressure.csv", FUZZ_FUEL_PRESSURE },
+		{ "ford-sent-closed.csv", FUZZ_FORD },
+		{ "ford-sent-idle.csv", FUZZ_FORD },
+	};
+	/* one channel in big batches, four channels with pulse by pulse decoding */
+	const uint8_t flags[] = { (0 << 0) | (7 << 3), (3 << 0) | (0 << 3) };
+
+	for (const auto &rec : recordings) {
+		std::string fileName = std::string(SENT_RECORDINGS_DIR) + rec.fileName;
+		std::vector<uint16_t> intervals;
+
+		if (!sentLoadRecording(fileName.c_str(), intervals)) {
+			continue;
+		}
+
+		for (size_t i = 0; i < intervals.size(); i += maxIntervals) {
+			size_t n = std::min(maxIntervals, intervals.size() - i);
+			for (uint8_t f : flags) {
+				seeds.emplace_back();
+				/* channel 0 gets profile capture was taken with, others its neighbours in table */
+				sentFuzzMakeInput(f, rec.profile, intervals.data() + i, n, seeds.back());
+			}
+		}
+	}
+}
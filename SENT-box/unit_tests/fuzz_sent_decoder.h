@@ -0,0 +1,26 @@
+/**
+ * @file fuzz_sent_decoder.h
+ *
+ * Fuzz target over decoder, channel set and slow channel mailboxes.
+ *
+ * Input: two header bytes, then little endian 16 bit intervals.
+ * header[0] bits 0..2: channels - 1, bits 3..5: batch size is 1 << n,
+ *           bit 6: intervals are (format, id, data) slow channel messages fed to mailbox directly
+ * header[1]: profile of channel n is entry (header[1] + n) of decoder table
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#define SENT_FUZZ_HEADER_SIZE	2
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/* Corpus entry replaying intervals on all channels with given header */
+void sentFuzzMakeInput(uint8_t flags, uint8_t profile, const uint16_t *intervals, size_t n, std::vector<uint8_t> &out);
+
+/* Corpus entries made of bundled recordings, maxIntervals per entry */
+void sentFuzzSeeds(std::vector<std::vector<uint8_t>> &seeds, size_t maxIntervals);
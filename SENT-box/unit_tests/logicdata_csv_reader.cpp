@@ -37,11 +37,6 @@ bool CsvReader::haveMore() {
 		return haveMore();
 	}
 
-    if (m_lineIndex == 100) {
-        printf("It was enough\r\n");
-    	exit(0);
-    }
-
 	return result;
 }
 
@@ -0,0 +1,83 @@
+/*
+ * @file logicdata_interval_reader.cpp
+ *
+ * Streaming logicdata CSV to SENT interval conversion
+ */
+
+#include "logicdata_interval_reader.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+IntervalReader::~IntervalReader() {
+	if (fp) {
+		fclose(fp);
+	}
+}
+
+bool IntervalReader::open(const char *fileName, int column) {
+	printf("Streaming from %s\r\n", fileName);
+	fp = fopen(fileName, "r");
+	m_column = column;
+	m_lineIndex = 0;
+	edges = EdgeToInterval();
+	/* skip "Time[s], Channel 0" header */
+	return fp != nullptr && fgets(buffer, sizeof(buffer), fp) != nullptr;
+}
+
+bool IntervalReader::parseLine(uint64_t *timePs, bool *state) {
+	char *end;
+	double timeStamp = strtod(buffer, &end);
+	if (end == buffer) {
+		return false;
+	}
+	*timePs = (uint64_t)llround(timeStamp * 1e12);
+
+	const char *p = end;
+	for (int i = 0; i <= m_column; i++) {
+		p = strchr(p, ',');
+		if (p == nullptr) {
+			return false;
+		}
+		p++;
+	}
+	while (*p == ' ') {
+		p++;
+	}
+	*state = *p == '1';
+	return true;
+}
+
+size_t IntervalReader::readAll(interval_batch_cb cb, void *arg) {
+	size_t total = 0;
+	size_t n = 0;
+
+	if (fp == nullptr) {
+		return 0;
+	}
+
+	while (fgets(buffer, sizeof(buffer), fp) != nullptr) {
+		uint64_t timePs;
+		bool state;
+
+		m_lineIndex++;
+		if (!parseLine(&timePs, &state)) {
+			continue;
+		}
+		if (edges.onRow(timePs, state, &batch[n])) {
+			n++;
+			if (n == INTERVAL_BATCH_SIZE) {
+				cb(batch, n, arg);
+				total += n;
+				n = 0;
+			}
+		}
+	}
+	if (n) {
+		cb(batch, n, arg);
+		total += n;
+	}
+
+	return total;
+}
@@ -0,0 +1,74 @@
+/*
+ * @file logicdata_interval_reader.h
+ *
+ * Streaming conversion of logic analyzer CSV export ("Time[s], Channel N" edge rows)
+ * into falling edge to falling edge intervals in SENT timer clocks, same as icuGetPeriodX()
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+
+/* SENT-box timers run from 72 MHz */
+#define SENT_CAPTURE_CLOCK_HZ   72000000
+#define INTERVAL_BATCH_SIZE     256
+
+typedef void (*interval_batch_cb)(const uint16_t *clocks, size_t n, void *arg);
+
+/* picoseconds to capture clocks, rounded, saturated as 16 bit capture would not be */
+static inline uint16_t intervalPsToClocks(uint64_t ps) {
+	uint64_t clocks = (ps * (SENT_CAPTURE_CLOCK_HZ / 1000000) + 500000) / 1000000;
+	return clocks > 0xffff ? 0xffff : (uint16_t)clocks;
+}
+
+/* Tracks one channel column, emits interval on each falling edge */
+class EdgeToInterval {
+public:
+	/* returns true and sets clocks when this row is a falling edge with known previous falling edge */
+	bool onRow(uint64_t timePs, bool state, uint16_t *clocks) {
+		bool fall = m_haveState && m_state && !state;
+		m_state = state;
+		m_haveState = true;
+		if (!fall) {
+			return false;
+		}
+		bool result = m_havePrevFall;
+		*clocks = intervalPsToClocks(timePs - m_prevFallPs);
+		m_prevFallPs = timePs;
+		m_havePrevFall = true;
+		return result;
+	}
+
+private:
+	uint64_t m_prevFallPs = 0;
+	bool m_havePrevFall = false;
+	bool m_haveState = false;
+	bool m_state = false;
+};
+
+class IntervalReader {
+public:
+	~IntervalReader();
+
+	/* column is channel index, 0 for first column after timestamp */
+	bool open(const char *fileName, int column = 0);
+	/* stream whole capture, calling cb with up to INTERVAL_BATCH_SIZE intervals at once.
+	 * Returns number of intervals */
+	size_t readAll(interval_batch_cb cb, void *arg);
+
+	int lineIndex() const {
+		return m_lineIndex;
+	}
+
+private:
+	bool parseLine(uint64_t *timePs, bool *state);
+
+	FILE *fp = nullptr;
+	int m_column = 0;
+	int m_lineIndex = 0;
+	char buffer[128];
+	uint16_t batch[INTERVAL_BATCH_SIZE];
+	EdgeToInterval edges;
+};
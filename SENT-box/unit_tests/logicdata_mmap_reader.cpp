@@ -0,0 +1,182 @@
+/*
+ * @file logicdata_mmap_reader.cpp
+ *
+ * Zero-copy logicdata CSV scanner
+ */
+
+#include "logicdata_mmap_reader.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static inline bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+const char *parseTimestampPs(const char *p, const char *end, uint64_t *ps) {
+	static const uint64_t fractionScale[13] = {
+		1000000000000ULL, 100000000000ULL, 10000000000ULL, 1000000000ULL,
+		100000000ULL, 10000000ULL, 1000000ULL, 100000ULL,
+		10000ULL, 1000ULL, 100ULL, 10ULL, 1ULL,
+	};
+	uint64_t seconds = 0;
+	uint64_t fraction = 0;
+	int fractionDigits = 0;
+	bool roundUp = false;
+
+	if (p >= end || !isDigit(*p)) {
+		return nullptr;
+	}
+	while (p < end && isDigit(*p)) {
+		seconds = seconds * 10 + (*p - '0');
+		p++;
+	}
+	if (p < end && *p == '.') {
+		p++;
+		while (p < end && isDigit(*p)) {
+			if (fractionDigits < 12) {
+				fraction = fraction * 10 + (*p - '0');
+			} else if (fractionDigits == 12) {
+				roundUp = *p >= '5';
+			}
+			fractionDigits++;
+			p++;
+		}
+	}
+
+	if (fractionDigits > 12) {
+		fractionDigits = 12;
+	}
+	*ps = seconds * fractionScale[0] + fraction * fractionScale[fractionDigits] + (roundUp ? 1 : 0);
+	return p;
+}
+
+MappedCsvReader::~MappedCsvReader() {
+	close();
+}
+
+bool MappedCsvReader::open(const char *fileName, int column) {
+	close();
+	m_column = column;
+	m_lineIndex = 0;
+	edges = EdgeToInterval();
+
+#ifndef _WIN32
+	int fd = ::open(fileName, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+	void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+	madvise(data, st.st_size, MADV_SEQUENTIAL);
+	m_data = (const char *)data;
+	m_size = st.st_size;
+	m_mapped = true;
+#else
+	/* no mmap on mingw, read whole file instead */
+	FILE *fp = fopen(fileName, "rb");
+	if (fp == nullptr) {
+		return false;
+	}
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	char *data = (char *)malloc(size > 0 ? size : 1);
+	m_size = fread(data, 1, size > 0 ? size : 0, fp);
+	fclose(fp);
+	m_data = data;
+#endif
+
+	m_pos = m_data;
+	m_end = m_data + m_size;
+	return true;
+}
+
+void MappedCsvReader::close() {
+	if (m_data == nullptr) {
+		return;
+	}
+#ifndef _WIN32
+	if (m_mapped) {
+		munmap((void *)m_data, m_size);
+	}
+#else
+	free((void *)m_data);
+#endif
+	m_data = m_pos = m_end = nullptr;
+	m_size = 0;
+	m_mapped = false;
+}
+
+bool MappedCsvReader::nextRow(uint64_t *timePs, bool *state) {
+	while (m_pos < m_end) {
+		const char *line = m_pos;
+		const char *eol = (const char *)memchr(line, '\n', m_end - line);
+		if (eol == nullptr) {
+			eol = m_end;
+		}
+		m_pos = eol + (eol < m_end ? 1 : 0);
+
+		const char *p = parseTimestampPs(line, eol, timePs);
+		if (p == nullptr) {
+			/* header */
+			continue;
+		}
+		int column = -1;
+		while (p < eol && column < m_column) {
+			if (*p++ == ',') {
+				column++;
+			}
+		}
+		while (p < eol && *p == ' ') {
+			p++;
+		}
+		if (column != m_column || p == eol) {
+			continue;
+		}
+		*state = *p == '1';
+		m_lineIndex++;
+		return true;
+	}
+	return false;
+}
+
+size_t MappedCsvReader::readAll(interval_batch_cb cb, void *arg) {
+	size_t total = 0;
+	size_t n = 0;
+	uint64_t timePs;
+	bool state;
+
+	while (nextRow(&timePs, &state)) {
+		if (edges.onRow(timePs, state, &batch[n])) {
+			n++;
+			if (n == INTERVAL_BATCH_SIZE) {
+				cb(batch, n, arg);
+				total += n;
+				n = 0;
+			}
+		}
+	}
+	if (n) {
+		cb(batch, n, arg);
+		total += n;
+	}
+
+	return total;
+}
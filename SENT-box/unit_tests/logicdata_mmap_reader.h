@@ -0,0 +1,52 @@
+/*
+ * @file logicdata_mmap_reader.h
+ *
+ * Zero-copy scanner for large logic analyzer CSV exports: the file is mapped
+ * and rows are parsed in place, timestamps as fixed point picoseconds
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "logicdata_interval_reader.h"
+
+/* Parse "12.345678901234" seconds into picoseconds, digits after 12th decimal are rounded.
+ * No locale, no floating point. Returns pointer past the number or nullptr if there is no number */
+const char *parseTimestampPs(const char *p, const char *end, uint64_t *ps);
+
+class MappedCsvReader {
+public:
+	~MappedCsvReader();
+
+	/* column is channel index, 0 for first column after timestamp */
+	bool open(const char *fileName, int column = 0);
+	void close();
+
+	/* next data row, header and malformed lines are skipped */
+	bool nextRow(uint64_t *timePs, bool *state);
+
+	/* same contract as IntervalReader::readAll() */
+	size_t readAll(interval_batch_cb cb, void *arg);
+
+	size_t size() const {
+		return m_size;
+	}
+
+	int lineIndex() const {
+		return m_lineIndex;
+	}
+
+private:
+	const char *m_data = nullptr;
+	size_t m_size = 0;
+	const char *m_pos = nullptr;
+	const char *m_end = nullptr;
+	bool m_mapped = false;
+
+	int m_column = 0;
+	int m_lineIndex = 0;
+	uint16_t batch[INTERVAL_BATCH_SIZE];
+	EdgeToInterval edges;
+};
@@ -7,9 +7,10 @@
 
 
 #include <stdlib.h>
-#include "logicdata_csv_reader.h"
+#include "sent_test.h"
 
 bool hasInitGtest = false;
+int sentTestFailures = 0;
 
 int main(int argc, char **argv) {
 	hasInitGtest = true;
@@ -17,17 +18,42 @@ int main(int argc, char **argv) {
 
 	printf("Hello SENT tests\r\n");
 
-	{	
-		CsvReader r;
-		r.open("../SENT-recordings/SENT-ETB.csv");
-
-		while (r.haveMore()) {
-		    r.processLine(nullptr);
-		}
-	}
-
-
-	int result = 0;
+	testEdgeToInterval();
+	testParseTimestamp();
+	testMappedReaderMatchesStreaming();
+	testSentCrc();
+	testSentDecoder();
+	testSentReplay();
+	testSentDmaRing();
+	testSentEdgeCapture();
+	testSentCapture();
+	testSentSpscRing();
+	testSentFrameRing();
+	testSentStats();
+	testSentCan();
+	testSentChannelSet();
+	testSentEmulator();
+	testSentTelemetry();
+	testSentRawStream();
+	testSentSlowChannel();
+	testSentNibbleClassifier();
+	testSentProf();
+	testSentFuzz();
+
+	benchmarkSentReplay();
+	benchmarkSentStreaming();
+	benchmarkSentBatch();
+	benchmarkSentTickTracking();
+	benchmarkSentChannelSet();
+	benchmarkSentCapture();
+	benchmarkSentEmulator();
+	benchmarkSentCrc();
+	benchmarkSentNibbleClassifier();
+	benchmarkSentSlowChannel();
+	benchmarkCsvReaders();
+
+	int result = sentTestFailures;
+	printf("%d failure(s)\r\n", sentTestFailures);
 	// windows ERRORLEVEL in Jenkins batch file seems to want negative value to detect failure
 	return result == 0 ? 0 : -1;
 }
@@ -0,0 +1,128 @@
+/*
+ * @file sent_raw_recorder.cpp
+ *
+ * SENT-box raw interval stream to CSV recording
+ */
+
+#include "sent_raw_recorder.h"
+
+#include <algorithm>
+#include <cstdio>
+
+uint64_t RawRecorder::unwrap(uint32_t time) {
+	if (!m_haveTime) {
+		/* leave room for intervals before first time seen */
+		m_lastTime = (1ULL << 32) + time;
+		m_haveTime = true;
+	} else {
+		m_lastTime += (int32_t)(time - m_lastRawTime);
+	}
+	m_lastRawTime = time;
+
+	return m_lastTime;
+}
+
+void RawRecorder::onPacket(const struct sent_tlm_packet *packet) {
+	if ((packet->type != SENT_TLM_INTERVALS) || (packet->rawChannel >= SENT_TLM_MAX_CHANNELS) ||
+		(packet->rawCnt == 0)) {
+		return;
+	}
+	uint32_t n = packet->rawChannel;
+	uint64_t endTime = unwrap(packet->rawEndTime);
+
+	m_channels = std::max(m_channels, n + 1);
+	intervalCnt[n] += packet->rawCnt;
+
+	uint64_t time = m_lastFall[n];
+	if ((packet->rawGap) || (!m_started[n])) {
+		/* anchor to capture time, falling edge starting first interval */
+		uint64_t sum = 0;
+		for (uint32_t i = 0; i < packet->rawCnt; i++) {
+			sum += packet->raw[i];
+		}
+		uint64_t start = endTime - sum;
+		if ((m_started[n]) && (start <= m_lastFall[n])) {
+			/* ISR timestamp jitter on short gap, keep edges in order */
+			start = m_lastFall[n] + 1;
+		}
+		if (m_started[n]) {
+			gapCnt[n]++;
+			lostCnt[n] += packet->rawLost;
+		}
+		m_started[n] = true;
+		time = start;
+		m_falls.push_back({ time, (uint8_t)n });
+	}
+
+	for (uint32_t i = 0; i < packet->rawCnt; i++) {
+		time += packet->raw[i];
+		m_falls.push_back({ time, (uint8_t)n });
+	}
+	m_lastFall[n] = time;
+}
+
+bool RawRecorder::writeCsv(const char *fileName) const {
+	struct event {
+		uint64_t time;
+		uint8_t ch;
+		bool state;
+	};
+	std::vector<event> events;
+	std::vector<fall> falls = m_falls;
+
+	if (falls.empty()) {
+		return false;
+	}
+	std::stable_sort(falls.begin(), falls.end(), [](const fall &a, const fall &b) {
+		return a.time < b.time;
+	});
+
+	/* each channel rises half way to its next fall */
+	uint64_t prevFall[SENT_TLM_MAX_CHANNELS];
+	bool havePrev[SENT_TLM_MAX_CHANNELS] = {};
+	for (const fall &f : falls) {
+		if (havePrev[f.ch]) {
+			events.push_back({ prevFall[f.ch] + (f.time - prevFall[f.ch]) / 2, f.ch, true });
+		}
+		events.push_back({ f.time, f.ch, false });
+		prevFall[f.ch] = f.time;
+		havePrev[f.ch] = true;
+	}
+	std::stable_sort(events.begin(), events.end(), [](const event &a, const event &b) {
+		return a.time < b.time;
+	});
+
+	FILE *fp = fopen(fileName, "w");
+	if (fp == nullptr) {
+		return false;
+	}
+
+	/* idle high line 1 uS before first edge at time 0 */
+	uint64_t origin = falls[0].time - SENT_TIMER_CLOCK_MHZ;
+	bool state[SENT_TLM_MAX_CHANNELS];
+
+	fprintf(fp, "Time[s]");
+	for (uint32_t n = 0; n < m_channels; n++) {
+		fprintf(fp, ", Channel %d", n);
+		state[n] = true;
+	}
+	fprintf(fp, "\n");
+
+	for (size_t i = 0; i <= events.size(); i++) {
+		uint64_t time = origin;
+		if (i > 0) {
+			time = events[i - 1].time;
+			state[events[i - 1].ch] = events[i - 1].state;
+		}
+		/* clocks to picoseconds, truncation error is far below one clock */
+		uint64_t ps = (time - origin) * 1000000 / SENT_TIMER_CLOCK_MHZ;
+		fprintf(fp, "%llu.%012llu", (unsigned long long)(ps / 1000000000000ULL),
+			(unsigned long long)(ps % 1000000000000ULL));
+		for (uint32_t n = 0; n < m_channels; n++) {
+			fprintf(fp, ", %d", state[n] ? 1 : 0);
+		}
+		fprintf(fp, "\n");
+	}
+
+	return fclose(fp) == 0;
+}
@@ -0,0 +1,50 @@
+/*
+ * @file sent_raw_recorder.h
+ *
+ * SENT-box raw interval stream (SENT_TLM_INTERVALS packets) to logic analyzer style
+ * CSV, same format as SENT-recordings CSV exports, so IntervalReader replays it directly
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "sent_telemetry_decoder.h"
+
+class RawRecorder {
+public:
+	/* other packet types are ignored */
+	void onPacket(const struct sent_tlm_packet *packet);
+	/* "Time[s], Channel 0, Channel 1, ..." with a column for every channel up to last one seen.
+	 * Falling edges are exact, rising edges are placed half way as only falling edges are captured */
+	bool writeCsv(const char *fileName) const;
+
+	uint32_t channels() const {
+		return m_channels;
+	}
+
+	uint32_t intervalCnt[SENT_TLM_MAX_CHANNELS] = {};
+	/* discontinuities, lost intervals where count is known */
+	uint32_t gapCnt[SENT_TLM_MAX_CHANNELS] = {};
+	uint32_t lostCnt[SENT_TLM_MAX_CHANNELS] = {};
+
+private:
+	/* 32 bit capture time to 64 bit, packets of all channels come roughly in time order */
+	uint64_t unwrap(uint32_t time);
+
+	struct fall {
+		uint64_t time;
+		uint8_t ch;
+	};
+
+	std::vector<fall> m_falls;
+	uint32_t m_channels = 0;
+	bool m_started[SENT_TLM_MAX_CHANNELS] = {};
+	uint64_t m_lastFall[SENT_TLM_MAX_CHANNELS] = {};
+
+	bool m_haveTime = false;
+	uint32_t m_lastRawTime = 0;
+	uint64_t m_lastTime = 0;
+};
@@ -0,0 +1,81 @@
+/*
+ * @file sent_record.cpp
+ *
+ * Host tool: record SENT-box raw interval stream to CSV for unit test replay
+ *
+ * usage: sent_record <serial port or captured stream> <out.csv>
+ * Serial port should be set up first, for example: stty -F /dev/ttyUSB0 921600 raw
+ * SENT-box is switched to raw streaming while recording, Ctrl-C stops it.
+ */
+
+#include <csignal>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "sent_raw_recorder.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSigInt(int) {
+	stopRequested = 1;
+}
+
+static void onPacket(const struct sent_tlm_packet *packet, void *arg) {
+	((RawRecorder *)arg)->onPacket(packet);
+}
+
+int main(int argc, char **argv) {
+	if (argc != 3) {
+		printf("usage: %s <serial port or captured stream> <out.csv>\r\n", argv[0]);
+		return -1;
+	}
+
+	int fd = open(argv[1], O_RDWR);
+	if (fd < 0) {
+		fd = open(argv[1], O_RDONLY);
+	}
+	if (fd < 0) {
+		printf("Failed to open %s\r\n", argv[1]);
+		return -1;
+	}
+
+	bool live = isatty(fd);
+	if (live) {
+		/* see UART_CMD_RAW in firmware/uart.cpp */
+		if (write(fd, "r", 1) != 1) {
+			printf("Failed to switch SENT-box to raw streaming\r\n");
+		}
+		printf("Recording, Ctrl-C to stop\r\n");
+	}
+	signal(SIGINT, onSigInt);
+
+	RawRecorder recorder;
+	TelemetryDecoder decoder;
+	uint8_t buf[4096];
+	ssize_t n;
+
+	while ((!stopRequested) && ((n = read(fd, buf, sizeof(buf))) > 0)) {
+		decoder.feed(buf, n, onPacket, &recorder);
+	}
+
+	if (live) {
+		if (write(fd, "t", 1) != 1) {
+			printf("Failed to switch SENT-box back to telemetry\r\n");
+		}
+	}
+	close(fd);
+
+	printf("%d packets, %d bad, %d lost\r\n", decoder.packetCnt, decoder.badPacketCnt, decoder.lostPacketCnt);
+	for (uint32_t ch = 0; ch < recorder.channels(); ch++) {
+		printf("Channel %d: %d intervals, %d gaps, %d intervals lost\r\n",
+			ch, recorder.intervalCnt[ch], recorder.gapCnt[ch], recorder.lostCnt[ch]);
+	}
+
+	if (!recorder.writeCsv(argv[2])) {
+		printf("Nothing written to %s\r\n", argv[2]);
+		return -1;
+	}
+
+	return 0;
+}
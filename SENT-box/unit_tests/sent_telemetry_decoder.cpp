@@ -0,0 +1,183 @@
+/*
+ * @file sent_telemetry_decoder.cpp
+ *
+ * Host side decoder of SENT-box binary telemetry stream
+ */
+
+#include "sent_telemetry_decoder.h"
+
+#include <cstring>
+
+size_t sentTlmCobsDecode(const uint8_t *in, size_t n, uint8_t *out) {
+	size_t len = 0;
+	size_t i = 0;
+
+	while (i < n) {
+		uint8_t code = in[i++];
+		if ((code == 0) || (i + code - 1 > n)) {
+			return 0;
+		}
+		for (int j = 1; j < code; j++) {
+			if (in[i] == 0) {
+				return 0;
+			}
+			out[len++] = in[i++];
+		}
+		/* implied zero, except after full block and at the very end */
+		if ((code != 0xff) && (i < n)) {
+			out[len++] = 0;
+		}
+	}
+
+	return len;
+}
+
+static uint16_t get16(const uint8_t *p) {
+	return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t *p) {
+	return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+bool sentTlmParse(const uint8_t *payload, size_t n, struct sent_tlm_packet *packet) {
+	if (n < SENT_TLM_HEADER_SIZE) {
+		return false;
+	}
+	memset(packet, 0, sizeof(*packet));
+	packet->type = (sent_tlm_type)payload[0];
+	packet->seq = payload[1];
+	packet->time = get32(payload + 2);
+
+	const uint8_t *p = payload + SENT_TLM_HEADER_SIZE;
+	size_t body = n - SENT_TLM_HEADER_SIZE;
+
+	switch (packet->type) {
+	case SENT_TLM_FRAMES:
+		if ((body % SENT_TLM_FRAME_SIZE) || (body / SENT_TLM_FRAME_SIZE > SENT_TLM_MAX_CHANNELS)) {
+			return false;
+		}
+		packet->channels = body / SENT_TLM_FRAME_SIZE;
+		for (uint32_t i = 0; i < packet->channels; i++, p += SENT_TLM_FRAME_SIZE) {
+			struct sent_tlm_frame *f = &packet->frames[i];
+			f->seq = get32(p);
+			f->syncTime = get32(p + 4);
+			for (int j = 0; j < SENT_MSG_PAYLOAD_SIZE / 2; j++) {
+				f->nibbles[2 * j] = p[8 + j] & 0x0f;
+				f->nibbles[2 * j + 1] = p[8 + j] >> 4;
+			}
+			f->sig0 = (int16_t)get16(p + 12);
+			f->sig1 = (int16_t)get16(p + 14);
+		}
+		return true;
+	case SENT_TLM_STATS:
+		if ((body % SENT_TLM_STATS_SIZE) || (body / SENT_TLM_STATS_SIZE > SENT_TLM_MAX_CHANNELS)) {
+			return false;
+		}
+		packet->channels = body / SENT_TLM_STATS_SIZE;
+		for (uint32_t i = 0; i < packet->channels; i++, p += SENT_TLM_STATS_SIZE) {
+			struct sent_channel_stats *s = &packet->stats[i];
+			s->tickNs = get16(p);
+			s->pulseCnt = get32(p + 2);
+			s->shortIntervalErr = get32(p + 6);
+			s->longIntervalErr = get32(p + 10);
+			s->syncErr = get32(p + 14);
+			s->crcErr = get32(p + 18);
+			s->frameCnt = get32(p + 22);
+			s->intervalOverflow = get32(p + 26);
+			s->lostFrames = get32(p + 30);
+			s->frameRate = get16(p + 34);
+			s->errRate = get16(p + 36);
+			s->lostRate = get16(p + 38);
+		}
+		return true;
+	case SENT_TLM_SLOW: {
+		if ((body < 2) || (p[1] > SENT_TLM_SLOW_MSGS) || (body != 2 + (size_t)p[1] * SENT_TLM_SLOW_MSG_SIZE)) {
+			return false;
+		}
+		packet->slowChannel = p[0];
+		packet->slow.count = p[1];
+		p += 2;
+		for (uint32_t i = 0; i < packet->slow.count; i++) {
+			struct sent_slow_msg *msg = &packet->slow.msg[i];
+			msg->format = p[0];
+			msg->id = p[1];
+			msg->data = get16(p + 2);
+			msg->time = get32(p + 4);
+			msg->count = get32(p + 8);
+			msg->seq = 0;
+			p += SENT_TLM_SLOW_MSG_SIZE;
+		}
+		return true;
+	}
+	case SENT_TLM_INTERVALS:
+		if ((body < SENT_TLM_INTERVALS_HEADER_SIZE) || ((body - SENT_TLM_INTERVALS_HEADER_SIZE) % 2) ||
+			((body - SENT_TLM_INTERVALS_HEADER_SIZE) / 2 > SENT_TLM_MAX_INTERVALS)) {
+			return false;
+		}
+		packet->rawChannel = p[0];
+		packet->rawGap = (p[1] & SENT_TLM_INTERVALS_GAP) != 0;
+		packet->rawLost = get16(p + 2);
+		packet->rawEndTime = get32(p + 4);
+		packet->rawCnt = (body - SENT_TLM_INTERVALS_HEADER_SIZE) / 2;
+		for (uint32_t i = 0; i < packet->rawCnt; i++) {
+			packet->raw[i] = get16(p + SENT_TLM_INTERVALS_HEADER_SIZE + 2 * i);
+		}
+		return true;
+	case SENT_TLM_PROF:
+		if (body != SENT_TLM_PROF_SIZE) {
+			return false;
+		}
+		packet->profSection = p[0];
+		packet->prof.min = get32(p + 1);
+		packet->prof.max = get32(p + 5);
+		packet->prof.count = get32(p + 9);
+		for (int i = 0; i < SENT_PROF_BINS; i++) {
+			packet->prof.bins[i] = get32(p + 13 + 4 * i);
+		}
+		packet->profHighWater = get16(p + 13 + 4 * SENT_PROF_BINS);
+		return true;
+	default:
+		return false;
+	}
+}
+
+void TelemetryDecoder::onPacket(sent_tlm_packet_cb cb, void *arg) {
+	uint8_t payload[SENT_TLM_MAX_PACKET];
+	struct sent_tlm_packet packet;
+
+	size_t n = sentTlmCobsDecode(m_buf, m_len, payload);
+	if ((n < 2) || (SENT_TlmCrc16(payload, n - 2) != get16(payload + n - 2)) ||
+		(!sentTlmParse(payload, n - 2, &packet))) {
+		badPacketCnt++;
+		return;
+	}
+
+	if (m_haveSeq) {
+		lostPacketCnt += (uint8_t)(packet.seq - m_seq - 1);
+	}
+	m_seq = packet.seq;
+	m_haveSeq = true;
+	packetCnt++;
+	if (cb) {
+		cb(&packet, arg);
+	}
+}
+
+void TelemetryDecoder::feed(const uint8_t *data, size_t n, sent_tlm_packet_cb cb, void *arg) {
+	for (size_t i = 0; i < n; i++) {
+		if (data[i] == 0) {
+			if (m_overflow) {
+				badPacketCnt++;
+			} else if (m_len) {
+				onPacket(cb, arg);
+			}
+			m_len = 0;
+			m_overflow = false;
+		} else if (m_len < sizeof(m_buf)) {
+			m_buf[m_len++] = data[i];
+		} else {
+			m_overflow = true;
+		}
+	}
+}
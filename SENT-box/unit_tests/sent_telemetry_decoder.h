@@ -0,0 +1,65 @@
+/*
+ * @file sent_telemetry_decoder.h
+ *
+ * Host side decoder of SENT-box binary telemetry stream, see firmware/sent_telemetry.h
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "sent_telemetry.h"
+
+struct sent_tlm_packet {
+	sent_tlm_type type;
+	uint8_t seq;
+	uint32_t time;
+	/* SENT_TLM_FRAMES, SENT_TLM_STATS */
+	uint32_t channels;
+	struct sent_tlm_frame frames[SENT_TLM_MAX_CHANNELS];
+	struct sent_channel_stats stats[SENT_TLM_MAX_CHANNELS];
+	/* SENT_TLM_SLOW */
+	uint8_t slowChannel;
+	struct sent_tlm_slow slow;
+	/* SENT_TLM_INTERVALS */
+	uint8_t rawChannel;
+	bool rawGap;
+	uint16_t rawLost;
+	uint32_t rawEndTime;
+	uint32_t rawCnt;
+	uint16_t raw[SENT_TLM_MAX_INTERVALS];
+	/* SENT_TLM_PROF */
+	uint8_t profSection;
+	struct sent_prof_hist prof;
+	uint16_t profHighWater;
+};
+
+typedef void (*sent_tlm_packet_cb)(const struct sent_tlm_packet *packet, void *arg);
+
+/* COBS decode one packet without delimiter, returns decoded length or 0 if malformed */
+size_t sentTlmCobsDecode(const uint8_t *in, size_t n, uint8_t *out);
+
+/* Parse payload (CRC already checked and stripped), false if length does not match type */
+bool sentTlmParse(const uint8_t *payload, size_t n, struct sent_tlm_packet *packet);
+
+/* Byte stream to packets, bytes can come in chunks of any size */
+class TelemetryDecoder {
+public:
+	void feed(const uint8_t *data, size_t n, sent_tlm_packet_cb cb, void *arg);
+
+	uint32_t packetCnt = 0;
+	/* packets with bad COBS framing, bad CRC or unknown layout */
+	uint32_t badPacketCnt = 0;
+	/* gaps in packet seq */
+	uint32_t lostPacketCnt = 0;
+
+private:
+	void onPacket(sent_tlm_packet_cb cb, void *arg);
+
+	uint8_t m_buf[SENT_TLM_MAX_PACKET];
+	size_t m_len = 0;
+	bool m_overflow = false;
+	bool m_haveSeq = false;
+	uint8_t m_seq = 0;
+};
@@ -0,0 +1,99 @@
+/**
+ * @file sent_test.h
+ *
+ * Minimal check helpers for SENT unit tests and host benchmarks
+ */
+
+#pragma once
+
+#include <cstdio>
+
+#define SENT_RECORDINGS_DIR "../SENT-recordings/"
+
+extern int sentTestFailures;
+
+#define EXPECT_EQ(expected, actual) do { \
+	long long _e = (long long)(expected); \
+	long long _a = (long long)(actual); \
+	if (_e != _a) { \
+		printf("%s:%d: expected %s == %lld, got %lld\r\n", __FILE__, __LINE__, #actual, _e, _a); \
+		sentTestFailures++; \
+	} \
+} while (0)
+
+#define EXPECT_TRUE(cond) do { \
+	if (!(cond)) { \
+		printf("%s:%d: expected %s\r\n", __FILE__, __LINE__, #cond); \
+		sentTestFailures++; \
+	} \
+} while (0)
+
+/* test_logicdata_reader.cpp */
+void testEdgeToInterval();
+void testParseTimestamp();
+void testMappedReaderMatchesStreaming();
+void benchmarkCsvReaders();
+
+/* test_sent_can.cpp */
+void testSentCan();
+
+/* test_sent_capture.cpp */
+void testSentCapture();
+void benchmarkSentCapture();
+
+/* test_sent_channel_set.cpp */
+void testSentChannelSet();
+void benchmarkSentChannelSet();
+
+/* test_sent_crc.cpp */
+void testSentCrc();
+void benchmarkSentCrc();
+
+/* test_sent_decoder.cpp */
+void testSentDecoder();
+
+/* test_sent_dma_ring.cpp */
+void testSentDmaRing();
+
+/* test_sent_edge_capture.cpp */
+void testSentEdgeCapture();
+
+/* test_sent_emulator.cpp */
+void testSentEmulator();
+void benchmarkSentEmulator();
+
+/* test_sent_fuzz.cpp */
+void testSentFuzz();
+
+/* test_sent_slow_channel.cpp */
+void testSentSlowChannel();
+void benchmarkSentSlowChannel();
+
+/* test_sent_spsc_ring.cpp */
+void testSentSpscRing();
+
+/* test_sent_stats.cpp */
+void testSentStats();
+
+/* test_sent_frame_ring.cpp */
+void testSentFrameRing();
+
+/* test_sent_telemetry.cpp */
+void testSentTelemetry();
+
+/* test_sent_nibble.cpp */
+void testSentNibbleClassifier();
+void benchmarkSentNibbleClassifier();
+
+/* test_sent_prof.cpp */
+void testSentProf();
+
+/* test_sent_raw_stream.cpp */
+void testSentRawStream();
+
+/* test_sent_replay.cpp */
+void testSentReplay();
+void benchmarkSentReplay();
+void benchmarkSentStreaming();
+void benchmarkSentBatch();
+void benchmarkSentTickTracking();
@@ -0,0 +1,28 @@
+/**
+ * @file sent_test_helpers.cpp
+ */
+
+#include "logicdata_interval_reader.h"
+#include "sent_test_helpers.h"
+
+void sentAppendIntervals(const uint16_t *clocks, size_t n, void *arg) {
+	std::vector<uint16_t> *intervals = (std::vector<uint16_t> *)arg;
+	intervals->insert(intervals->end(), clocks, clocks + n);
+}
+
+bool sentLoadRecording(const char *fileName, std::vector<uint16_t> &intervals, int column) {
+	IntervalReader r;
+
+	if (!r.open(fileName, column)) {
+		return false;
+	}
+	r.readAll(sentAppendIntervals, &intervals);
+	return true;
+}
+
+std::vector<uint16_t> sentLoadRecording(const char *fileName, int column) {
+	std::vector<uint16_t> intervals;
+
+	sentLoadRecording(fileName, intervals, column);
+	return intervals;
+}
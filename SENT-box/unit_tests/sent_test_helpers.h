@@ -0,0 +1,41 @@
+/**
+ * @file sent_test_helpers.h
+ *
+ * Test inputs shared by SENT unit tests: recorded intervals and synthetic frames
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "sent.h"
+#include "sent_crc.h"
+
+/* IntervalReader/MappedCsvReader readAll() callback, arg is std::vector<uint16_t> to append to */
+void sentAppendIntervals(const uint16_t *clocks, size_t n, void *arg);
+
+/* All intervals of recording in column, fileName is path as given to IntervalReader::open().
+ * False if file does not open */
+bool sentLoadRecording(const char *fileName, std::vector<uint16_t> &intervals, int column = 0);
+std::vector<uint16_t> sentLoadRecording(const char *fileName, int column = 0);
+
+/* Intervals of one frame in tick clocks: sync, status, n data nibbles, CRC
+ * (recommended variant), and pause pulse of pauseClocks if not 0 */
+template <class T>
+void sentAppendFrame(std::vector<T> &pulses, uint32_t tick, uint8_t status, const uint8_t *data, uint8_t n,
+		uint32_t pauseClocks = 0) {
+	uint8_t frame[SENT_MSG_DATA_SIZE];
+
+	memcpy(frame, data, n);
+	pulses.push_back(56 * tick);
+	pulses.push_back((SENT_OFFSET_INTERVAL + status) * tick);
+	for (uint8_t i = 0; i < n; i++) {
+		pulses.push_back((SENT_OFFSET_INTERVAL + data[i]) * tick);
+	}
+	pulses.push_back((SENT_OFFSET_INTERVAL + sent_crc4_gm(frame, n)) * tick);
+	if (pauseClocks) {
+		pulses.push_back(pauseClocks);
+	}
+}
@@ -0,0 +1,142 @@
+/**
+ * @file test_logicdata_reader.cpp
+ *
+ * Capture file to interval conversion tests
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "logicdata_csv_reader.h"
+#include "logicdata_interval_reader.h"
+#include "logicdata_mmap_reader.h"
+#include "sent_test.h"
+#include "sent_test_helpers.h"
+
+void testEdgeToInterval() {
+	EdgeToInterval edges;
+	uint16_t clocks = 0;
+
+	/* initial state row is not an edge */
+	EXPECT_TRUE(!edges.onRow(0, true, &clocks));
+	/* first falling edge has nothing to measure from */
+	EXPECT_TRUE(!edges.onRow(1000000, false, &clocks));
+	EXPECT_TRUE(!edges.onRow(2000000, true, &clocks));
+	/* repeated high row (other channel changed) is not an edge */
+	EXPECT_TRUE(!edges.onRow(2500000, true, &clocks));
+	/* 13.625 uS = 981 clocks */
+	EXPECT_TRUE(edges.onRow(1000000 + 13625000, false, &clocks));
+	EXPECT_EQ(981, clocks);
+	/* repeated low row is not a falling edge */
+	EXPECT_TRUE(!edges.onRow(20000000, false, &clocks));
+	EXPECT_TRUE(!edges.onRow(21000000, true, &clocks));
+	/* 62.5 nS = 4.5 clocks rounds up */
+	EXPECT_TRUE(edges.onRow(1000000 + 13625000 + 62500, false, &clocks));
+	EXPECT_EQ(5, clocks);
+	/* gaps longer than 16 bit capture saturate */
+	EXPECT_TRUE(!edges.onRow(100000000, true, &clocks));
+	EXPECT_TRUE(edges.onRow(1000000000, false, &clocks));
+	EXPECT_EQ(0xffff, clocks);
+}
+
+void testParseTimestamp() {
+	const char *samples[] = { "0.000013625000000", "12.5", "7", "0.810653208333333", "0.0000000000005", "1.0000000000004999" };
+	const uint64_t expected[] = { 13625000, 12500000000000, 7000000000000, 810653208333, 1, 1000000000000 };
+
+	for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+		uint64_t ps = 0;
+		const char *end = samples[i] + strlen(samples[i]);
+		EXPECT_TRUE(parseTimestampPs(samples[i], end, &ps) == end);
+		EXPECT_EQ(expected[i], ps);
+	}
+
+	uint64_t ps;
+	const char *header = "Time[s], Channel 0";
+	EXPECT_TRUE(parseTimestampPs(header, header + strlen(header), &ps) == nullptr);
+}
+
+static const char *captures[] = {
+	"SENT-ETB.csv",
+	"SENT-fuel-pressure.csv",
+	"ford-sent-closed.csv",
+	"ford-sent-idle.csv",
+};
+
+void testMappedReaderMatchesStreaming() {
+	for (const char *capture : captures) {
+		std::string fileName = std::string(SENT_RECORDINGS_DIR) + capture;
+		std::vector<uint16_t> streamed;
+		std::vector<uint16_t> mapped;
+
+		IntervalReader r;
+		EXPECT_TRUE(r.open(fileName.c_str()));
+		r.readAll(sentAppendIntervals, &streamed);
+
+		MappedCsvReader m;
+		EXPECT_TRUE(m.open(fileName.c_str()));
+		m.readAll(sentAppendIntervals, &mapped);
+
+		EXPECT_TRUE(streamed.size() > 0);
+		EXPECT_EQ(streamed.size(), mapped.size());
+		EXPECT_EQ(r.lineIndex(), m.lineIndex());
+		EXPECT_TRUE(streamed == mapped);
+	}
+}
+
+static void countIntervals(const uint16_t *clocks, size_t n, void *arg) {
+	*(size_t *)arg += n;
+}
+
+void benchmarkCsvReaders() {
+	for (const char *capture : { "ford-sent-closed.csv", "ford-sent-idle.csv" }) {
+		std::string fileName = std::string(SENT_RECORDINGS_DIR) + capture;
+		double best[3] = { 1e9, 1e9, 1e9 };
+		size_t size = 0;
+		int lines = 0;
+
+		for (int pass = 0; pass < 3; pass++) {
+			/* current reader: fgets + strtok + std::stod */
+			auto start = std::chrono::steady_clock::now();
+			{
+				CsvReader r;
+				r.open(fileName.c_str());
+				while (r.haveMore()) {
+					double v;
+					r.readTimestampAndValues(&v);
+				}
+			}
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			best[0] = std::min(best[0], elapsed.count());
+
+			size_t count = 0;
+			start = std::chrono::steady_clock::now();
+			{
+				IntervalReader r;
+				r.open(fileName.c_str());
+				r.readAll(countIntervals, &count);
+			}
+			elapsed = std::chrono::steady_clock::now() - start;
+			best[1] = std::min(best[1], elapsed.count());
+
+			start = std::chrono::steady_clock::now();
+			{
+				MappedCsvReader m;
+				m.open(fileName.c_str());
+				m.readAll(countIntervals, &count);
+				size = m.size();
+				lines = m.lineIndex();
+			}
+			elapsed = std::chrono::steady_clock::now() - start;
+			best[2] = std::min(best[2], elapsed.count());
+		}
+
+		const char *names[] = { "CsvReader", "IntervalReader", "MappedCsvReader" };
+		for (int i = 0; i < 3; i++) {
+			printf("BENCH %s %s: %.1f MB/s, %.1f ns/line\r\n", names[i], capture,
+				size / best[i] / 1e6, best[i] * 1e9 / lines);
+		}
+	}
+}
@@ -0,0 +1,206 @@
+/**
+ * @file test_sent_can.cpp
+ *
+ * SENT to CAN publisher against stub CAN driver, fed by replayed recordings
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "logicdata_interval_reader.h"
+#include "sent_can.h"
+#include "sent_decoder.h"
+#include "sent_test.h"
+
+/* same as firmware decoder thread batch */
+#define CAN_TEST_BATCH	64
+/* frames kept in ring, as firmware SENT_FRAME_RING_SIZE */
+#define CAN_TEST_RING	8
+
+struct can_msg {
+	uint32_t id;
+	uint8_t data[SENT_CAN_DLC];
+};
+
+/* Stub CAN driver: transmit mailboxes are freed only when test says so */
+struct can_stub {
+	std::vector<can_msg> bus;
+	uint32_t mailboxes;
+	uint32_t pending;
+};
+
+static bool stubTx(uint32_t id, const uint8_t *data, void *arg) {
+	can_stub *can = (can_stub *)arg;
+	if (can->pending >= can->mailboxes) {
+		return false;
+	}
+	can->pending++;
+	can_msg msg;
+	msg.id = id;
+	memcpy(msg.data, data, SENT_CAN_DLC);
+	can->bus.push_back(msg);
+	return true;
+}
+
+/* frame ring of the run in progress, reader callback has no argument */
+static SentFrameRing<CAN_TEST_RING> *testFrames;
+
+static uint32_t testFrameReads;
+
+static bool readTestFrame(uint32_t n, uint32_t seq, struct sent_frame *frame) {
+	testFrameReads++;
+	return testFrames->read(seq, frame);
+}
+
+struct bridge_state {
+	struct sent_channel ch;
+	uint32_t decoded;
+	std::vector<sent_frame> frames;
+	struct sent_can_cfg cfg;
+	struct sent_can_state can;
+	can_stub stub;
+	/* publisher runs on every Nth decoder wakeup */
+	uint32_t publishEvery;
+	uint32_t batches;
+	/* mailboxes freed by bus on each wakeup */
+	uint32_t drain;
+};
+
+static void publishFrame(struct sent_channel_hot *ch, void *arg) {
+	bridge_state *s = (bridge_state *)arg;
+	struct sent_frame frame = {};
+
+	frame.syncTime = ch->frameSyncTime;
+	frame.sig0 = (ch->nibbles[1] << 8) | (ch->nibbles[2] << 4) | ch->nibbles[3];
+	frame.sig1 = ch->nibbles[4] | (ch->nibbles[5] << 4) | (ch->nibbles[6] << 8);
+	memcpy(frame.nibbles, ch->nibbles, sizeof(frame.nibbles));
+	frame.dataNibbles = ch->frameDataNibbles;
+	testFrames->push(frame);
+	s->frames.push_back(frame);
+	s->decoded++;
+}
+
+static void bridgeBatch(const uint16_t *clocks, size_t n, void *arg) {
+	bridge_state *s = (bridge_state *)arg;
+
+	for (size_t i = 0; i < n; i += CAN_TEST_BATCH) {
+		size_t cnt = std::min((size_t)CAN_TEST_BATCH, n - i);
+		SENT_DecodeBatch<SentProfileGmFuelPressure>(&s->ch, clocks + i, cnt, publishFrame, s);
+
+		s->stub.pending = (s->stub.pending > s->drain) ? s->stub.pending - s->drain : 0;
+		if ((++s->batches % s->publishEvery) == 0) {
+			SENT_CanPublish(0, &s->cfg, &s->can, testFrames->lastSeq(), CAN_TEST_RING, s->ch.edgeTime, readTestFrame, stubTx, &s->stub);
+		}
+	}
+}
+
+static void runBridge(bridge_state &s, uint32_t minPeriodUs, uint32_t publishEvery, uint32_t mailboxes, uint32_t drain) {
+	memset(&s.ch, 0, sizeof(s.ch));
+	memset(&s.can, 0, sizeof(s.can));
+	s.decoded = 0;
+	s.frames.clear();
+	s.cfg.id = SENT_CAN_BASE_ID;
+	s.cfg.minPeriod = minPeriodUs * SENT_TIMER_CLOCK_MHZ;
+	s.stub.bus.clear();
+	s.stub.mailboxes = mailboxes;
+	s.stub.pending = 0;
+	s.publishEvery = publishEvery;
+	s.batches = 0;
+	s.drain = drain;
+	SentFrameRing<CAN_TEST_RING> ring;
+	testFrames = &ring;
+
+	IntervalReader r;
+	r.open(SENT_RECORDINGS_DIR "SENT-fuel-pressure.csv");
+	r.readAll(bridgeBatch, &s);
+	/* final wakeup */
+	SENT_CanPublish(0, &s.cfg, &s.can, testFrames->lastSeq(), CAN_TEST_RING, s.ch.edgeTime, readTestFrame, stubTx, &s.stub);
+	testFrames = nullptr;
+}
+
+/* Every decoded frame goes out, in order, with its signals */
+static void testCanEveryFrame() {
+	static bridge_state s;
+	runBridge(s, 0, 1, 1000000, 0);
+
+	EXPECT_EQ(2115, s.decoded);
+	EXPECT_EQ(s.decoded, s.stub.bus.size());
+	EXPECT_EQ(s.decoded, s.can.txCnt);
+	EXPECT_EQ(0, s.can.lostCnt + s.can.txFullCnt + s.can.rateSkipCnt);
+	EXPECT_TRUE(s.can.maxQueueDepth >= 1);
+	EXPECT_TRUE(s.can.maxQueueDepth <= CAN_TEST_RING);
+
+	uint32_t mismatches = 0;
+	for (size_t i = 0; i < s.stub.bus.size(); i++) {
+		const can_msg &msg = s.stub.bus[i];
+		const sent_frame &frame = s.frames[i];
+		uint32_t sig0 = msg.data[1] | ((msg.data[2] & 0x0f) << 8);
+		uint32_t sig1 = (msg.data[2] >> 4) | (msg.data[3] << 4);
+		if ((msg.id != SENT_CAN_BASE_ID) ||
+			((msg.data[0] & 0x0f) != frame.nibbles[0]) ||
+			((msg.data[0] >> 4) != (i & 0x0f)) ||
+			(sig0 != (uint32_t)frame.sig0) || (sig1 != (uint32_t)frame.sig1)) {
+			mismatches++;
+		}
+	}
+	EXPECT_EQ(0, mismatches);
+	printf("CAN bridge: %d frames decoded, %d sent, max queue depth %d\r\n",
+		s.decoded, s.can.txCnt, s.can.maxQueueDepth);
+}
+
+/* Rate cap: gaps between sent frames are never shorter than cap */
+static void testCanRateCap() {
+	static bridge_state s;
+	const uint32_t capUs = 5000;
+	runBridge(s, capUs, 1, 1000000, 0);
+
+	EXPECT_EQ(s.decoded, s.can.txCnt + s.can.rateSkipCnt);
+	EXPECT_TRUE(s.can.txCnt > 0);
+	EXPECT_TRUE(s.can.rateSkipCnt > 0);
+	printf("CAN bridge %d uS cap: %d sent, %d skipped\r\n", capUs, s.can.txCnt, s.can.rateSkipCnt);
+}
+
+/* Slow publisher and busy bus: every frame is either sent or counted */
+static void testCanDrops() {
+	static bridge_state s;
+	runBridge(s, 0, 3, 2, 1);
+
+	EXPECT_TRUE(s.can.lostCnt > 0);
+	EXPECT_TRUE(s.can.txFullCnt > 0);
+	EXPECT_EQ(s.decoded, s.can.txCnt + s.can.lostCnt + s.can.txFullCnt);
+	EXPECT_EQ(s.can.txCnt, s.stub.bus.size());
+	printf("CAN bridge slow: %d sent, %d lost in ring, %d no mailbox, max queue depth %d\r\n",
+		s.can.txCnt, s.can.lostCnt, s.can.txFullCnt, s.can.maxQueueDepth);
+}
+
+/* Publisher far behind: lapped frames are counted at once, only ring content is read */
+static void testCanCatchUp() {
+	SentFrameRing<CAN_TEST_RING> ring;
+	struct sent_frame frame = {};
+	for (int i = 0; i < 100; i++) {
+		ring.push(frame);
+	}
+	testFrames = &ring;
+	testFrameReads = 0;
+
+	struct sent_can_cfg cfg = {};
+	struct sent_can_state state = {};
+	can_stub stub;
+	stub.mailboxes = 1000;
+	stub.pending = 0;
+	EXPECT_EQ(CAN_TEST_RING, SENT_CanPublish(0, &cfg, &state, ring.lastSeq(), CAN_TEST_RING, 0, readTestFrame, stubTx, &stub));
+	EXPECT_EQ(CAN_TEST_RING, testFrameReads);
+	EXPECT_EQ(100 - CAN_TEST_RING, state.lostCnt);
+	EXPECT_EQ(100, state.seq);
+	EXPECT_EQ(100, state.maxQueueDepth);
+	testFrames = nullptr;
+}
+
+void testSentCan() {
+	testCanEveryFrame();
+	testCanRateCap();
+	testCanDrops();
+	testCanCatchUp();
+}
@@ -0,0 +1,264 @@
+/**
+ * @file test_sent_capture.cpp
+ *
+ * Capture backends behind SentCaptureBackend: host models of ICU, PAL and DMA
+ * conversion stages replay a recording into channel set as decoder thread does
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "sent_capture.h"
+#include "sent_channel_set.h"
+#include "sent_dma_ring.h"
+#include "sent_edge_capture.h"
+#include "sent_hw_dma.h"
+#include "sent_test.h"
+#include "sent_test_helpers.h"
+
+#define CAPTURE_CHANNELS	2
+/* intervals decoder thread takes per collect(), as sent.cpp does */
+#define CAPTURE_BATCH		(SENT_DMA_BUF_SIZE / 2)
+#define CAPTURE_MIN_PULSE	(10 * SENT_TIMER_CLOCK_MHZ)
+
+/* Replays intervals of each channel through the conversion stage of given
+ * backend: ICU hands intervals over as they are, PAL turns 32 bit cycle
+ * counter timestamps into intervals, DMA 16 bit timer captures in circular
+ * buffer. Edges are all posted at once and collected in batches */
+class SentMockBackend : public SentCaptureBackend {
+public:
+	explicit SentMockBackend(sent_capture_type model) : model(model) {
+	}
+
+	const char *name() const override {
+		static const char *names[SENT_CAPTURE_NUM] = { "ICU", "PAL", "DMA" };
+		return names[model];
+	}
+
+	void load(uint8_t ch, const std::vector<uint16_t> &intervals) {
+		in[ch].intervals = intervals;
+	}
+
+	/* same inputs as firmware backends take: PA6 has no timer of its own */
+	bool start(uint8_t ch, sent_input input, uint32_t minClocks) override {
+		struct mock_channel *c = &in[ch];
+
+		if ((input >= SENT_INPUT_NUM) || ((model != SENT_CAPTURE_PAL) && (input == SENT_INPUT_PA6))) {
+			return false;
+		}
+
+		c->pos = 0;
+		c->time = 0x10000000 * ch - 0x1000;
+		SENT_EdgeCaptureInit(&c->edge, minClocks);
+		SENT_DmaRingInit(&c->ring, c->dmaBuf, SENT_DMA_BUF_SIZE);
+		c->dmaPos = 0;
+		c->dmaHalf = -1;
+
+		/* start edge of first interval */
+		edge(c);
+		return true;
+	}
+
+	size_t collect(uint8_t ch, uint16_t *out, size_t max, uint32_t *endTime) override {
+		struct mock_channel *c = &in[ch];
+		size_t cnt = 0;
+
+		switch (model) {
+		case SENT_CAPTURE_ICU:
+			while ((cnt < max) && (c->pos < c->intervals.size())) {
+				out[cnt++] = c->intervals[c->pos];
+				c->time += c->intervals[c->pos++];
+			}
+			break;
+		case SENT_CAPTURE_PAL:
+			while ((cnt < max) && (c->pos < c->intervals.size())) {
+				c->time += c->intervals[c->pos++];
+				if (edge(c)) {
+					out[cnt++] = c->clocks;
+				}
+			}
+			break;
+		case SENT_CAPTURE_DMA:
+			if (max < SENT_DMA_BUF_SIZE / 2) {
+				return 0;
+			}
+			/* DMA fills buffer until next half is done, partial half is not seen yet */
+			while ((c->dmaHalf < 0) && (c->pos < c->intervals.size())) {
+				c->time += c->intervals[c->pos++];
+				edge(c);
+			}
+			if (c->dmaHalf >= 0) {
+				cnt = SENT_DmaRingHalf(&c->ring, c->dmaHalf, SENT_DMA_BUF_SIZE - c->dmaPos, out);
+				c->dmaHalf = -1;
+			}
+			break;
+		default:
+			break;
+		}
+
+		*endTime = c->time;
+		return cnt;
+	}
+
+	void getCounters(uint8_t ch, struct sent_capture_counters *counters) override {
+		counters->glitches = in[ch].edge.glitches;
+		counters->gaps = in[ch].edge.gaps;
+		counters->overruns = in[ch].ring.overruns;
+	}
+
+private:
+	struct mock_channel {
+		std::vector<uint16_t> intervals;
+		size_t pos;
+		/* 32 bit counter at last edge */
+		uint32_t time;
+
+		struct sent_edge_capture edge;
+		uint16_t clocks;
+
+		uint16_t dmaBuf[SENT_DMA_BUF_SIZE];
+		struct sent_dma_ring ring;
+		/* next entry DMA writes, half event pending or -1 */
+		uint16_t dmaPos;
+		int dmaHalf;
+	};
+
+	/* falling edge at c->time, true if PAL stage produced interval */
+	bool edge(struct mock_channel *c) {
+		switch (model) {
+		case SENT_CAPTURE_PAL:
+			return SENT_EdgeCapture(&c->edge, c->time, &c->clocks);
+		case SENT_CAPTURE_DMA:
+			c->dmaBuf[c->dmaPos++] = (uint16_t)c->time;
+			if (c->dmaPos == SENT_DMA_BUF_SIZE / 2) {
+				c->dmaHalf = 0;
+			} else if (c->dmaPos == SENT_DMA_BUF_SIZE) {
+				c->dmaPos = 0;
+				c->dmaHalf = 1;
+			}
+			return false;
+		default:
+			return false;
+		}
+	}
+
+	sent_capture_type model;
+	struct mock_channel in[CAPTURE_CHANNELS];
+};
+
+static void countFrame(struct sent_channel_hot *, void *arg) {
+	(*(uint32_t *)arg)++;
+}
+
+/* Decoder thread loop over collect() of each channel, intervals seen are kept in got */
+static uint64_t decodeCaptured(SentCaptureBackend *capture, SentChannelSet<CAPTURE_CHANNELS> &set,
+		uint32_t *frames, std::vector<uint16_t> *got) {
+	uint16_t batch[CAPTURE_BATCH];
+	uint64_t pulses = 0;
+	bool more = true;
+
+	while (more) {
+		more = false;
+		for (uint32_t n = 0; n < CAPTURE_CHANNELS; n++) {
+			uint32_t endTime;
+			size_t cnt = capture->collect(n, batch, CAPTURE_BATCH, &endTime);
+			if (cnt == 0) {
+				continue;
+			}
+			set.setEdgeTime(n, batch, cnt, endTime);
+			set.decode(n, SENT_DecodeBatch<SentProfileGmFuelPressure>, batch, cnt, countFrame, &frames[n]);
+			if (got) {
+				got[n].insert(got[n].end(), batch, batch + cnt);
+			}
+			pulses += cnt;
+			more = true;
+		}
+	}
+
+	return pulses;
+}
+
+/* Every backend model gives decoder the recording it was fed, channels do not mix */
+static void testCaptureBackends() {
+	std::vector<uint16_t> rec = sentLoadRecording(SENT_RECORDINGS_DIR "SENT-fuel-pressure.csv");
+	std::vector<uint16_t> src[CAPTURE_CHANNELS] = {
+		rec,
+		/* second channel starts in the middle of frame */
+		std::vector<uint16_t>(rec.begin() + 1237, rec.end()),
+	};
+	uint32_t expected[CAPTURE_CHANNELS];
+
+	for (uint32_t n = 0; n < CAPTURE_CHANNELS; n++) {
+		struct sent_channel ch = {};
+		expected[n] = 0;
+		SENT_DecodeBatch<SentProfileGmFuelPressure>(&ch, &ch, src[n].data(), src[n].size(), countFrame, &expected[n]);
+	}
+	EXPECT_TRUE(expected[0] > 2000);
+
+	for (int model = 0; model < SENT_CAPTURE_NUM; model++) {
+		SentMockBackend capture((sent_capture_type)model);
+		static SentChannelSet<CAPTURE_CHANNELS> set;
+		uint32_t frames[CAPTURE_CHANNELS] = {};
+		std::vector<uint16_t> got[CAPTURE_CHANNELS];
+
+		EXPECT_EQ(model == SENT_CAPTURE_PAL, capture.start(0, SENT_INPUT_PA6, CAPTURE_MIN_PULSE));
+		EXPECT_TRUE(!capture.start(0, SENT_INPUT_NUM, CAPTURE_MIN_PULSE));
+
+		set.reset();
+		for (uint32_t n = 0; n < CAPTURE_CHANNELS; n++) {
+			capture.load(n, src[n]);
+			EXPECT_TRUE(capture.start(n, (sent_input)(SENT_INPUT_PA7 + n), CAPTURE_MIN_PULSE));
+		}
+		decodeCaptured(&capture, set, frames, got);
+
+		for (uint32_t n = 0; n < CAPTURE_CHANNELS; n++) {
+			struct sent_capture_counters counters;
+			capture.getCounters(n, &counters);
+
+			/* DMA does not hand over last partial half, start edge takes one capture */
+			size_t lost = (model == SENT_CAPTURE_DMA) ? (src[n].size() + 1) % (SENT_DMA_BUF_SIZE / 2) : 0;
+			EXPECT_EQ(src[n].size() - lost, got[n].size());
+			EXPECT_TRUE(std::equal(got[n].begin(), got[n].end(), src[n].begin()));
+			EXPECT_TRUE((frames[n] <= expected[n]) && (frames[n] + 1 >= expected[n]));
+			if (model != SENT_CAPTURE_DMA) {
+				EXPECT_EQ(expected[n], frames[n]);
+			}
+			EXPECT_EQ(0, counters.glitches);
+			EXPECT_EQ(0, counters.gaps);
+			EXPECT_EQ(0, counters.overruns);
+		}
+	}
+}
+
+void testSentCapture() {
+	testCaptureBackends();
+}
+
+/* Conversion stage cost of each backend on top of decode */
+void benchmarkSentCapture() {
+	std::vector<uint16_t> rec = sentLoadRecording(SENT_RECORDINGS_DIR "SENT-fuel-pressure.csv");
+	static SentChannelSet<CAPTURE_CHANNELS> set;
+
+	for (int model = 0; model < SENT_CAPTURE_NUM; model++) {
+		SentMockBackend capture((sent_capture_type)model);
+		uint64_t pulses = 0;
+		uint32_t frames[CAPTURE_CHANNELS] = {};
+		auto start = std::chrono::steady_clock::now();
+		std::chrono::duration<double> elapsed;
+
+		for (uint32_t n = 0; n < CAPTURE_CHANNELS; n++) {
+			capture.load(n, rec);
+		}
+		do {
+			set.reset();
+			for (uint32_t n = 0; n < CAPTURE_CHANNELS; n++) {
+				capture.start(n, (sent_input)(SENT_INPUT_PA7 + n), CAPTURE_MIN_PULSE);
+			}
+			pulses += decodeCaptured(&capture, set, frames, nullptr);
+			elapsed = std::chrono::steady_clock::now() - start;
+		} while (elapsed.count() < 0.2);
+
+		printf("BENCH capture %s: %.1f ns/interval\r\n", capture.name(), elapsed.count() * 1e9 / pulses);
+	}
+}
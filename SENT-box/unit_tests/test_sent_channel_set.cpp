@@ -0,0 +1,146 @@
+/**
+ * @file test_sent_channel_set.cpp
+ *
+ * Multi-channel decoder state: interleaved captures decode same as separate channels
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include "sent_channel_set.h"
+#include "sent_test.h"
+#include "sent_test_helpers.h"
+
+#define SET_CHANNELS	8
+/* intervals per channel taken by decoder thread on one wakeup */
+#define SET_BATCH		16
+
+struct set_input {
+	sent_split_decoder decode;
+	std::vector<uint16_t> intervals;
+};
+
+/* Even channels see fuel pressure sensor, odd ones Ford sensor, each one starts at other place of capture */
+static void loadInputs(set_input *inputs, size_t n) {
+	std::vector<uint16_t> fuel = sentLoadRecording(SENT_RECORDINGS_DIR "SENT-fuel-pressure.csv");
+	std::vector<uint16_t> ford = sentLoadRecording(SENT_RECORDINGS_DIR "ford-sent-closed.csv");
+
+	for (size_t i = 0; i < n; i++) {
+		const std::vector<uint16_t> &src = (i & 1) ? ford : fuel;
+		size_t offset = (i * 1237) % src.size();
+
+		if (i & 1) {
+			inputs[i].decode = SENT_DecodeBatch<SentProfileFord>;
+		} else {
+			inputs[i].decode = SENT_DecodeBatch<SentProfileGmFuelPressure>;
+		}
+		inputs[i].intervals.assign(src.begin() + offset, src.end());
+		inputs[i].intervals.insert(inputs[i].intervals.end(), src.begin(), src.begin() + offset);
+	}
+}
+
+static void countFrame(struct sent_channel_hot *, void *arg) {
+	(*(uint32_t *)arg)++;
+}
+
+/* Round robin over channels, SET_BATCH intervals of each at a time, as decoder thread does */
+template <size_t N>
+static uint64_t decodeInterleaved(SentChannelSet<N> &set, const set_input *inputs, size_t channels, uint32_t *frames) {
+	uint64_t pulses = 0;
+	bool more = true;
+
+	for (size_t pos = 0; more; pos += SET_BATCH) {
+		more = false;
+		for (uint32_t n = 0; n < channels; n++) {
+			const std::vector<uint16_t> &v = inputs[n].intervals;
+			if (pos >= v.size()) {
+				continue;
+			}
+			size_t cnt = std::min((size_t)SET_BATCH, v.size() - pos);
+			set.decode(n, inputs[n].decode, v.data() + pos, cnt, countFrame, &frames[n]);
+			pulses += cnt;
+			more = true;
+		}
+	}
+
+	return pulses;
+}
+
+/* Every channel of set ends up with same state as channel decoded alone */
+static void testInterleavedMatchesSingle() {
+	static set_input inputs[SET_CHANNELS];
+	static SentChannelSet<SET_CHANNELS> set;
+	uint32_t frames[SET_CHANNELS] = {};
+
+	loadInputs(inputs, SET_CHANNELS);
+	decodeInterleaved(set, inputs, SET_CHANNELS, frames);
+
+	for (uint32_t n = 0; n < SET_CHANNELS; n++) {
+		struct sent_channel ch;
+		uint32_t singleFrames = 0;
+
+		memset(&ch, 0, sizeof(ch));
+		inputs[n].decode(&ch, &ch, inputs[n].intervals.data(), inputs[n].intervals.size(), countFrame, &singleFrames);
+
+		struct sent_channel_stats stats;
+		memset(&stats, 0xff, sizeof(stats));
+		set.getStats(n, &stats);
+
+		EXPECT_EQ(singleFrames, frames[n]);
+		EXPECT_EQ(inputs[n].intervals.size(), stats.pulseCnt);
+		EXPECT_EQ(ch.FrameCnt, stats.frameCnt);
+		EXPECT_EQ(ch.CrcErrCnt, stats.crcErr);
+		EXPECT_EQ(ch.SyncErr, stats.syncErr);
+		EXPECT_EQ(ch.ShortIntervalErr, stats.shortIntervalErr);
+		EXPECT_EQ(ch.LongIntervalErr, stats.longIntervalErr);
+		EXPECT_EQ(ch.ScCrcErrCnt, stats.slowCrcErr);
+		EXPECT_EQ(ch.ScEvictCnt, stats.slowEvict);
+		EXPECT_EQ(ch.LostFrameCnt, stats.lostFrames);
+		EXPECT_EQ(ch.tickClocks * 1000 / SENT_TIMER_CLOCK_MHZ, stats.tickNs);
+		/* left for capture side to fill */
+		EXPECT_EQ(0xffffffff, stats.intervalOverflow);
+		/* captures have no CRC errors, only frame cut where rotated capture wraps can fail */
+		EXPECT_TRUE(stats.crcErr <= 1);
+		EXPECT_TRUE(stats.frameCnt > 1000);
+
+		EXPECT_EQ(ch.scMsgFlags, set.cold(n)->scMsgFlags);
+		EXPECT_EQ(0, memcmp(ch.scMsg, set.cold(n)->scMsg, sizeof(ch.scMsg)));
+		EXPECT_EQ(0, memcmp(ch.nibbles, set.hot(n)->nibbles, sizeof(ch.nibbles)));
+	}
+
+	set.reset();
+	struct sent_channel_stats stats;
+	set.getStats(SET_CHANNELS - 1, &stats);
+	EXPECT_EQ(0, stats.pulseCnt);
+	EXPECT_EQ(0, stats.frameCnt);
+}
+
+void testSentChannelSet() {
+	testInterleavedMatchesSingle();
+}
+
+/* Per pulse cost should stay flat as channels are added */
+void benchmarkSentChannelSet() {
+	static set_input inputs[SET_CHANNELS];
+	static SentChannelSet<SET_CHANNELS> set;
+
+	loadInputs(inputs, SET_CHANNELS);
+	printf("BENCH channel set: hot state %d bytes, cold state %d bytes per channel\r\n",
+		(int)sizeof(struct sent_channel_hot), (int)sizeof(struct sent_channel_cold));
+
+	for (size_t channels = 1; channels <= SET_CHANNELS; channels *= 2) {
+		uint64_t pulses = 0;
+		uint32_t frames[SET_CHANNELS] = {};
+		auto start = std::chrono::steady_clock::now();
+		std::chrono::duration<double> elapsed;
+		do {
+			set.reset();
+			pulses += decodeInterleaved(set, inputs, channels, frames);
+			elapsed = std::chrono::steady_clock::now() - start;
+		} while (elapsed.count() < 0.2);
+
+		printf("BENCH channel set %d channels: %.1f ns/pulse\r\n", (int)channels, elapsed.count() * 1e9 / pulses);
+	}
+}
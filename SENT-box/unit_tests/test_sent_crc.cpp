@@ -0,0 +1,151 @@
+/**
+ * @file test_sent_crc.cpp
+ *
+ * CRC4 lookup engine against nibble by nibble routines it replaced
+ */
+
+#include <chrono>
+#include <vector>
+
+#include "sent_crc.h"
+#include "sent_test.h"
+
+#define CRC_MAX_EXHAUSTIVE	6
+
+static const uint8_t refLookup[16] = {0, 13, 7, 10, 14, 3, 9, 4, 1, 12, 6, 11, 15, 2, 8, 5};
+
+/* Former sent_crc4() */
+static uint8_t refCrc4(const uint8_t *pdata, uint16_t ndata) {
+	uint8_t crc = SENT_CRC_SEED;
+
+	for (size_t i = 0; i < ndata; i++) {
+		crc = crc ^ pdata[i];
+		crc = refLookup[crc];
+	}
+	return crc;
+}
+
+/* Former sent_crc4_gm() */
+static uint8_t refCrc4Gm(const uint8_t *pdata, uint16_t ndata) {
+	uint8_t crc = SENT_CRC_SEED;
+
+	for (size_t i = 0; i < ndata; i++) {
+		crc = refLookup[crc];
+		crc = (crc ^ pdata[i]) & 0x0f;
+	}
+	return refLookup[crc];
+}
+
+void testSentCrc() {
+	for (int i = 0; i < 16; i++) {
+		EXPECT_EQ(refLookup[i], SENT_Crc4Tables.nibble[i]);
+	}
+
+	/* pair step is two single steps, from every state */
+	int pairErrors = 0;
+	for (int crc = 0; crc < 16; crc++) {
+		for (int a = 0; a < 16; a++) {
+			for (int b = 0; b < 16; b++) {
+				if (SENT_Crc4Update2(crc, a, b) != SENT_Crc4Update(SENT_Crc4Update(crc, a), b)) {
+					pairErrors++;
+				}
+			}
+		}
+	}
+	EXPECT_EQ(0, pairErrors);
+
+	/* every message of up to 6 nibbles, odd and even lengths */
+	for (int n = 0; n <= CRC_MAX_EXHAUSTIVE; n++) {
+		uint8_t nibbles[CRC_MAX_EXHAUSTIVE];
+		int legacyErrors = 0;
+		int recommendedErrors = 0;
+
+		for (uint32_t v = 0; v < (1u << (4 * n)); v++) {
+			for (int i = 0; i < n; i++) {
+				nibbles[i] = (v >> (4 * i)) & 0x0f;
+			}
+			if (sent_crc4(nibbles, n) != refCrc4(nibbles, n)) {
+				legacyErrors++;
+			}
+			if (sent_crc4_gm(nibbles, n) != refCrc4Gm(nibbles, n)) {
+				recommendedErrors++;
+			}
+		}
+		EXPECT_EQ(0, legacyErrors);
+		EXPECT_EQ(0, recommendedErrors);
+	}
+
+	/* known frames: GM fuel pressure (recommended), Si7215 style (legacy) */
+	const uint8_t gm[6] = { 0x0, 0x8, 0x7, 0x8, 0x0, 0xf };
+	EXPECT_EQ(refCrc4Gm(gm, 6), sent_crc4_gm(gm, 6));
+	const uint8_t legacy[7] = { 0x3, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6 };
+	EXPECT_EQ(refCrc4(legacy, 7), sent_crc4(legacy, 7));
+
+	/* unaugmented is recommended without last round: every 3 nibble message,
+	 * known frames of GM throttle body */
+	int unaugmentedErrors = 0;
+	for (uint32_t v = 0; v < 0x1000; v++) {
+		const uint8_t msg[3] = { (uint8_t)(v >> 8), (uint8_t)((v >> 4) & 0x0f), (uint8_t)(v & 0x0f) };
+		if (SENT_Crc4Tables.nibble[sent_crc4_unaugmented(msg, 3)] != sent_crc4_gm(msg, 3)) {
+			unaugmentedErrors++;
+		}
+	}
+	EXPECT_EQ(0, unaugmentedErrors);
+	const uint8_t etb[3][7] = {
+		{ 0xa, 0xe, 0x9, 0x6, 0x1, 0x5, 0x9 },
+		{ 0xa, 0xe, 0x8, 0x7, 0x1, 0x5, 0xc },
+		{ 0xa, 0xe, 0xa, 0x5, 0x1, 0x5, 0x6 },
+	};
+	for (const uint8_t *f : etb) {
+		EXPECT_EQ(f[6], sent_crc4_unaugmented(f, 6));
+	}
+
+	/* incremental nibble by nibble equals whole message */
+	uint8_t crc = SENT_CRC4_SEED_LEGACY;
+	for (uint8_t n : legacy) {
+		crc = SENT_Crc4Update(crc, n);
+	}
+	EXPECT_EQ(sent_crc4(legacy, 7), crc);
+}
+
+void benchmarkSentCrc() {
+	/* frames of status and 6 data nibbles, checked as decoder does for SENT_CRC_ANY */
+	std::vector<uint8_t> frames(7 * 4096);
+	uint32_t x = 1;
+	for (auto &n : frames) {
+		x = x * 1103515245 + 12345;
+		n = (x >> 16) & 0x0f;
+	}
+	size_t count = frames.size() / 7;
+
+	uint32_t sumRef = 0;
+	uint64_t done = 0;
+	auto start = std::chrono::steady_clock::now();
+	std::chrono::duration<double> elapsedRef;
+	do {
+		for (size_t i = 0; i < count; i++) {
+			const uint8_t *f = &frames[i * 7];
+			sumRef += refCrc4(f, 7) + refCrc4Gm(f + 1, 6);
+		}
+		done += count;
+		elapsedRef = std::chrono::steady_clock::now() - start;
+	} while (elapsedRef.count() < 0.1);
+	double nsRef = elapsedRef.count() * 1e9 / done;
+
+	uint32_t sumTable = 0;
+	done = 0;
+	start = std::chrono::steady_clock::now();
+	std::chrono::duration<double> elapsedTable;
+	do {
+		for (size_t i = 0; i < count; i++) {
+			const uint8_t *f = &frames[i * 7];
+			sumTable += sent_crc4(f, 7) + sent_crc4_gm(f + 1, 6);
+		}
+		done += count;
+		elapsedTable = std::chrono::steady_clock::now() - start;
+	} while (elapsedTable.count() < 0.1);
+	double nsTable = elapsedTable.count() * 1e9 / done;
+
+	printf("BENCH CRC4 both variants: nibble table %.2f ns/frame, pair table %.2f ns/frame (%u)\r\n",
+		nsRef, nsTable, sumRef ^ sumTable);
+}
@@ -0,0 +1,349 @@
+/**
+ * @file test_sent_decoder.cpp
+ *
+ * Decoder state machine on synthetic pulse trains: pause pulses, variable frame length, resync
+ */
+
+#include <cstring>
+#include <vector>
+
+#include "sent_decoder.h"
+#include "sent_test.h"
+#include "sent_test_helpers.h"
+
+/* 3 uS at 72 MHz */
+#define TEST_TICK 216
+
+template <class Profile>
+static uint32_t decodeAll(struct sent_channel *ch, const std::vector<uint16_t> &pulses) {
+	uint32_t frames = 0;
+
+	memset(ch, 0, sizeof(*ch));
+	for (uint16_t clocks : pulses) {
+		if (SENT_Decoder<Profile>(ch, clocks) > 0) {
+			frames++;
+		}
+	}
+	return frames;
+}
+
+/* Pause length varies from frame to frame, some are inside sync window and look like sync */
+static void testPauseInsideSyncWindow() {
+	const uint32_t pauses[] = { 0, 50, 64, 100, 200 };
+	const uint8_t data[6] = { 1, 2, 3, 4, 5, 6 };
+	std::vector<uint16_t> pulses;
+
+	for (int i = 0; i < 100; i++) {
+		sentAppendFrame(pulses, TEST_TICK, 0, data, 6, pauses[i % 5] * TEST_TICK);
+	}
+
+	struct sent_channel ch;
+	EXPECT_EQ(100, decodeAll<SentProfileFord>(&ch, pulses));
+	EXPECT_EQ(0, ch.SyncErr);
+	EXPECT_EQ(0, ch.LongIntervalErr);
+	EXPECT_EQ(0, ch.ShortIntervalErr);
+	EXPECT_EQ(6, ch.frameDataNibbles);
+
+	/* no pause in profile: pauses outside sync window are errors, but no frame is lost */
+	EXPECT_EQ(100, decodeAll<SentProfileDefault>(&ch, pulses));
+	EXPECT_EQ(0, ch.CrcErrCnt);
+}
+
+/* Frame length is found from position of next sync or pause */
+static void testVariableLength() {
+	const uint8_t data[6] = { 15, 0, 7, 8, 9, 10 };
+
+	for (uint8_t n = 1; n <= 6; n++) {
+		std::vector<uint16_t> pulses;
+		for (int i = 0; i < 20; i++) {
+			sentAppendFrame(pulses, TEST_TICK, 4, data, n, ((i & 1) ? 77 : 0) * TEST_TICK);
+		}
+		/* last frame is done on next sync */
+		pulses.push_back(56 * TEST_TICK);
+
+		struct sent_channel ch;
+		EXPECT_EQ(20, decodeAll<SentProfileVariableLength>(&ch, pulses));
+		EXPECT_EQ(0, ch.CrcErrCnt);
+		EXPECT_EQ(n, ch.frameDataNibbles);
+		EXPECT_EQ(4, ch.nibbles[0]);
+	}
+}
+
+/* Sync in the middle of a frame restarts frame right away, next frame is not lost */
+static void testResyncMidFrame() {
+	const uint8_t data[6] = { 3, 3, 3, 4, 4, 4 };
+	std::vector<uint16_t> pulses;
+
+	sentAppendFrame(pulses, TEST_TICK, 0, data, 6);
+	/* truncated frame: sync, status and two nibbles */
+	pulses.push_back(56 * TEST_TICK);
+	pulses.push_back(12 * TEST_TICK);
+	pulses.push_back(15 * TEST_TICK);
+	pulses.push_back(15 * TEST_TICK);
+	sentAppendFrame(pulses, TEST_TICK, 0, data, 6);
+
+	struct sent_channel ch;
+	EXPECT_EQ(2, decodeAll<SentProfileGmFuelPressure>(&ch, pulses));
+	EXPECT_EQ(1, ch.LongIntervalErr);
+	EXPECT_EQ(0, ch.SyncErr);
+}
+
+/* Sync time of each frame follows real time anchored per batch */
+static void testSyncTimestamp() {
+	const uint8_t data[6] = { 1, 2, 3, 4, 5, 6 };
+	std::vector<uint16_t> pulses;
+
+	for (int i = 0; i < 10; i++) {
+		sentAppendFrame(pulses, TEST_TICK, 0, data, 6);
+	}
+	/* sync, status, 6 data nibbles and CRC */
+	uint32_t frameClocks = 0;
+	for (size_t i = 0; i < 9; i++) {
+		frameClocks += pulses[i];
+	}
+
+	struct sent_channel ch;
+	memset(&ch, 0, sizeof(ch));
+	/* last edge of the first batch is seen at time 0xfffff000, so time wraps in between */
+	const uint32_t endTime = 0xfffff000;
+	const size_t firstBatch = 13;
+	std::vector<uint32_t> syncTimes;
+
+	SENT_SetEdgeTime(&ch, pulses.data(), firstBatch, endTime);
+	for (size_t i = 0; i < pulses.size(); i++) {
+		if (SENT_Decoder<SentProfileGmFuelPressure>(&ch, pulses[i]) > 0) {
+			syncTimes.push_back(ch.frameSyncTime);
+		}
+	}
+	EXPECT_EQ(10, syncTimes.size());
+
+	/* first sync ends 56 ticks after first edge */
+	uint32_t firstEdge = endTime;
+	for (size_t i = 0; i < firstBatch; i++) {
+		firstEdge -= pulses[i];
+	}
+	for (size_t i = 0; i < syncTimes.size(); i++) {
+		EXPECT_EQ((uint32_t)(firstEdge + 56 * TEST_TICK + i * frameClocks), syncTimes[i]);
+	}
+}
+
+struct incremental_check {
+	sent_signal_layout layout;
+	uint32_t frames;
+	uint32_t mismatches;
+};
+
+/* Signals assembled nibble by nibble against ones unpacked from complete frame */
+static void checkSignals(struct sent_channel_hot *ch, void *arg) {
+	incremental_check *check = (incremental_check *)arg;
+	const uint8_t *d = ch->nibbles + 1;
+	int32_t sig0 = 0, sig1 = 0;
+
+	if (check->layout == SENT_LAYOUT_DUAL12) {
+		SENT_UnpackDual12(d, &sig0, &sig1);
+	} else if (check->layout == SENT_LAYOUT_SI7215) {
+		sig0 = (d[0] << 8) | (d[1] << 4) | d[2];
+		sig1 = (d[3] << 4) | d[4];
+	}
+	if ((sig0 != ch->sig0) || (sig1 != ch->sig1)) {
+		check->mismatches++;
+	}
+	check->frames++;
+}
+
+/* CRC and signals folded in as nibbles arrive: every CRC variant and layout,
+ * frames with bad CRC in between */
+template <class Profile>
+static void testIncrementalFrame(sent_crc_type crc) {
+	std::vector<uint16_t> pulses;
+	uint32_t rnd = 7;
+	uint32_t good = 0;
+	const uint32_t tick = Profile::tickClocks;
+
+	for (int i = 0; i < 500; i++) {
+		uint8_t nibbles[1 + SENT_MSG_DATA_SIZE];
+		for (auto &n : nibbles) {
+			rnd = rnd * 1103515245 + 12345;
+			n = (rnd >> 16) & 0x0f;
+		}
+		if (Profile::layout == SENT_LAYOUT_SI7215) {
+			nibbles[6] = ~nibbles[1] & 0x0f;
+		}
+		/* SENT_CRC_ANY: both variants, alternating */
+		bool legacy = (crc == SENT_CRC_LEGACY) || ((crc == SENT_CRC_ANY) && (i & 1));
+		uint8_t c = legacy ? sent_crc4(nibbles, 7) :
+			(crc == SENT_CRC_UNAUGMENTED) ? sent_crc4_unaugmented(nibbles + 1, 6) : sent_crc4_gm(nibbles + 1, 6);
+		bool bad = (i % 7) == 3;
+		if (bad) {
+			/* wrong for every variant */
+			while ((c == sent_crc4(nibbles, 7)) || (c == sent_crc4_gm(nibbles + 1, 6)) ||
+				(c == sent_crc4_unaugmented(nibbles + 1, 6))) {
+				c = (c + 1) & 0x0f;
+			}
+		} else {
+			good++;
+		}
+
+		pulses.push_back(56 * tick);
+		for (uint8_t n : nibbles) {
+			pulses.push_back((SENT_OFFSET_INTERVAL + n) * tick);
+		}
+		pulses.push_back((SENT_OFFSET_INTERVAL + c) * tick);
+	}
+
+	struct sent_channel ch;
+	memset(&ch, 0, sizeof(ch));
+	incremental_check check = { Profile::layout, 0, 0 };
+	EXPECT_EQ(good, SENT_DecodeBatch<Profile>(&ch, pulses.data(), pulses.size(), checkSignals, &check));
+	EXPECT_EQ(good, check.frames);
+	EXPECT_EQ(0, check.mismatches);
+	EXPECT_EQ(500 - good, ch.CrcErrCnt);
+}
+
+/* Si7215 frame: field, rolling counter, inverted first nibble, legacy CRC.
+ * badInverse: CRC is good, but inverted nibble does not match */
+static void appendSi7215Frame(std::vector<uint16_t> &pulses, uint16_t field, uint8_t counter, bool badCrc,
+		bool badInverse = false) {
+	const uint32_t tick = SentProfileSi7215::tickClocks;
+	uint8_t nibbles[1 + SENT_MSG_DATA_SIZE] = {
+		0,
+		(uint8_t)((field >> 8) & 0x0f), (uint8_t)((field >> 4) & 0x0f), (uint8_t)(field & 0x0f),
+		(uint8_t)(counter >> 4), (uint8_t)(counter & 0x0f), (uint8_t)(~(field >> 8) & 0x0f),
+	};
+	if (badInverse) {
+		nibbles[6] ^= 1;
+	}
+	uint8_t crc = sent_crc4(nibbles, 7);
+
+	pulses.push_back(56 * tick);
+	for (uint8_t n : nibbles) {
+		pulses.push_back((SENT_OFFSET_INTERVAL + n) * tick);
+	}
+	pulses.push_back((SENT_OFFSET_INTERVAL + (badCrc ? crc ^ 1 : crc)) * tick);
+}
+
+/* Frames missing from rolling counter sequence: dropped, bad CRC, bad inverted nibble, cut by lost sync,
+ * counter wrap */
+static void testRollingCounter() {
+	std::vector<uint16_t> pulses;
+	uint8_t counter = 250;
+
+	for (int i = 0; i < 20; i++, counter++) {
+		if ((i == 3) || (i == 4)) {
+			/* lost in capture */
+			continue;
+		}
+		if (i == 8) {
+			/* cut in the middle: decoder has to resync on next frame */
+			appendSi7215Frame(pulses, 0x123, counter, false);
+			pulses.resize(pulses.size() - 4);
+			continue;
+		}
+		appendSi7215Frame(pulses, 0x800 + i, counter, i == 12, i == 15);
+	}
+
+	struct sent_channel ch;
+	EXPECT_EQ(15, decodeAll<SentProfileSi7215>(&ch, pulses));
+	EXPECT_EQ(5, ch.LostFrameCnt);
+	EXPECT_EQ(2, ch.CrcErrCnt);
+	EXPECT_EQ((uint8_t)(250 + 19), ch.counter);
+
+	EXPECT_EQ(15, decodeAll<SentProfileTracked<SentProfileSi7215>>(&ch, pulses));
+	EXPECT_EQ(5, ch.LostFrameCnt);
+
+	/* sensors without counter */
+	EXPECT_EQ(0, SentProfileGmFuelPressure::counterBits);
+	EXPECT_EQ(0, SentProfileVariableLength::counterBits);
+}
+
+/* Edges of frames with given tick, each edge moved by random jitter up to +/-jitter ticks */
+struct jitter_gen {
+	uint32_t rnd;
+	double time;
+	double lastEdge;
+
+	uint32_t next() {
+		rnd = rnd * 1103515245 + 12345;
+		return rnd >> 8;
+	}
+
+	void edge(std::vector<uint16_t> &pulses, double ticks, double tickClocks, double jitter) {
+		time += ticks * tickClocks;
+		double e = time + ((next() % 2001) / 1000.0 - 1.0) * jitter * tickClocks;
+		pulses.push_back((uint16_t)(e - lastEdge + 0.5));
+		lastEdge = e;
+	}
+
+	void frame(std::vector<uint16_t> &pulses, double tickClocks, double jitter) {
+		uint8_t data[6];
+
+		for (int i = 0; i < 6; i++) {
+			data[i] = next() & 0x0f;
+		}
+		edge(pulses, 56, tickClocks, jitter);
+		edge(pulses, SENT_OFFSET_INTERVAL + 0, tickClocks, jitter);
+		for (int i = 0; i < 6; i++) {
+			edge(pulses, SENT_OFFSET_INTERVAL + data[i], tickClocks, jitter);
+		}
+		edge(pulses, SENT_OFFSET_INTERVAL + sent_crc4_gm(data, 6), tickClocks, jitter);
+	}
+};
+
+template <class Profile>
+static uint32_t crcErrors(const std::vector<uint16_t> &pulses) {
+	struct sent_channel ch;
+	decodeAll<Profile>(&ch, pulses);
+	return ch.CrcErrCnt;
+}
+
+/* Edge jitter and slowly drifting sensor clock: single sync pulse gives tick
+ * good enough for short nibbles only, tracked tick decodes nearly everything */
+static void testTickTracking() {
+	std::vector<uint16_t> pulses;
+	jitter_gen gen = { 1, 0, 0 };
+	const int frames = 4000;
+
+	for (int i = 0; i < frames; i++) {
+		/* +/-5% triangle drift around nominal tick */
+		double drift = ((i % 2000) < 1000 ? (i % 1000) : 1000 - (i % 1000)) / 10000.0 - 0.05;
+		gen.frame(pulses, TEST_TICK * (1 + drift), 0.25);
+	}
+
+	uint32_t plain = crcErrors<SentProfileGmFuelPressure>(pulses);
+	uint32_t tracked = crcErrors<SentProfileTracked<SentProfileGmFuelPressure>>(pulses);
+	printf("tick tracking, jitter 0.25 tick: CRC errors %d of %d frames, tracked %d\r\n", plain, frames, tracked);
+	EXPECT_TRUE(plain > frames / 20);
+	EXPECT_TRUE(tracked * 10 < plain);
+
+	/* no jitter: tracking should not make anything worse */
+	pulses.clear();
+	for (int i = 0; i < 1000; i++) {
+		gen.frame(pulses, TEST_TICK * (1 + (i % 100) / 1000.0), 0);
+	}
+	EXPECT_EQ(0, crcErrors<SentProfileGmFuelPressure>(pulses));
+	EXPECT_EQ(0, crcErrors<SentProfileTracked<SentProfileGmFuelPressure>>(pulses));
+
+	/* tick drops by 10%: track is restarted from sync, at most frame with the jump is lost */
+	pulses.clear();
+	for (int i = 0; i < 200; i++) {
+		gen.frame(pulses, TEST_TICK * ((i < 100) ? 1.0 : 0.9), 0.1);
+	}
+	struct sent_channel ch;
+	EXPECT_TRUE(decodeAll<SentProfileTracked<SentProfileGmFuelPressure>>(&ch, pulses) >= 198);
+	EXPECT_TRUE(ch.tickFilt > (uint32_t)(TEST_TICK * 0.89 * (1 << SENT_TICK_FRAC_BITS)));
+	EXPECT_TRUE(ch.tickFilt < (uint32_t)(TEST_TICK * 0.91 * (1 << SENT_TICK_FRAC_BITS)));
+}
+
+void testSentDecoder() {
+	testPauseInsideSyncWindow();
+	testVariableLength();
+	testResyncMidFrame();
+	testSyncTimestamp();
+	testIncrementalFrame<SentProfileSi7215>(SENT_CRC_LEGACY);
+	testIncrementalFrame<SentProfileGmFuelPressure>(SENT_CRC_RECOMMENDED);
+	testIncrementalFrame<SentProfileGmEtb>(SENT_CRC_UNAUGMENTED);
+	testIncrementalFrame<SentProfileDefault>(SENT_CRC_ANY);
+	testIncrementalFrame<SentProfileTracked<SentProfileSi7215>>(SENT_CRC_LEGACY);
+	testTickTracking();
+	testRollingCounter();
+}
@@ -0,0 +1,121 @@
+/**
+ * @file test_sent_dma_ring.cpp
+ *
+ * Host model of timer capture + circular DMA feeding sent_dma_ring
+ */
+
+#include <cstdlib>
+#include <vector>
+
+#include "sent_dma_ring.h"
+#include "sent_test.h"
+
+#define DMA_MODEL_SIZE 16
+
+/* Timer captures edges into a circular buffer like DMA in circular mode,
+ * raises half/full transfer events into a pending list */
+class DmaCaptureModel {
+public:
+	uint16_t buf[DMA_MODEL_SIZE];
+	/* next entry DMA writes, NDTR = size - pos */
+	uint16_t pos = 0;
+	std::vector<uint8_t> events;
+
+	void capture(uint32_t counter) {
+		buf[pos] = (uint16_t)counter;
+		pos++;
+		if (pos == DMA_MODEL_SIZE / 2) {
+			events.push_back(0);
+		}
+		if (pos == DMA_MODEL_SIZE) {
+			pos = 0;
+			events.push_back(1);
+		}
+	}
+
+	uint16_t remaining() const {
+		return DMA_MODEL_SIZE - pos;
+	}
+};
+
+/* Consumer keeps up: every interval comes out unchanged, across halves and counter wrap */
+static void testDmaRingInOrder() {
+	DmaCaptureModel dma;
+	struct sent_dma_ring ring;
+	SENT_DmaRingInit(&ring, dma.buf, DMA_MODEL_SIZE);
+
+	std::vector<uint16_t> sent;
+	std::vector<uint16_t> received;
+	uint32_t counter = 0xff00;	/* wraps 16 bit timer early on */
+	srand(1);
+
+	dma.capture(counter);
+	for (int i = 0; i < 1000; i++) {
+		uint16_t interval = 700 + rand() % 60000;
+		counter += interval;
+		sent.push_back(interval);
+		dma.capture(counter);
+
+		for (uint8_t half : dma.events) {
+			uint16_t out[DMA_MODEL_SIZE / 2];
+			size_t n = SENT_DmaRingHalf(&ring, half, dma.remaining(), out);
+			received.insert(received.end(), out, out + n);
+		}
+		dma.events.clear();
+	}
+
+	EXPECT_EQ(0, ring.overruns);
+	/* whatever is still in the not yet completed half is not received */
+	EXPECT_EQ(sent.size() - sent.size() % (DMA_MODEL_SIZE / 2), received.size() + 1);
+	bool same = true;
+	for (size_t i = 0; i < received.size(); i++) {
+		same &= sent[i] == received[i];
+	}
+	EXPECT_TRUE(same);
+}
+
+/* Consumer late: DMA already writes into half being handed over */
+static void testDmaRingOverrun() {
+	DmaCaptureModel dma;
+	struct sent_dma_ring ring;
+	SENT_DmaRingInit(&ring, dma.buf, DMA_MODEL_SIZE);
+	uint16_t out[DMA_MODEL_SIZE / 2];
+	uint32_t counter = 0;
+
+	for (int i = 0; i < DMA_MODEL_SIZE / 2; i++) {
+		dma.capture(counter += 1000);
+	}
+	EXPECT_EQ(DMA_MODEL_SIZE / 2 - 1, SENT_DmaRingHalf(&ring, 0, dma.remaining(), out));
+	EXPECT_EQ(1000, out[0]);
+
+	/* thread is late: DMA completed second half, first half again and
+	 * already wrote first entry of second half before thread handles both events */
+	for (int i = 0; i < DMA_MODEL_SIZE + 1; i++) {
+		dma.capture(counter += 1000);
+	}
+	EXPECT_EQ(1, SENT_DmaRingHalf(&ring, 1, dma.remaining(), out));
+	EXPECT_EQ(SENT_DMA_GAP_INTERVAL, out[0]);
+	EXPECT_EQ(1, ring.overruns);
+	/* first half is intact, first capture of it is new reference */
+	EXPECT_EQ(DMA_MODEL_SIZE / 2 - 1, SENT_DmaRingHalf(&ring, 0, dma.remaining(), out));
+	EXPECT_EQ(1000, out[0]);
+	EXPECT_EQ(1, ring.overruns);
+
+	/* missed event: half 0 reported again instead of 1 */
+	EXPECT_EQ(1, SENT_DmaRingHalf(&ring, 0, dma.remaining(), out));
+	EXPECT_EQ(SENT_DMA_GAP_INTERVAL, out[0]);
+	EXPECT_EQ(2, ring.overruns);
+
+	/* recovers with new reference on next good half */
+	for (int i = 0; i < DMA_MODEL_SIZE / 2 - 1; i++) {
+		dma.capture(counter += 2000);
+	}
+	EXPECT_EQ(DMA_MODEL_SIZE / 2 - 1, SENT_DmaRingHalf(&ring, 1, dma.remaining(), out));
+	EXPECT_EQ(2000, out[0]);
+	EXPECT_EQ(2, ring.overruns);
+}
+
+void testSentDmaRing() {
+	testDmaRingInOrder();
+	testDmaRingOverrun();
+}
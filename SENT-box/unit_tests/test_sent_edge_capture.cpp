@@ -0,0 +1,143 @@
+/**
+ * @file test_sent_edge_capture.cpp
+ *
+ * Cycle counter edge capture: synthetic counter sequences with wraparound,
+ * glitches and gaps, then through decoder
+ */
+
+#include <cstring>
+#include <vector>
+
+#include "sent_decoder.h"
+#include "sent_edge_capture.h"
+#include "sent_test.h"
+#include "sent_test_helpers.h"
+
+/* 2.7 uS at 72 MHz */
+#define CAPTURE_TICK	194
+#define CAPTURE_MIN_PULSE	(10 * 72)
+
+/* Counter values of edges, intervals after first edge at start */
+static std::vector<uint32_t> edgesOf(uint32_t start, const std::vector<uint32_t> &intervals) {
+	std::vector<uint32_t> edges = { start };
+	for (uint32_t i : intervals) {
+		edges.push_back(edges.back() + i);
+	}
+	return edges;
+}
+
+static std::vector<uint16_t> capture(struct sent_edge_capture *c, const std::vector<uint32_t> &edges) {
+	std::vector<uint16_t> out;
+	uint16_t clocks;
+
+	for (uint32_t e : edges) {
+		if (SENT_EdgeCapture(c, e, &clocks)) {
+			out.push_back(clocks);
+		}
+	}
+	return out;
+}
+
+static void testCaptureWrap() {
+	struct sent_edge_capture c;
+	SENT_EdgeCaptureInit(&c, CAPTURE_MIN_PULSE);
+
+	/* counter wraps in second interval, longest one still fits */
+	const std::vector<uint32_t> intervals = { 0x1000, 0xff00, 0x2345, 0xfffe, 56 * CAPTURE_TICK };
+	std::vector<uint16_t> out = capture(&c, edgesOf(0xffffef00, intervals));
+
+	EXPECT_EQ(intervals.size(), out.size());
+	for (size_t i = 0; i < out.size() && i < intervals.size(); i++) {
+		EXPECT_EQ(intervals[i], out[i]);
+	}
+	EXPECT_EQ(0, c.glitches);
+	EXPECT_EQ(0, c.gaps);
+}
+
+static void testCaptureGlitchAndGap() {
+	struct sent_edge_capture c;
+	SENT_EdgeCaptureInit(&c, CAPTURE_MIN_PULSE);
+
+	/* edge 0x10 after a real one is glitch: next interval is from real edge */
+	std::vector<uint32_t> edges = { 0xfffffff0, 0x1000, 0x1010, 0x3000 };
+	/* 32 bit gaps: exactly 16 bit max, longer, and much longer */
+	edges.push_back(0x3000 + 0xffff);
+	edges.push_back(edges.back() + 0x12345);
+	edges.push_back(edges.back() + 0x80000000);
+	edges.push_back(edges.back() + 0x800);
+	std::vector<uint16_t> out = capture(&c, edges);
+
+	const std::vector<uint16_t> expected = { 0x1010, 0x2000, SENT_GAP_INTERVAL, SENT_GAP_INTERVAL, SENT_GAP_INTERVAL, 0x800 };
+	EXPECT_EQ(expected.size(), out.size());
+	for (size_t i = 0; i < out.size() && i < expected.size(); i++) {
+		EXPECT_EQ(expected[i], out[i]);
+	}
+	EXPECT_EQ(1, c.glitches);
+	EXPECT_EQ(3, c.gaps);
+
+	/* no filter */
+	SENT_EdgeCaptureInit(&c, 0);
+	out = capture(&c, { 5, 6, 6, 7 });
+	EXPECT_EQ(3, out.size());
+	EXPECT_EQ(0, c.glitches);
+}
+
+template <class Profile>
+static uint32_t decodeEdges(struct sent_channel *ch, struct sent_edge_capture *c, const std::vector<uint32_t> &edges) {
+	std::vector<uint16_t> clocks = capture(c, edges);
+
+	memset(ch, 0, sizeof(*ch));
+	return SENT_DecodeBatch<Profile>(ch, clocks.data(), clocks.size(), nullptr, nullptr);
+}
+
+/* Gap or glitch is not a malformed pulse: decoder only loses frames gap falls into */
+static void testCaptureDecode() {
+	const uint8_t data[6] = { 1, 2, 3, 4, 5, 6 };
+	std::vector<uint32_t> intervals;
+
+	for (int i = 0; i < 10; i++) {
+		sentAppendFrame(intervals, CAPTURE_TICK, 0, data, 6);
+	}
+	std::vector<uint32_t> edges = edgesOf(0xfffff000, intervals);
+	/* edges ending 5 intervals in the middle of frame 5 are lost, long enough for a gap */
+	edges.erase(edges.begin() + 5 * 9 + 4, edges.begin() + 5 * 9 + 9);
+	for (size_t i = 5 * 9 + 4; i < edges.size(); i++) {
+		edges[i] += 0x20000;
+	}
+	/* glitch 1 uS into status nibble of frame 2 */
+	edges.insert(edges.begin() + 2 * 9 + 2, edges[2 * 9 + 1] + 72);
+
+	struct sent_channel ch;
+	struct sent_edge_capture c;
+	SENT_EdgeCaptureInit(&c, CAPTURE_MIN_PULSE);
+	/* frame 5 is lost in gap */
+	EXPECT_EQ(9, decodeEdges<SentProfileGmFuelPressure>(&ch, &c, edges));
+	EXPECT_EQ(1, c.glitches);
+	EXPECT_EQ(1, c.gaps);
+	EXPECT_EQ(0, ch.CrcErrCnt);
+	EXPECT_EQ(0, ch.SyncErr);
+	EXPECT_EQ(0, ch.LongIntervalErr);
+	EXPECT_EQ(0, ch.ShortIntervalErr);
+
+	/* pause longer than 16 bits is a gap right after CRC nibble: nothing is lost */
+	intervals.clear();
+	for (int i = 0; i < 10; i++) {
+		sentAppendFrame(intervals, CAPTURE_TICK, 0, data, 6, (i & 1) ? 0x18000 : 100 * CAPTURE_TICK);
+	}
+	intervals.push_back(56 * CAPTURE_TICK);
+	edges = edgesOf(0x12345678, intervals);
+	SENT_EdgeCaptureInit(&c, CAPTURE_MIN_PULSE);
+	EXPECT_EQ(10, decodeEdges<SentProfileFord>(&ch, &c, edges));
+	EXPECT_EQ(5, c.gaps);
+	EXPECT_EQ(0, ch.CrcErrCnt);
+	EXPECT_EQ(0, ch.SyncErr);
+	SENT_EdgeCaptureInit(&c, CAPTURE_MIN_PULSE);
+	EXPECT_EQ(10, decodeEdges<SentProfileVariableLength>(&ch, &c, edges));
+	EXPECT_EQ(0, ch.CrcErrCnt);
+}
+
+void testSentEdgeCapture() {
+	testCaptureWrap();
+	testCaptureGlitchAndGap();
+	testCaptureDecode();
+}
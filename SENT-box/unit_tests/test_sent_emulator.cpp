@@ -0,0 +1,290 @@
+/**
+ * @file test_sent_emulator.cpp
+ *
+ * SENT transmitter model against decoder: every profile, slow channel, injected errors, full bus load
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "sent_emulator.h"
+#include "sent_test.h"
+
+struct emu_loop {
+	struct sent_channel ch;
+	/* data nibbles sent and not decoded yet */
+	std::deque<std::vector<uint8_t>> sent;
+	uint32_t rnd;
+	uint32_t matched;
+	uint32_t mismatched;
+};
+
+static void randomFrame(uint8_t *status, uint8_t *data, void *arg) {
+	emu_loop *l = (emu_loop *)arg;
+
+	*status = l->rnd & 0x03;
+	for (int i = 0; i < SENT_MSG_DATA_SIZE; i++) {
+		l->rnd = l->rnd * 1103515245 + 12345;
+		data[i] = (l->rnd >> 16) & 0x0f;
+	}
+	/* Si7215 layout check: last data nibble is first one inverted */
+	data[5] = ~data[0] & 0x0f;
+	l->sent.push_back(std::vector<uint8_t>(data, data + SENT_MSG_DATA_SIZE));
+}
+
+static void checkFrame(struct sent_channel_hot *ch, void *arg) {
+	emu_loop *l = (emu_loop *)arg;
+
+	/* frames lost by decoder are skipped */
+	while (!l->sent.empty()) {
+		std::vector<uint8_t> data = l->sent.front();
+		l->sent.pop_front();
+		if (memcmp(data.data(), ch->nibbles + 1, ch->frameDataNibbles) == 0) {
+			l->matched++;
+			return;
+		}
+	}
+	l->mismatched++;
+}
+
+/* Generate frames and decode them in batches of intervals */
+template <class Profile>
+static void loop(emu_loop &l, struct sent_emulator *emu, uint32_t frames) {
+	std::vector<uint16_t> clocks;
+
+	for (uint32_t i = 0; i < frames; i++) {
+		uint16_t buf[SENT_EMU_MAX_PULSES];
+		uint8_t status, data[SENT_MSG_DATA_SIZE];
+
+		randomFrame(&status, data, &l);
+		size_t n = SENT_EmuFrame(emu, status, data, buf);
+		clocks.insert(clocks.end(), buf, buf + n);
+	}
+	/* variable length frame is done on next sync */
+	clocks.push_back((SENT_SYNC_INTERVAL + SENT_OFFSET_INTERVAL) * Profile::tickClocks);
+	SENT_DecodeBatch<Profile>(&l.ch, clocks.data(), clocks.size(), checkFrame, &l);
+}
+
+template <class Profile>
+static void testProfile() {
+	struct sent_emu_cfg cfg;
+	struct sent_emulator emu;
+	emu_loop l;
+
+	SENT_EmuDefaultCfg<Profile>(&cfg);
+	SENT_EmuInit(&emu, &cfg);
+	memset(&l.ch, 0, sizeof(l.ch));
+	l.rnd = 1;
+	l.matched = l.mismatched = 0;
+
+	loop<Profile>(l, &emu, 500);
+	EXPECT_EQ(500, l.matched);
+	EXPECT_EQ(0, l.mismatched);
+	EXPECT_EQ(500, l.ch.FrameCnt);
+	EXPECT_EQ(0, l.ch.CrcErrCnt);
+	EXPECT_EQ(0, l.ch.SyncErr);
+	EXPECT_EQ(0, l.ch.LongIntervalErr);
+}
+
+/* Whole number of clocks per tick and no jitter: every interval is exact multiple of tick */
+static void testBitExact() {
+	struct sent_emu_cfg cfg;
+	struct sent_emulator emu;
+	const uint8_t data[6] = { 0, 15, 1, 14, 2, 13 };
+	uint16_t clocks[SENT_EMU_MAX_PULSES];
+
+	SENT_EmuDefaultCfg<SentProfileGmFuelPressure>(&cfg);
+	SENT_EmuInit(&emu, &cfg);
+	EXPECT_EQ(9, SENT_EmuFrame(&emu, 2, data, clocks));
+
+	const uint32_t tick = SentProfileGmFuelPressure::tickClocks;
+	EXPECT_EQ(56 * tick, clocks[0]);
+	EXPECT_EQ(14 * tick, clocks[1]);
+	for (int i = 0; i < 6; i++) {
+		EXPECT_EQ((12 + data[i]) * tick, clocks[2 + i]);
+	}
+	EXPECT_EQ((12 + sent_crc4_gm((uint8_t *)data, 6)) * tick, clocks[8]);
+
+	/* constant frame length with pause */
+	SENT_EmuDefaultCfg<SentProfileFord>(&cfg);
+	SENT_EmuInit(&emu, &cfg);
+	EXPECT_EQ(10, SENT_EmuFrame(&emu, 0, data, clocks));
+	uint32_t sum = 0;
+	for (int i = 0; i < 10; i++) {
+		sum += clocks[i];
+	}
+	EXPECT_EQ(290 * SentProfileFord::tickClocks, sum);
+}
+
+/* Messages of all three formats come out of decoder mailboxes */
+static void testSlowChannel() {
+	const struct sent_emu_slow_msg msgs[] = {
+		{ SENT_SLOW_ENHANCED_12, 0x5a, 0xabc },
+		{ SENT_SLOW_ENHANCED_16, 0x07, 0xbeef },
+		{ SENT_SLOW_ENHANCED_12, 0x01, 0x001 },
+	};
+	const struct sent_emu_slow_msg shortMsgs[] = {
+		{ SENT_SLOW_SHORT, 0x3, 0x42 },
+		{ SENT_SLOW_SHORT, 0xc, 0xff },
+	};
+	struct sent_emu_cfg cfg;
+	struct sent_emulator emu;
+	emu_loop l;
+
+	SENT_EmuDefaultCfg<SentProfileGmFuelPressure>(&cfg);
+	cfg.slow = msgs;
+	cfg.slowNum = 3;
+	SENT_EmuInit(&emu, &cfg);
+	memset(&l.ch, 0, sizeof(l.ch));
+	l.rnd = 7;
+	loop<SentProfileGmFuelPressure>(l, &emu, 18 * 6);
+
+	EXPECT_EQ(6, emu.slowMsgCnt);
+	EXPECT_EQ(0, l.ch.ScCrcErrCnt);
+	for (const sent_emu_slow_msg &m : msgs) {
+		int i = SENT_SlowMsgFind(&l.ch, (sent_slow_format)m.format, m.id);
+		EXPECT_TRUE(i >= 0);
+		if (i >= 0) {
+			EXPECT_EQ(m.data, l.ch.scMsg[i].data);
+			EXPECT_EQ(2, l.ch.scMsg[i].count);
+		}
+	}
+
+	/* short messages with legacy CRC */
+	SENT_EmuDefaultCfg<SentProfileSi7215>(&cfg);
+	cfg.slow = shortMsgs;
+	cfg.slowNum = 2;
+	SENT_EmuInit(&emu, &cfg);
+	memset(&l.ch, 0, sizeof(l.ch));
+	loop<SentProfileSi7215>(l, &emu, 16 * 4);
+	EXPECT_EQ(0, l.ch.ScCrcErrCnt);
+	for (const sent_emu_slow_msg &m : shortMsgs) {
+		int i = SENT_SlowMsgFind(&l.ch, SENT_SLOW_SHORT, m.id);
+		EXPECT_TRUE(i >= 0);
+		if (i >= 0) {
+			EXPECT_EQ(m.data, l.ch.scMsg[i].data);
+		}
+	}
+}
+
+/* Decoder counts exactly injected CRC errors and recovers from glitches and lost edges */
+static void testErrorInjection() {
+	struct sent_emu_cfg cfg;
+	struct sent_emulator emu;
+	emu_loop l;
+
+	SENT_EmuDefaultCfg<SentProfileGmFuelPressure>(&cfg);
+	cfg.crcErrRate = SENT_EMU_RATE_ONE / 20;
+	SENT_EmuInit(&emu, &cfg);
+	memset(&l.ch, 0, sizeof(l.ch));
+	l.rnd = 3;
+	l.matched = l.mismatched = 0;
+	loop<SentProfileGmFuelPressure>(l, &emu, 2000);
+	EXPECT_TRUE(emu.crcErrCnt > 50);
+	EXPECT_EQ(emu.crcErrCnt, l.ch.CrcErrCnt);
+	EXPECT_EQ(2000 - emu.crcErrCnt, l.matched);
+
+	SENT_EmuDefaultCfg<SentProfileGmFuelPressure>(&cfg);
+	cfg.glitchRate = SENT_EMU_RATE_ONE / 50;
+	cfg.dropRate = SENT_EMU_RATE_ONE / 50;
+	cfg.jitter = 20 << SENT_TICK_FRAC_BITS;
+	SENT_EmuInit(&emu, &cfg);
+	memset(&l.ch, 0, sizeof(l.ch));
+	l.sent.clear();
+	l.matched = l.mismatched = 0;
+	loop<SentProfileGmFuelPressure>(l, &emu, 2000);
+	printf("emulator: %d glitches %d lost edges, decoded %d of 2000, wrong %d\r\n",
+		emu.glitchCnt, emu.dropCnt, l.matched, l.mismatched);
+	EXPECT_TRUE(emu.glitchCnt + emu.dropCnt > 40);
+	/* frame with error and at most one next while decoder resyncs */
+	EXPECT_TRUE(l.matched + 2 * (emu.glitchCnt + emu.dropCnt) >= 2000);
+	/* CRC still catches what slips through */
+	EXPECT_EQ(0, l.mismatched);
+}
+
+/* Tick drifting up and down by 15% */
+static void testDrift() {
+	struct sent_emu_cfg cfg;
+	struct sent_emulator emu;
+	emu_loop l;
+
+	SENT_EmuDefaultCfg<SentProfileGmFuelPressure>(&cfg);
+	cfg.tickDrift = cfg.tickFrac / 1000;
+	cfg.driftSpan = cfg.tickFrac * 15 / 100;
+	SENT_EmuInit(&emu, &cfg);
+	memset(&l.ch, 0, sizeof(l.ch));
+	l.rnd = 5;
+	l.matched = l.mismatched = 0;
+	loop<SentProfileGmFuelPressure>(l, &emu, 2000);
+	EXPECT_EQ(2000, l.matched);
+	EXPECT_EQ(0, l.ch.CrcErrCnt);
+}
+
+/* Continuous stream is same whatever read sizes are */
+static void testRead() {
+	struct sent_emu_cfg cfg;
+	struct sent_emulator a, b;
+	emu_loop la, lb;
+	std::vector<uint16_t> sa(1000), sb;
+
+	SENT_EmuDefaultCfg<SentProfileFord>(&cfg);
+	cfg.jitter = 30 << SENT_TICK_FRAC_BITS;
+	SENT_EmuInit(&a, &cfg);
+	SENT_EmuInit(&b, &cfg);
+	la.rnd = lb.rnd = 9;
+
+	SENT_EmuRead(&a, sa.data(), sa.size(), randomFrame, &la);
+	for (size_t n = 1; sb.size() < sa.size(); n = n % 13 + 1) {
+		uint16_t buf[13];
+		n = std::min(n, sa.size() - sb.size());
+		SENT_EmuRead(&b, buf, n, randomFrame, &lb);
+		sb.insert(sb.end(), buf, buf + n);
+	}
+	EXPECT_TRUE(sa == sb);
+}
+
+void testSentEmulator() {
+	testProfile<SentProfileDefault>();
+	testProfile<SentProfileGmEtb>();
+	testProfile<SentProfileGmFuelPressure>();
+	testProfile<SentProfileSi7215>();
+	testProfile<SentProfileFord>();
+	testProfile<SentProfileVariableLength>();
+	testBitExact();
+	testSlowChannel();
+	testErrorInjection();
+	testDrift();
+	testRead();
+}
+
+/* Decoder at 100% bus load, shortest legal tick (3 uS) and no pause: how much of real time it takes */
+void benchmarkSentEmulator() {
+	struct sent_emu_cfg cfg;
+	struct sent_emulator emu;
+	emu_loop l;
+	std::vector<uint16_t> clocks(1 << 20);
+
+	SENT_EmuDefaultCfg<SentProfileFord>(&cfg);
+	cfg.pauseTicks = 0;
+	cfg.jitter = 20 << SENT_TICK_FRAC_BITS;
+	SENT_EmuInit(&emu, &cfg);
+	l.rnd = 11;
+	SENT_EmuRead(&emu, clocks.data(), clocks.size(), randomFrame, &l);
+
+	uint64_t busClocks = 0;
+	for (uint16_t c : clocks) {
+		busClocks += c;
+	}
+
+	memset(&l.ch, 0, sizeof(l.ch));
+	auto start = std::chrono::steady_clock::now();
+	SENT_DecodeBatch<SentProfileFord>(&l.ch, clocks.data(), clocks.size(), nullptr, nullptr);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	double busSeconds = busClocks / (SENT_TIMER_CLOCK_MHZ * 1e6);
+	printf("BENCH emulator full load: %d frames in %.2f s of bus, %.1f ns/pulse, %.0fx real time\r\n",
+		l.ch.FrameCnt, busSeconds, elapsed.count() * 1e9 / clocks.size(), busSeconds / elapsed.count());
+}
@@ -0,0 +1,98 @@
+/**
+ * @file test_sent_frame_ring.cpp
+ *
+ * Decoder thread to consumers frame ring and latency statistic
+ */
+
+#include <atomic>
+#include <thread>
+
+#include "sent_frame_ring.h"
+#include "sent_test.h"
+
+static struct sent_frame makeFrame(uint32_t n) {
+	struct sent_frame frame = {};
+	frame.syncTime = n * 1000;
+	frame.sig0 = n;
+	frame.sig1 = -(int32_t)n;
+	return frame;
+}
+
+static void testFrameRingReadBySeq() {
+	SentFrameRing<4> ring;
+	struct sent_frame frame;
+
+	EXPECT_EQ(0, ring.lastSeq());
+	EXPECT_TRUE(!ring.read(0, &frame));
+	EXPECT_TRUE(!ring.read(1, &frame));
+
+	for (uint32_t i = 1; i <= 6; i++) {
+		EXPECT_EQ(i, ring.push(makeFrame(i)));
+	}
+	EXPECT_EQ(6, ring.lastSeq());
+
+	/* 1 and 2 are overwritten, 7 is not there yet */
+	EXPECT_TRUE(!ring.read(1, &frame));
+	EXPECT_TRUE(!ring.read(2, &frame));
+	EXPECT_TRUE(!ring.read(7, &frame));
+	for (uint32_t i = 3; i <= 6; i++) {
+		EXPECT_TRUE(ring.read(i, &frame));
+		EXPECT_EQ(i, frame.sig0);
+		EXPECT_EQ(i * 1000, frame.syncTime);
+	}
+}
+
+/* Reader never gets a frame mixed from two pushes */
+static void testFrameRingConcurrent() {
+	static SentFrameRing<2> ring;
+	const uint32_t total = 100000;
+	std::atomic<bool> done{false};
+	uint32_t torn = 0;
+	uint32_t reads = 0;
+
+	std::thread writer([&]() {
+		for (uint32_t i = 1; i <= total; i++) {
+			ring.push(makeFrame(i));
+			if ((i % 64) == 0) {
+				std::this_thread::yield();
+			}
+		}
+		done = true;
+	});
+
+	while (!done) {
+		struct sent_frame frame;
+		uint32_t seq = ring.lastSeq();
+		if (ring.read(seq, &frame)) {
+			reads++;
+			if ((frame.sig0 != (int32_t)seq) || (frame.sig1 != -(int32_t)seq) || (frame.syncTime != seq * 1000)) {
+				torn++;
+			}
+		}
+		std::this_thread::yield();
+	}
+	writer.join();
+
+	EXPECT_EQ(0, torn);
+	EXPECT_EQ(total, ring.lastSeq());
+	printf("Frame ring: %d consistent reads while writing\r\n", reads);
+}
+
+static void testLatencyStats() {
+	struct sent_latency lat = {};
+
+	EXPECT_EQ(0, SENT_LatencyAvg(&lat));
+	SENT_LatencyAdd(&lat, 300);
+	SENT_LatencyAdd(&lat, 100);
+	SENT_LatencyAdd(&lat, 200);
+	EXPECT_EQ(100, lat.min);
+	EXPECT_EQ(300, lat.max);
+	EXPECT_EQ(200, SENT_LatencyAvg(&lat));
+	EXPECT_EQ(3, lat.count);
+}
+
+void testSentFrameRing() {
+	testFrameRingReadBySeq();
+	testFrameRingConcurrent();
+	testLatencyStats();
+}
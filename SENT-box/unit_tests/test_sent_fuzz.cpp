@@ -0,0 +1,128 @@
+/**
+ * @file test_sent_fuzz.cpp
+ *
+ * Fuzz target run over seed corpus and fixed pseudo random mutations of it,
+ * so every unit test run covers what fuzzer would start from
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include "fuzz_sent_decoder.h"
+#include "sent_test.h"
+
+#define FUZZ_SEED_INTERVALS		2048
+#define FUZZ_MUTATIONS			64
+#define FUZZ_RANDOM_INPUTS		64
+/* random inputs are long enough for channel set reset to vanish in per interval time */
+#define FUZZ_MIN_INTERVALS		256
+/* slowest input may take this much longer per interval than seeds do on average */
+#define FUZZ_MAX_SLOWDOWN		50
+/* each input is timed this many times, fastest run counts: preemption of
+ * test process only makes some runs slower */
+#define FUZZ_TIMING_RUNS		5
+
+static uint32_t fuzzRandom(uint32_t *state) {
+	/* xorshift32 */
+	uint32_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+/* Per interval time of input, best of FUZZ_TIMING_RUNS */
+static double runInput(const std::vector<uint8_t> &input) {
+	double best = 0;
+
+	for (int run = 0; run < FUZZ_TIMING_RUNS; run++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+		auto end = std::chrono::high_resolution_clock::now();
+		double ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+		if ((run == 0) || (ns < best)) {
+			best = ns;
+		}
+	}
+
+	size_t intervals = std::max<size_t>((input.size() - SENT_FUZZ_HEADER_SIZE) / 2, 1);
+	return best / intervals;
+}
+
+/* Byte flips, pulse overwrites and header changes, as fuzzer does to seeds */
+static void mutate(std::vector<uint8_t> &input, uint32_t *rnd) {
+	size_t n = 1 + fuzzRandom(rnd) % 16;
+
+	for (size_t i = 0; i < n; i++) {
+		size_t pos = fuzzRandom(rnd) % input.size();
+		switch (fuzzRandom(rnd) % 4) {
+		case 0:
+			input[pos] ^= 1 << (fuzzRandom(rnd) % 8);
+			break;
+		case 1:
+			input[pos] = fuzzRandom(rnd);
+			break;
+		case 2:
+			/* extreme intervals: zero or max */
+			pos = SENT_FUZZ_HEADER_SIZE + 2 * (pos % ((input.size() - SENT_FUZZ_HEADER_SIZE) / 2));
+			input[pos] = input[pos + 1] = (fuzzRandom(rnd) & 1) ? 0xff : 0;
+			break;
+		case 3:
+			input[fuzzRandom(rnd) % SENT_FUZZ_HEADER_SIZE] = fuzzRandom(rnd);
+			break;
+		}
+	}
+}
+
+void testSentFuzz() {
+	std::vector<std::vector<uint8_t>> seeds;
+	sentFuzzSeeds(seeds, FUZZ_SEED_INTERVALS);
+	EXPECT_TRUE(seeds.size() > 0);
+	if (seeds.empty()) {
+		return;
+	}
+
+	double seedTime = 0;
+	for (const auto &seed : seeds) {
+		seedTime += runInput(seed);
+	}
+	seedTime /= seeds.size();
+
+	uint32_t rnd = 0x5e47f00d;
+	double worst = 0;
+
+	for (size_t i = 0; i < FUZZ_MUTATIONS; i++) {
+		std::vector<uint8_t> input = seeds[i % seeds.size()];
+		mutate(input, &rnd);
+		worst = std::max(worst, runInput(input));
+	}
+
+	for (size_t i = 0; i < FUZZ_RANDOM_INPUTS; i++) {
+		std::vector<uint8_t> input(SENT_FUZZ_HEADER_SIZE + 2 * (FUZZ_MIN_INTERVALS + fuzzRandom(&rnd) % FUZZ_SEED_INTERVALS));
+		for (auto &b : input) {
+			b = fuzzRandom(&rnd);
+		}
+		/* half of them with pathological intervals only */
+		if (i & 1) {
+			for (size_t j = SENT_FUZZ_HEADER_SIZE; j < input.size(); j++) {
+				input[j] &= 0x01;
+			}
+		}
+		worst = std::max(worst, runInput(input));
+	}
+
+	/* short inputs */
+	for (size_t len = 0; len < 8; len++) {
+		std::vector<uint8_t> input(len, 0xff);
+		runInput(input);
+	}
+
+	printf("fuzz: %d seeds at %.1f ns/interval, worst mutated input %.1f ns/interval\r\n",
+		(int)seeds.size(), seedTime, worst);
+	/* timing is noisy under sanitizers, floor keeps check about real slowdowns only */
+	EXPECT_TRUE(worst < FUZZ_MAX_SLOWDOWN * std::max(seedTime, 20.0));
+}
@@ -0,0 +1,94 @@
+/**
+ * @file test_sent_nibble.cpp
+ *
+ * Reciprocal pulse classifier against plain division
+ */
+
+#include <chrono>
+#include <vector>
+
+#include "sent_decoder.h"
+#include "sent_test.h"
+#include "sent_test_helpers.h"
+
+/* Largest tick decoder can measure: sync pulse of 65535 clocks */
+#define MAX_TICK_CLOCKS ((0xffff + 56 / 2) / 56)
+
+/* Every 16 bit interval against every tick decoder can end up with */
+static void testPulseTicksExhaustive() {
+	uint32_t mismatches = 0;
+
+	for (uint32_t tick = 2; tick <= MAX_TICK_CLOCKS; tick++) {
+		uint32_t recip = SENT_TickRecip(tick);
+		for (uint32_t clocks = 0; clocks <= 0xffff; clocks++) {
+			if (SENT_PulseTicks(clocks, tick, recip) != (clocks + tick / 2) / tick) {
+				mismatches++;
+			}
+		}
+	}
+	EXPECT_EQ(0, mismatches);
+}
+
+/* Stated bound: still exact at the largest tick, power of two ticks are exact reciprocals */
+static void testPulseTicksEdges() {
+	uint32_t ticks[] = { 2, 3, 1024, 4096, 32767 };
+	uint32_t mismatches = 0;
+
+	for (uint32_t tick : ticks) {
+		uint32_t recip = SENT_TickRecip(tick);
+		for (uint32_t clocks = 0; clocks <= 0xffff; clocks++) {
+			if (SENT_PulseTicks(clocks, tick, recip) != (clocks + tick / 2) / tick) {
+				mismatches++;
+			}
+		}
+	}
+	EXPECT_EQ(0, mismatches);
+	EXPECT_EQ(1u << 22, SENT_TickRecip(1024));
+}
+
+void testSentNibbleClassifier() {
+	testPulseTicksExhaustive();
+	testPulseTicksEdges();
+}
+
+/* Host timing of both forms on one capture, for reference only: unit tests
+ * build at -O0 with ASan and either form can come out ahead. It is no
+ * evidence for the target, Cortex-M3 has hardware divide taking 2..12
+ * cycles, only a cycle count there could tell */
+void benchmarkSentNibbleClassifier() {
+	std::vector<uint16_t> intervals = sentLoadRecording(SENT_RECORDINGS_DIR "SENT-fuel-pressure.csv");
+
+	/* tick is only known at run time, as in decoder */
+	volatile uint32_t tickSource = 184;
+	uint32_t tick = tickSource;
+	uint32_t recip = SENT_TickRecip(tick);
+	uint32_t sumDiv = 0;
+	uint32_t sumRecip = 0;
+	uint64_t pulses = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	std::chrono::duration<double> elapsedDiv;
+	do {
+		for (uint16_t clocks : intervals) {
+			sumDiv += (clocks + tick / 2) / tick;
+		}
+		pulses += intervals.size();
+		elapsedDiv = std::chrono::steady_clock::now() - start;
+	} while (elapsedDiv.count() < 0.1);
+	double nsDiv = elapsedDiv.count() * 1e9 / pulses;
+
+	pulses = 0;
+	start = std::chrono::steady_clock::now();
+	std::chrono::duration<double> elapsedRecip;
+	do {
+		for (uint16_t clocks : intervals) {
+			sumRecip += SENT_PulseTicks(clocks, tick, recip);
+		}
+		pulses += intervals.size();
+		elapsedRecip = std::chrono::steady_clock::now() - start;
+	} while (elapsedRecip.count() < 0.1);
+	double nsRecip = elapsedRecip.count() * 1e9 / pulses;
+
+	printf("BENCH nibble classifier, host only: division %.2f ns/pulse, reciprocal %.2f ns/pulse (%u)\r\n",
+		nsDiv, nsRecip, sumDiv ^ sumRecip);
+}
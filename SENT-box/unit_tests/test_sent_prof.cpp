@@ -0,0 +1,140 @@
+/**
+ * @file test_sent_prof.cpp
+ *
+ * Timing instrumentation: histograms over fake cycle counter, mailbox high
+ * water, wakeup latency and its telemetry and CAN reports
+ */
+
+#include <cstring>
+
+#include "sent_can.h"
+#include "sent_prof.h"
+#include "sent_telemetry.h"
+#include "sent_telemetry_decoder.h"
+#include "sent_test.h"
+
+/* stands for DWT cycle counter of target */
+static uint32_t fakeCycles;
+
+uint32_t SENT_ProfCycles(void) {
+	return fakeCycles;
+}
+
+static void testProfBins() {
+	EXPECT_EQ(0, SENT_ProfBin(0));
+	EXPECT_EQ(0, SENT_ProfBin(1));
+	EXPECT_EQ(1, SENT_ProfBin(2));
+	EXPECT_EQ(1, SENT_ProfBin(3));
+	EXPECT_EQ(7, SENT_ProfBin(255));
+	EXPECT_EQ(8, SENT_ProfBin(256));
+	EXPECT_EQ(SENT_PROF_BINS - 1, SENT_ProfBin(1 << (SENT_PROF_BINS - 1)));
+	EXPECT_EQ(SENT_PROF_BINS - 1, SENT_ProfBin(0xffffffff));
+}
+
+static void testProfSections() {
+	struct sent_prof prof = {};
+	const struct sent_prof_hist *isr = &prof.hist[SENT_PROF_ISR];
+	const struct sent_prof_hist *pulse = &prof.hist[SENT_PROF_PULSE];
+
+	/* counter wraps inside section */
+	fakeCycles = 0xffffffff - 50;
+	uint32_t start = SENT_ProfCycles();
+	fakeCycles += 300;
+	SENT_ProfEnd(&prof, SENT_PROF_ISR, start, 1);
+	EXPECT_EQ(300, isr->min);
+	EXPECT_EQ(300, isr->max);
+	EXPECT_EQ(1, isr->count);
+	EXPECT_EQ(1, isr->bins[8]);
+
+	start = fakeCycles;
+	fakeCycles += 100;
+	SENT_ProfEnd(&prof, SENT_PROF_ISR, start, 1);
+	start = fakeCycles;
+	fakeCycles += 5000;
+	SENT_ProfEnd(&prof, SENT_PROF_ISR, start, 1);
+	EXPECT_EQ(100, isr->min);
+	EXPECT_EQ(5000, isr->max);
+	EXPECT_EQ(3, isr->count);
+	EXPECT_EQ(1, isr->bins[6]);
+	EXPECT_EQ(1, isr->bins[12]);
+
+	/* batch of 64 pulses is one sample of average per pulse */
+	start = fakeCycles;
+	fakeCycles += 64 * 150;
+	SENT_ProfEnd(&prof, SENT_PROF_PULSE, start, 64);
+	EXPECT_EQ(1, pulse->count);
+	EXPECT_EQ(150, pulse->max);
+	EXPECT_EQ(0, prof.hist[SENT_PROF_WAKE].count);
+
+	SENT_ProfMailbox(&prof, 3);
+	SENT_ProfMailbox(&prof, 17);
+	SENT_ProfMailbox(&prof, 5);
+	EXPECT_EQ(17, prof.mailboxHighWater);
+}
+
+/* Latency is from first of signals coalesced into one wakeup, timeouts are not counted */
+static void testProfWake() {
+	struct sent_prof prof = {};
+	const struct sent_prof_hist *wake = &prof.hist[SENT_PROF_WAKE];
+
+	fakeCycles = 1000;
+	SENT_ProfWakeRun(&prof);
+	EXPECT_EQ(0, wake->count);
+
+	SENT_ProfWakeSignal(&prof);
+	fakeCycles += 200;
+	SENT_ProfWakeSignal(&prof);
+	fakeCycles += 300;
+	SENT_ProfWakeRun(&prof);
+	EXPECT_EQ(1, wake->count);
+	EXPECT_EQ(500, wake->max);
+
+	fakeCycles += 10000;
+	SENT_ProfWakeRun(&prof);
+	EXPECT_EQ(1, wake->count);
+
+	SENT_ProfWakeSignal(&prof);
+	fakeCycles += 40;
+	SENT_ProfWakeRun(&prof);
+	EXPECT_EQ(2, wake->count);
+	EXPECT_EQ(40, wake->min);
+	EXPECT_EQ(500, wake->max);
+}
+
+static void testProfReports() {
+	struct sent_prof prof = {};
+	uint8_t payload[SENT_TLM_MAX_PAYLOAD + 2];
+	struct sent_tlm_packet packet;
+
+	for (uint32_t i = 0; i < 1000; i++) {
+		SENT_ProfHistAdd(&prof.hist[SENT_PROF_PULSE], 40 + i % 200);
+	}
+	SENT_ProfHistAdd(&prof.hist[SENT_PROF_ISR], 0x12345);
+	SENT_ProfHistAdd(&prof.hist[SENT_PROF_WAKE], 900);
+	prof.mailboxHighWater = 70000;
+
+	size_t n = SENT_TlmPackProf(9, 0x11223344, SENT_PROF_PULSE, &prof.hist[SENT_PROF_PULSE],
+		prof.mailboxHighWater, payload);
+	EXPECT_EQ(SENT_TLM_HEADER_SIZE + SENT_TLM_PROF_SIZE, n);
+	EXPECT_TRUE(sentTlmParse(payload, n, &packet));
+	EXPECT_EQ(SENT_TLM_PROF, packet.type);
+	EXPECT_EQ(SENT_PROF_PULSE, packet.profSection);
+	EXPECT_EQ(0, memcmp(&packet.prof, &prof.hist[SENT_PROF_PULSE], sizeof(packet.prof)));
+	EXPECT_EQ(0xffff, packet.profHighWater);
+	/* truncated packet is rejected */
+	EXPECT_TRUE(!sentTlmParse(payload, n - 1, &packet));
+
+	uint8_t data[SENT_CAN_DLC];
+	SENT_CanPackProf(&prof, data);
+	const uint8_t expected[SENT_CAN_DLC] = { 0xff, 0xff, 239, 0, 900 & 0xff, 900 >> 8, 0xff, 0xff };
+	for (int i = 0; i < SENT_CAN_DLC; i++) {
+		EXPECT_EQ(expected[i], data[i]);
+	}
+}
+
+void testSentProf() {
+	testProfBins();
+	testProfSections();
+	testProfWake();
+	testProfReports();
+}
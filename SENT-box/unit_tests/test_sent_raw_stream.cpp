@@ -0,0 +1,248 @@
+/**
+ * @file test_sent_raw_stream.cpp
+ *
+ * Raw interval streaming: decoder thread tap, UART packets, host recorder
+ * and replay of what was recorded
+ */
+
+#include <cstring>
+#include <vector>
+
+#include "sent_decoder.h"
+#include "sent_raw_recorder.h"
+#include "sent_raw_stream.h"
+#include "sent_telemetry.h"
+#include "sent_test.h"
+#include "sent_test_helpers.h"
+
+#define RAW_TEST_CHANNELS	2
+/* same as firmware */
+#define RAW_CAPTURE_RING	64
+#define RAW_STREAM_RING		128
+
+static std::vector<uint16_t> loadClocks(const char *fileName, int column = 0) {
+	std::vector<uint16_t> clocks;
+	EXPECT_TRUE(sentLoadRecording(fileName, clocks, column));
+	return clocks;
+}
+
+struct raw_stream_sim {
+	const std::vector<uint16_t> *clocks[RAW_TEST_CHANNELS];
+	/* firmware */
+	SentRawStream<RAW_STREAM_RING> raw[RAW_TEST_CHANNELS];
+	uint32_t captureOverflows[RAW_TEST_CHANNELS];
+	/* host */
+	TelemetryDecoder decoder;
+	RawRecorder recorder;
+};
+
+static void onRawPacket(const struct sent_tlm_packet *packet, void *arg) {
+	((RawRecorder *)arg)->onPacket(packet);
+}
+
+/* UART thread: send packets while line has budget. True if it ran out of budget,
+ * false if there is nothing left to send */
+static bool sendRawPackets(raw_stream_sim &sim, uint32_t now, int64_t *budget, uint8_t *seq, uint32_t *rr) {
+	while (*budget > 0) {
+		uint16_t clocks[SENT_TLM_MAX_INTERVALS];
+		uint8_t payload[SENT_TLM_MAX_PAYLOAD + 2];
+		uint8_t out[SENT_TLM_MAX_PACKET];
+		size_t len = 0;
+
+		for (int i = 0; (i < RAW_TEST_CHANNELS) && (len == 0); i++) {
+			uint32_t n = *rr;
+			uint32_t endTime, lost;
+			bool gap;
+
+			*rr = (*rr + 1) % RAW_TEST_CHANNELS;
+			size_t cnt = sim.raw[n].read(clocks, SENT_TLM_MAX_INTERVALS, &endTime, &gap, &lost);
+			if (cnt) {
+				len = SENT_TlmPackIntervals((*seq)++, now, n, gap, lost, endTime, clocks, cnt, payload);
+			}
+		}
+		if (len == 0) {
+			*budget = 0;
+			return false;
+		}
+		len = SENT_TlmEncode(payload, len, out);
+		*budget -= len;
+		sim.decoder.feed(out, len, onRawPacket, &sim.recorder);
+	}
+
+	return true;
+}
+
+/* Decoder thread wakes every wakeUs, UART sends lineBytesPerS worth of packets in that time.
+ * Capture time starts just before 32 bit wrap. One more edge comes after recording ends,
+ * so gap at the very end is reported too */
+static void simulateRawStream(raw_stream_sim &sim, uint32_t wakeUs, uint32_t lineBytesPerS) {
+	const uint32_t wakeClocks = wakeUs * SENT_TIMER_CLOCK_MHZ;
+	uint32_t captureTime[RAW_TEST_CHANNELS];
+	size_t next[RAW_TEST_CHANNELS] = {};
+	uint8_t seq = 0;
+	uint32_t rr = 0;
+	/* bytes line can take before next wakeup, carried over */
+	int64_t budget = 0;
+
+	for (int n = 0; n < RAW_TEST_CHANNELS; n++) {
+		captureTime[n] = 0xfff00000 + n * 1234;
+		sim.captureOverflows[n] = 0;
+		sim.raw[n].enable(true);
+	}
+
+	uint32_t now = 0xfff00000;
+	bool more = true;
+	while (more) {
+		now += wakeClocks;
+		more = false;
+
+		/* decoder thread: edges captured so far, capture ring drops what does not fit */
+		for (int n = 0; n < RAW_TEST_CHANNELS; n++) {
+			const std::vector<uint16_t> &clocks = *sim.clocks[n];
+			struct sent_edge edges[RAW_CAPTURE_RING];
+			size_t cnt = 0;
+
+			while ((next[n] < clocks.size()) && ((int32_t)(captureTime[n] + clocks[next[n]] - now) <= 0)) {
+				captureTime[n] += clocks[next[n]];
+				if (cnt < RAW_CAPTURE_RING) {
+					edges[cnt].time = captureTime[n];
+					edges[cnt].clocks = clocks[next[n]];
+					cnt++;
+				} else {
+					sim.captureOverflows[n]++;
+				}
+				next[n]++;
+			}
+			sim.raw[n].tap(edges, cnt, sim.captureOverflows[n]);
+			more |= next[n] < clocks.size();
+		}
+
+		/* UART thread, sees everything eventually */
+		budget += (int64_t)lineBytesPerS * wakeUs / 1000000;
+		more |= sendRawPackets(sim, now, &budget, &seq, &rr);
+	}
+
+	for (int n = 0; n < RAW_TEST_CHANNELS; n++) {
+		struct sent_edge last = { captureTime[n] + 1000, 1000 };
+		sim.raw[n].tap(&last, 1, sim.captureOverflows[n]);
+	}
+	budget = 1000000;
+	sendRawPackets(sim, now, &budget, &seq, &rr);
+}
+
+template <class Profile>
+static int decodeFile(const char *fileName, int column) {
+	std::vector<uint16_t> clocks = loadClocks(fileName, column);
+	struct sent_channel ch = {};
+	return SENT_DecodeBatch<Profile>(&ch, clocks.data(), clocks.size(), nullptr, nullptr);
+}
+
+/* Line is fast enough: recording replays to exactly the same intervals and frames */
+static void testRawStreamLossless() {
+	const char *csv = "build/raw_stream_lossless.csv";
+	std::vector<uint16_t> fuel = loadClocks(SENT_RECORDINGS_DIR "SENT-fuel-pressure.csv");
+	std::vector<uint16_t> ford = loadClocks(SENT_RECORDINGS_DIR "ford-sent-closed.csv");
+	static raw_stream_sim sim;
+	sim.clocks[0] = &fuel;
+	sim.clocks[1] = &ford;
+
+	simulateRawStream(sim, 500, 92160);
+
+	EXPECT_EQ(0, sim.decoder.badPacketCnt + sim.decoder.lostPacketCnt);
+	EXPECT_EQ(2, sim.recorder.channels());
+	EXPECT_EQ(fuel.size() + 1, sim.recorder.intervalCnt[0]);
+	EXPECT_EQ(ford.size() + 1, sim.recorder.intervalCnt[1]);
+	EXPECT_EQ(0, sim.recorder.gapCnt[0] + sim.recorder.gapCnt[1]);
+	EXPECT_TRUE(sim.recorder.writeCsv(csv));
+
+	fuel.push_back(1000);
+	ford.push_back(1000);
+	EXPECT_TRUE(loadClocks(csv, 0) == fuel);
+	EXPECT_TRUE(loadClocks(csv, 1) == ford);
+	EXPECT_EQ(2115, decodeFile<SentProfileGmFuelPressure>(csv, 0));
+	EXPECT_EQ(1029, decodeFile<SentProfileFord>(csv, 1));
+
+	printf("Raw stream: %d + %d intervals in %d packets\r\n", (int)fuel.size(), (int)ford.size(), sim.decoder.packetCnt);
+}
+
+/* 115200 baud can not carry two channels: gaps are marked, frames around them are lost, none made up */
+static void testRawStreamSlowLine() {
+	const char *csv = "build/raw_stream_slow.csv";
+	std::vector<uint16_t> fuel = loadClocks(SENT_RECORDINGS_DIR "SENT-fuel-pressure.csv");
+	std::vector<uint16_t> ford = loadClocks(SENT_RECORDINGS_DIR "ford-sent-closed.csv");
+	static raw_stream_sim sim;
+	sim.clocks[0] = &fuel;
+	sim.clocks[1] = &ford;
+
+	simulateRawStream(sim, 500, 11520);
+
+	EXPECT_EQ(0, sim.decoder.badPacketCnt + sim.decoder.lostPacketCnt);
+	EXPECT_TRUE(sim.recorder.gapCnt[0] > 0);
+	EXPECT_TRUE(sim.recorder.lostCnt[0] > 0);
+	/* intervals recorded and known to be lost add up */
+	EXPECT_EQ(fuel.size() + 1, sim.recorder.intervalCnt[0] + sim.recorder.lostCnt[0]);
+	EXPECT_EQ(ford.size() + 1, sim.recorder.intervalCnt[1] + sim.recorder.lostCnt[1]);
+	EXPECT_TRUE(sim.recorder.writeCsv(csv));
+
+	int fuelFrames = decodeFile<SentProfileGmFuelPressure>(csv, 0);
+	int fordFrames = decodeFile<SentProfileFord>(csv, 1);
+	EXPECT_TRUE((fuelFrames > 0) && (fuelFrames < 2115));
+	EXPECT_TRUE((fordFrames > 0) && (fordFrames < 1029));
+
+	printf("Raw stream at 115200: %d gaps, %d intervals lost, %d + %d frames\r\n",
+		sim.recorder.gapCnt[0] + sim.recorder.gapCnt[1], sim.recorder.lostCnt[0] + sim.recorder.lostCnt[1],
+		fuelFrames, fordFrames);
+}
+
+/* Gap with nothing after it yet is not lost, first interval after it carries it */
+static void testRawStreamGapHeld() {
+	static SentRawStream<4> raw;
+	struct sent_edge edges[6];
+	uint16_t clocks[8];
+	uint32_t endTime, lost;
+	bool gap;
+
+	for (int i = 0; i < 6; i++) {
+		edges[i].time = 1000 * (i + 1);
+		edges[i].clocks = 1000;
+	}
+
+	/* disabled: nothing goes through */
+	raw.tap(edges, 2, 0);
+	EXPECT_EQ(0, raw.read(clocks, 8, &endTime, &gap, &lost));
+
+	/* enabled: starts with gap, 3 fit with marker, 3 lost */
+	raw.enable(true);
+	raw.tap(edges, 6, 0);
+	EXPECT_EQ(3, raw.read(clocks, 8, &endTime, &gap, &lost));
+	EXPECT_TRUE(gap);
+	EXPECT_EQ(0, lost);
+	EXPECT_EQ(3000, endTime);
+
+	/* capture ring dropped 2 more, then one edge */
+	edges[0].time = 9000;
+	raw.tap(edges, 1, 2);
+	EXPECT_EQ(1, raw.read(clocks, 8, &endTime, &gap, &lost));
+	EXPECT_TRUE(gap);
+	EXPECT_EQ(3 + 2, lost);
+	EXPECT_EQ(9000, endTime);
+
+	/* chunk stops before gap */
+	raw.tap(edges, 1, 2);
+	raw.enable(false);
+	raw.tap(edges, 1, 2);
+	raw.enable(true);
+	raw.tap(edges + 1, 1, 2);
+	EXPECT_EQ(1, raw.read(clocks, 8, &endTime, &gap, &lost));
+	EXPECT_TRUE(!gap);
+	EXPECT_EQ(0, raw.read(clocks, 0, &endTime, &gap, &lost));
+	EXPECT_EQ(1, raw.read(clocks, 8, &endTime, &gap, &lost));
+	EXPECT_TRUE(gap);
+	EXPECT_EQ(2000, endTime);
+}
+
+void testSentRawStream() {
+	testRawStreamGapHeld();
+	testRawStreamLossless();
+	testRawStreamSlowLine();
+}
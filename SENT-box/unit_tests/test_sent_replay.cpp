@@ -0,0 +1,204 @@
+/**
+ * @file test_sent_replay.cpp
+ *
+ * Replay of logic analyzer SENT captures through the firmware decoder
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "logicdata_interval_reader.h"
+#include "sent_decoder.h"
+#include "sent_test.h"
+#include "sent_test_helpers.h"
+
+struct sent_recording {
+	const char *fileName;
+	const char *profileName;
+	sent_batch_decoder decode;
+	/* expected decoder results, regression gate for decoder changes */
+	uint32_t frames;
+	uint32_t crcErrors;
+};
+
+#define PROFILE(profile) #profile, SENT_DecodeBatch<profile>
+
+static const sent_recording recordings[] = {
+	/* 3.25 uS tick is out of sync window of default SENT_TICK */
+	{ "SENT-ETB.csv", PROFILE(SentProfileDefault), 0, 0 },
+	/* glitches split some nibbles: frames they hit fail CRC */
+	{ "SENT-ETB.csv", PROFILE(SentProfileGmEtb), 578, 57 },
+	{ "SENT-fuel-pressure.csv", PROFILE(SentProfileDefault), 2115, 0 },
+	{ "SENT-fuel-pressure.csv", PROFILE(SentProfileGmFuelPressure), 2115, 0 },
+	{ "SENT-fuel-pressure.csv", PROFILE(SentProfileVariableLength), 2115, 0 },
+	/* pause pulses: default profile counts them as sync errors but still resyncs */
+	{ "ford-sent-closed.csv", PROFILE(SentProfileDefault), 1029, 0 },
+	{ "ford-sent-closed.csv", PROFILE(SentProfileFord), 1029, 0 },
+	{ "ford-sent-closed.csv", PROFILE(SentProfileVariableLength), 1029, 0 },
+	{ "ford-sent-idle.csv", PROFILE(SentProfileDefault), 778, 0 },
+	{ "ford-sent-idle.csv", PROFILE(SentProfileFord), 778, 0 },
+	/* glitch shortened frames end early and are checked as shorter frames */
+	{ "ford-sent-idle.csv", PROFILE(SentProfileVariableLength), 794, 15 },
+	/* same with tick tracked over frames: these captures have stable tick, nothing to gain */
+	{ "SENT-ETB.csv", PROFILE(SentProfileTracked<SentProfileGmEtb>), 578, 57 },
+	{ "SENT-fuel-pressure.csv", PROFILE(SentProfileTracked<SentProfileGmFuelPressure>), 2115, 0 },
+	{ "ford-sent-closed.csv", PROFILE(SentProfileTracked<SentProfileFord>), 1029, 0 },
+	{ "ford-sent-idle.csv", PROFILE(SentProfileTracked<SentProfileFord>), 778, 0 },
+	{ "ford-sent-idle.csv", PROFILE(SentProfileTracked<SentProfileVariableLength>), 794, 15 },
+};
+
+struct replay_state {
+	sent_batch_decoder decode;
+	struct sent_channel ch;
+	uint32_t okFrames;
+};
+
+static void countFrame(struct sent_channel_hot *ch, void *arg) {
+	(*(uint32_t *)arg)++;
+}
+
+static void decodeBatch(const uint16_t *clocks, size_t n, void *arg) {
+	replay_state *state = (replay_state *)arg;
+	uint32_t reported = 0;
+	int frames = state->decode(&state->ch, clocks, n, countFrame, &reported);
+	EXPECT_EQ(frames, reported);
+	state->okFrames += frames;
+}
+
+static void decodeAll(struct sent_channel *ch, const std::vector<uint16_t> &intervals, uint32_t *okFrames) {
+	for (uint16_t clocks : intervals) {
+		if (SENT_Decoder(ch, clocks) > 0) {
+			(*okFrames)++;
+		}
+	}
+}
+
+void testSentReplay() {
+	for (const sent_recording &rec : recordings) {
+		std::string fileName = std::string(SENT_RECORDINGS_DIR) + rec.fileName;
+
+		/* streaming, one pass, intervals are decoded batch by batch */
+		replay_state state;
+		memset(&state, 0, sizeof(state));
+		state.decode = rec.decode;
+		IntervalReader r;
+		EXPECT_TRUE(r.open(fileName.c_str()));
+		size_t count = r.readAll(decodeBatch, &state);
+		EXPECT_TRUE(count > 0);
+
+		struct sent_channel &ch = state.ch;
+		printf("%s %s: lines %d pulses %d frames %d ok %d crc %d sync %d short %d long %d\r\n",
+			rec.fileName, rec.profileName, r.lineIndex(), ch.PulseCnt, ch.FrameCnt, state.okFrames, ch.CrcErrCnt, ch.SyncErr,
+			ch.ShortIntervalErr, ch.LongIntervalErr);
+
+		EXPECT_EQ(count, ch.PulseCnt);
+		EXPECT_EQ(ch.FrameCnt - ch.CrcErrCnt, state.okFrames);
+		EXPECT_EQ(rec.frames, ch.FrameCnt);
+		EXPECT_EQ(rec.crcErrors, ch.CrcErrCnt);
+	}
+}
+
+void benchmarkSentReplay() {
+	for (const sent_recording &rec : recordings) {
+		std::string fileName = std::string(SENT_RECORDINGS_DIR) + rec.fileName;
+		std::vector<uint16_t> intervals;
+		sentLoadRecording(fileName.c_str(), intervals);
+
+		uint64_t pulses = 0;
+		uint32_t okFrames = 0;
+		auto start = std::chrono::steady_clock::now();
+		std::chrono::duration<double> elapsed;
+		/* repeat the capture until we have a measurable amount of time */
+		do {
+			struct sent_channel ch;
+			memset(&ch, 0, sizeof(ch));
+			decodeAll(&ch, intervals, &okFrames);
+			pulses += intervals.size();
+			elapsed = std::chrono::steady_clock::now() - start;
+		} while (elapsed.count() < 0.2);
+
+		printf("BENCH %s: %.1f ns/pulse, %.0f frames/s\r\n", rec.fileName,
+			elapsed.count() * 1e9 / pulses, okFrames / elapsed.count());
+	}
+}
+
+void benchmarkSentStreaming() {
+	for (const sent_recording &rec : recordings) {
+		std::string fileName = std::string(SENT_RECORDINGS_DIR) + rec.fileName;
+
+		replay_state state;
+		memset(&state, 0, sizeof(state));
+		state.decode = rec.decode;
+		auto start = std::chrono::steady_clock::now();
+		IntervalReader r;
+		r.open(fileName.c_str());
+		size_t count = r.readAll(decodeBatch, &state);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		printf("BENCH streaming %s: %d lines, %.0f lines/s, %.1f ns/pulse including parsing\r\n", rec.fileName,
+			r.lineIndex(), r.lineIndex() / elapsed.count(), elapsed.count() * 1e9 / count);
+	}
+}
+
+void benchmarkSentBatch() {
+	std::vector<uint16_t> intervals;
+	sentLoadRecording(SENT_RECORDINGS_DIR "SENT-fuel-pressure.csv", intervals);
+
+	for (size_t batchSize = 1; batchSize <= 256; batchSize *= 2) {
+		uint64_t pulses = 0;
+		auto start = std::chrono::steady_clock::now();
+		std::chrono::duration<double> elapsed;
+		do {
+			struct sent_channel ch;
+			memset(&ch, 0, sizeof(ch));
+			for (size_t i = 0; i < intervals.size(); i += batchSize) {
+				size_t n = std::min(batchSize, intervals.size() - i);
+				SENT_DecodeBatch(&ch, intervals.data() + i, n, nullptr, nullptr);
+			}
+			pulses += intervals.size();
+			elapsed = std::chrono::steady_clock::now() - start;
+		} while (elapsed.count() < 0.1);
+
+		printf("BENCH batch %3d: %.1f ns/pulse\r\n", (int)batchSize, elapsed.count() * 1e9 / pulses);
+	}
+}
+
+/* Cost of tick tracking: one division per frame and per sync */
+void benchmarkSentTickTracking() {
+	const struct {
+		const char *fileName;
+		sent_batch_decoder plain;
+		sent_batch_decoder tracked;
+	} cases[] = {
+		{ "SENT-fuel-pressure.csv", SENT_DecodeBatch<SentProfileGmFuelPressure>,
+			SENT_DecodeBatch<SentProfileTracked<SentProfileGmFuelPressure>> },
+		{ "ford-sent-closed.csv", SENT_DecodeBatch<SentProfileFord>,
+			SENT_DecodeBatch<SentProfileTracked<SentProfileFord>> },
+	};
+
+	for (const auto &c : cases) {
+		std::string fileName = std::string(SENT_RECORDINGS_DIR) + c.fileName;
+		std::vector<uint16_t> intervals;
+		sentLoadRecording(fileName.c_str(), intervals);
+
+		double ns[2];
+		for (int t = 0; t < 2; t++) {
+			uint64_t pulses = 0;
+			auto start = std::chrono::steady_clock::now();
+			std::chrono::duration<double> elapsed;
+			do {
+				struct sent_channel ch;
+				memset(&ch, 0, sizeof(ch));
+				(t ? c.tracked : c.plain)(&ch, intervals.data(), intervals.size(), nullptr, nullptr);
+				pulses += intervals.size();
+				elapsed = std::chrono::steady_clock::now() - start;
+			} while (elapsed.count() < 0.1);
+			ns[t] = elapsed.count() * 1e9 / pulses;
+		}
+
+		printf("BENCH tick tracking %s: %.1f ns/pulse, tracked %.1f ns/pulse\r\n", c.fileName, ns[0], ns[1]);
+	}
+}
@@ -0,0 +1,254 @@
+/**
+ * @file test_sent_slow_channel.cpp
+ *
+ * Slow channel: short and enhanced serial messages, CRC, mailbox table
+ */
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include "logicdata_interval_reader.h"
+#include "sent_decoder.h"
+#include "sent_test.h"
+
+/* 2.7 uS at 72 MHz, rounded */
+#define TEST_TICK 194
+
+/* frame with given status nibble, fixed data, recommended CRC */
+static void appendStatusFrame(std::vector<uint16_t> &pulses, uint8_t status) {
+	uint8_t data[SENT_MSG_DATA_SIZE] = { 1, 2, 3, 4, 5, 6 };
+
+	pulses.push_back(56 * TEST_TICK);
+	pulses.push_back((SENT_OFFSET_INTERVAL + status) * TEST_TICK);
+	for (int i = 0; i < SENT_MSG_DATA_SIZE; i++) {
+		pulses.push_back((SENT_OFFSET_INTERVAL + data[i]) * TEST_TICK);
+	}
+	pulses.push_back((SENT_OFFSET_INTERVAL + sent_crc4_gm(data, SENT_MSG_DATA_SIZE)) * TEST_TICK);
+}
+
+/* bit 3 and bit 2 of status nibble, MSB first, n frames */
+static void appendSerialBits(std::vector<uint16_t> &pulses, uint32_t bits3, uint32_t bits2, int n) {
+	for (int i = n - 1; i >= 0; i--) {
+		appendStatusFrame(pulses, (((bits3 >> i) & 1) << 3) | (((bits2 >> i) & 1) << 2));
+	}
+}
+
+static void appendShortMessage(std::vector<uint16_t> &pulses, uint8_t id, uint8_t data, uint8_t crcError = 0) {
+	uint8_t msg[3] = { id, (uint8_t)(data >> 4), (uint8_t)(data & 0x0f) };
+	uint8_t crc = sent_crc4_gm(msg, 3) ^ crcError;
+
+	appendSerialBits(pulses, 0x8000, (id << 12) | (data << 4) | crc, 16);
+}
+
+static void appendEnhancedMessage(std::vector<uint16_t> &pulses, bool bits16, uint8_t id, uint16_t data, uint8_t crcError = 0) {
+	uint32_t bits3 = 0x3f000;
+
+	if (bits16) {
+		bits3 |= (1 << 10) | ((id & 0x0f) << 6) | (((data >> 12) & 0x0f) << 1);
+	} else {
+		bits3 |= ((id >> 4) << 6) | ((id & 0x0f) << 1);
+	}
+	uint32_t crc = sent_crc6(data & 0x0fff, bits3 & 0x0fff) ^ crcError;
+
+	appendSerialBits(pulses, bits3, (crc << 12) | (data & 0x0fff), 18);
+}
+
+static void decodeSlow(struct sent_channel *ch, const std::vector<uint16_t> &pulses) {
+	SENT_DecodeBatch<SentProfileGmFuelPressure>(ch, pulses.data(), pulses.size(), nullptr, nullptr);
+	/* message is done with its last frame, which is done with next sync */
+	uint16_t sync = 56 * TEST_TICK;
+	SENT_DecodeBatch<SentProfileGmFuelPressure>(ch, &sync, 1, nullptr, nullptr);
+}
+
+static const struct sent_slow_msg *findMsg(const struct sent_channel &ch, sent_slow_format format, uint8_t id) {
+	int i = SENT_SlowMsgFind(&ch, format, id);
+	return (i < 0) ? nullptr : &ch.scMsg[i];
+}
+
+static void testShortMessages() {
+	static struct sent_channel ch;
+	std::vector<uint16_t> pulses;
+
+	memset(&ch, 0, sizeof(ch));
+	appendShortMessage(pulses, 1, 0xa5);
+	appendShortMessage(pulses, 15, 0x3c);
+	appendShortMessage(pulses, 1, 0xa6);
+	/* bad CRC: not stored */
+	appendShortMessage(pulses, 2, 0x11, 0x4);
+	decodeSlow(&ch, pulses);
+
+	const struct sent_slow_msg *msg = findMsg(ch, SENT_SLOW_SHORT, 1);
+	EXPECT_TRUE(msg != nullptr);
+	if (msg) {
+		EXPECT_EQ(0xa6, msg->data);
+		EXPECT_EQ(2, msg->count);
+		EXPECT_TRUE(msg->time != 0);
+	}
+	msg = findMsg(ch, SENT_SLOW_SHORT, 15);
+	EXPECT_TRUE(msg != nullptr);
+	if (msg) {
+		EXPECT_EQ(0x3c, msg->data);
+		EXPECT_EQ(1, msg->count);
+	}
+	EXPECT_TRUE(findMsg(ch, SENT_SLOW_SHORT, 2) == nullptr);
+	EXPECT_EQ(1, ch.ScCrcErrCnt);
+	EXPECT_EQ(3, ch.scMsgSeq);
+	EXPECT_EQ(0, ch.CrcErrCnt);
+}
+
+static void testEnhancedMessages() {
+	static struct sent_channel ch;
+	std::vector<uint16_t> pulses;
+
+	/* from SENT-fuel-pressure recording: bit 3 0x3f04c, bit 2 0x222f7 */
+	EXPECT_EQ(0x22, sent_crc6(0x2f7, 0x04c));
+
+	memset(&ch, 0, sizeof(ch));
+	appendEnhancedMessage(pulses, false, 0x5a, 0xabc);
+	appendEnhancedMessage(pulses, true, 3, 0xbeef);
+	/* same ID as above in other formats is other message */
+	appendEnhancedMessage(pulses, false, 3, 0x123);
+	appendShortMessage(pulses, 3, 0x45);
+	appendEnhancedMessage(pulses, true, 4, 0x1111, 0x20);
+	decodeSlow(&ch, pulses);
+
+	const struct sent_slow_msg *msg = findMsg(ch, SENT_SLOW_ENHANCED_12, 0x5a);
+	EXPECT_TRUE((msg != nullptr) && (msg->data == 0xabc));
+	msg = findMsg(ch, SENT_SLOW_ENHANCED_16, 3);
+	EXPECT_TRUE((msg != nullptr) && (msg->data == 0xbeef));
+	msg = findMsg(ch, SENT_SLOW_ENHANCED_12, 3);
+	EXPECT_TRUE((msg != nullptr) && (msg->data == 0x123));
+	msg = findMsg(ch, SENT_SLOW_SHORT, 3);
+	EXPECT_TRUE((msg != nullptr) && (msg->data == 0x45));
+	EXPECT_TRUE(findMsg(ch, SENT_SLOW_ENHANCED_16, 4) == nullptr);
+	EXPECT_EQ(1, ch.ScCrcErrCnt);
+	EXPECT_EQ(4, ch.scMsgSeq);
+}
+
+/* More IDs than slots: new ID always gets a slot, silent IDs age out */
+static void testSlowTableAging() {
+	static struct sent_channel ch;
+	memset(&ch, 0, sizeof(ch));
+
+	uint32_t missing = 0;
+	for (uint32_t i = 0; i < 1000; i++) {
+		uint8_t id = (i * 7) % 40;
+		SENT_SlowMsgStore(&ch, SENT_SLOW_ENHANCED_12, id, i, ch.frameSyncTime);
+		const struct sent_slow_msg *msg = findMsg(ch, SENT_SLOW_ENHANCED_12, id);
+		if ((msg == nullptr) || (msg->data != i)) {
+			missing++;
+		}
+	}
+	EXPECT_EQ(0, missing);
+	EXPECT_TRUE(ch.ScEvictCnt > 0);
+
+	/* 8 IDs fit, none is evicted once they are in */
+	memset(&ch, 0, sizeof(ch));
+	for (uint32_t i = 0; i < 1000; i++) {
+		SENT_SlowMsgStore(&ch, SENT_SLOW_ENHANCED_12, 0x10 + (i % 8), i, ch.frameSyncTime);
+	}
+	EXPECT_EQ(0, ch.ScEvictCnt);
+	for (uint8_t id = 0x10; id < 0x18; id++) {
+		const struct sent_slow_msg *msg = findMsg(ch, SENT_SLOW_ENHANCED_12, id);
+		EXPECT_TRUE((msg != nullptr) && (msg->count == 125));
+	}
+
+	/* 0x10 stops coming: gone after max age, slot is free again */
+	for (uint32_t i = 0; i < SENT_SLOW_MSG_MAX_AGE + SENT_SLOW_MSG_SLOTS; i++) {
+		SENT_SlowMsgStore(&ch, SENT_SLOW_ENHANCED_12, 0x11 + (i % 7), i, ch.frameSyncTime);
+	}
+	EXPECT_TRUE(findMsg(ch, SENT_SLOW_ENHANCED_12, 0x10) == nullptr);
+	EXPECT_TRUE(findMsg(ch, SENT_SLOW_ENHANCED_12, 0x11) != nullptr);
+	EXPECT_EQ(7, __builtin_popcount(ch.scMsgFlags));
+}
+
+static void decodeBatch(const uint16_t *clocks, size_t n, void *arg) {
+	struct sent_channel *ch = (struct sent_channel *)arg;
+	SENT_DecodeBatch<SentProfileGmFuelPressure>(ch, clocks, n, nullptr, nullptr);
+}
+
+static void decodeBatchFord(const uint16_t *clocks, size_t n, void *arg) {
+	struct sent_channel *ch = (struct sent_channel *)arg;
+	SENT_DecodeBatch<SentProfileFord>(ch, clocks, n, nullptr, nullptr);
+}
+
+/* All enhanced messages of recordings pass CRC */
+static void testSlowChannelRecordings() {
+	const struct {
+		const char *fileName;
+		interval_batch_cb decode;
+		uint32_t messages;
+	} recordings[] = {
+		{ SENT_RECORDINGS_DIR "SENT-fuel-pressure.csv", decodeBatch, 116 },
+		{ SENT_RECORDINGS_DIR "ford-sent-closed.csv", decodeBatchFord, 8 },
+	};
+
+	for (const auto &rec : recordings) {
+		static struct sent_channel ch;
+		memset(&ch, 0, sizeof(ch));
+
+		IntervalReader r;
+		r.open(rec.fileName);
+		r.readAll(rec.decode, &ch);
+
+		EXPECT_EQ(rec.messages, ch.scMsgSeq);
+		EXPECT_EQ(0, ch.ScCrcErrCnt);
+		EXPECT_EQ(0, ch.ScEvictCnt);
+		for (int i = 0; i < SENT_SLOW_MSG_SLOTS; i++) {
+			if (ch.scMsgFlags & (1 << i)) {
+				printf("  slow msg format %d id %d: 0x%03x, %d times\r\n",
+					ch.scMsg[i].format, ch.scMsg[i].id, ch.scMsg[i].data, ch.scMsg[i].count);
+			}
+		}
+	}
+}
+
+void testSentSlowChannel() {
+	testShortMessages();
+	testEnhancedMessages();
+	testSlowTableAging();
+	testSlowChannelRecordings();
+}
+
+/* Previous mailbox: linear scan for same ID or free slot, never freed */
+static void linearStore(struct sent_channel *ch, uint8_t id, uint16_t data) {
+	for (int i = 0; i < 16; i++) {
+		if (((ch->scMsgFlags & (1 << i)) == 0) || (ch->scMsg[i].id == id)) {
+			ch->scMsg[i].data = data;
+			ch->scMsg[i].id = id;
+			ch->scMsgFlags |= (1 << i);
+			return;
+		}
+	}
+}
+
+template <typename Store>
+static double benchmarkStore(uint32_t ids, Store store) {
+	static struct sent_channel ch;
+	uint64_t updates = 0;
+
+	memset(&ch, 0, sizeof(ch));
+	auto start = std::chrono::steady_clock::now();
+	std::chrono::duration<double> elapsed;
+	do {
+		for (uint32_t i = 0; i < 1024; i++) {
+			store(&ch, (uint8_t)(0x40 + (i * 7) % ids), (uint16_t)i);
+		}
+		updates += 1024;
+		elapsed = std::chrono::steady_clock::now() - start;
+	} while (elapsed.count() < 0.1);
+
+	return elapsed.count() * 1e9 / updates;
+}
+
+void benchmarkSentSlowChannel() {
+	auto hashed = [](struct sent_channel *ch, uint8_t id, uint16_t data) {
+		SENT_SlowMsgStore(ch, SENT_SLOW_ENHANCED_12, id, data, ch->frameSyncTime);
+	};
+
+	for (uint32_t ids : { 4, 16, 40 }) {
+		printf("BENCH slow channel table, %d IDs: linear %.2f ns/update, hashed %.2f ns/update\r\n",
+			ids, benchmarkStore(ids, linearStore), benchmarkStore(ids, hashed));
+	}
+}
@@ -0,0 +1,95 @@
+/**
+ * @file test_sent_spsc_ring.cpp
+ *
+ * ISR to decoder thread interval ring tests
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "sent_spsc_ring.h"
+#include "sent_test.h"
+
+static void testSpscRingSingleThread() {
+	SentSpscRing<uint16_t, 4> ring;
+	uint16_t out[8];
+
+	EXPECT_TRUE(ring.isEmpty());
+	/* only empty to non-empty transition asks for wakeup */
+	EXPECT_TRUE(ring.push(1));
+	EXPECT_TRUE(!ring.push(2));
+	EXPECT_TRUE(!ring.push(3));
+	EXPECT_TRUE(!ring.push(4));
+	/* full, dropped and counted */
+	EXPECT_TRUE(!ring.push(5));
+	EXPECT_EQ(1, ring.getOverflowCnt());
+
+	EXPECT_EQ(2, ring.pop(out, 2));
+	EXPECT_EQ(1, out[0]);
+	EXPECT_EQ(2, out[1]);
+	EXPECT_TRUE(!ring.push(6));
+	EXPECT_EQ(3, ring.pop(out, 8));
+	EXPECT_EQ(3, out[0]);
+	EXPECT_EQ(4, out[1]);
+	EXPECT_EQ(6, out[2]);
+	EXPECT_TRUE(ring.isEmpty());
+	EXPECT_EQ(0, ring.pop(out, 8));
+
+	EXPECT_TRUE(ring.push(7));
+	EXPECT_EQ(1, ring.getOverflowCnt());
+}
+
+/* Producer and consumer threads hammer the ring, producer retries on full so
+ * every value must arrive exactly once and in order */
+static void testSpscRingStress() {
+	static SentSpscRing<uint16_t, 64> ring;
+	const uint32_t total = 200000;
+	std::atomic<uint32_t> wakeups{0};
+
+	std::thread producer([&]() {
+		for (uint32_t i = 0; i < total; i++) {
+			uint32_t overflows = ring.getOverflowCnt();
+			bool wake;
+			while (!(wake = ring.push((uint16_t)i)) && ring.getOverflowCnt() != overflows) {
+				/* full - retry, as if ISR came again later */
+				overflows = ring.getOverflowCnt();
+				std::this_thread::yield();
+			}
+			if (wake) {
+				wakeups++;
+			}
+		}
+	});
+
+	uint32_t expected = 0;
+	uint32_t errors = 0;
+	uint16_t batch[64];
+	while (expected < total) {
+		size_t n = ring.pop(batch, 64);
+		if (n == 0) {
+			/* let producer run on single core hosts */
+			std::this_thread::yield();
+		}
+		for (size_t i = 0; i < n; i++) {
+			if (batch[i] != (uint16_t)expected) {
+				errors++;
+			}
+			expected++;
+		}
+	}
+	producer.join();
+
+	EXPECT_EQ(0, errors);
+	EXPECT_EQ(total, expected);
+	EXPECT_TRUE(ring.isEmpty());
+	/* wakeups are only sent on transitions */
+	EXPECT_TRUE(wakeups.load() >= 1);
+	EXPECT_TRUE(wakeups.load() <= total);
+	printf("SPSC stress: %d values, %d wakeups, %d retries on full\r\n", total, wakeups.load(), ring.getOverflowCnt());
+}
+
+void testSentSpscRing() {
+	testSpscRingSingleThread();
+	testSpscRingStress();
+}
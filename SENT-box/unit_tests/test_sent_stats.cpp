@@ -0,0 +1,171 @@
+/**
+ * @file test_sent_stats.cpp
+ *
+ * Decoder statistic snapshot: consistent copies under concurrent publish,
+ * sliding window rates and their edge cases
+ */
+
+#include <atomic>
+#include <thread>
+
+#include "sent_can.h"
+#include "sent_stats.h"
+#include "sent_test.h"
+
+#define MS_CLOCKS	(1000 * SENT_TIMER_CLOCK_MHZ)
+
+/* every counter derived from i, so mix of two publishes is visible */
+static struct sent_channel_stats makeStats(uint32_t i) {
+	struct sent_channel_stats stats = {};
+	stats.tickNs = 3000 + (i & 0xff);
+	stats.pulseCnt = i * 9;
+	stats.frameCnt = i;
+	stats.crcErr = i / 2;
+	stats.syncErr = i / 3;
+	stats.lostFrames = i / 4;
+	stats.intervalOverflow = ~i;
+	return stats;
+}
+
+static bool isConsistent(const struct sent_channel_stats &s) {
+	uint32_t i = s.frameCnt;
+	return (s.tickNs == 3000 + (i & 0xff)) && (s.pulseCnt == i * 9) && (s.crcErr == i / 2) &&
+		(s.syncErr == i / 3) && (s.lostFrames == i / 4) && (s.intervalOverflow == ~i);
+}
+
+static void testStatsSnapshot() {
+	SentStatsBlock<> block;
+	struct sent_channel_stats stats;
+
+	EXPECT_TRUE(!block.read(&stats));
+
+	block.publish(makeStats(10), 0x12345678);
+	EXPECT_TRUE(block.read(&stats));
+	EXPECT_TRUE(isConsistent(stats));
+	EXPECT_EQ(10, stats.frameCnt);
+	/* nothing to take rate over yet */
+	EXPECT_EQ(0, stats.frameRate);
+	EXPECT_EQ(0, stats.errRate);
+
+	/* same time again: no division by zero */
+	block.publish(makeStats(20), 0x12345678);
+	EXPECT_TRUE(block.read(&stats));
+	EXPECT_EQ(20, stats.frameCnt);
+	EXPECT_EQ(0, stats.frameRate);
+	EXPECT_EQ(2, block.publishCnt());
+
+	EXPECT_EQ(0, SENT_StatsPercent(5, 0));
+	EXPECT_EQ(50, SENT_StatsPercent(5, 10));
+	EXPECT_EQ(100, SENT_StatsPercent(0xffffffff, 0xffffffff));
+}
+
+/* Sensor at 500 frames/s, 1 of 10 frames with error, 1 of 20 lost, published every 10 mS */
+static void testStatsRates() {
+	SentStatsBlock<> block;
+	struct sent_channel_stats in = {};
+	struct sent_channel_stats out;
+	/* counter wraps during test */
+	uint32_t now = 0xffffffff - 1000 * MS_CLOCKS;
+	uint32_t frames = 0;
+
+	for (int ms = 0; ms < 3000; ms += 10, now += 10 * MS_CLOCKS) {
+		block.publish(in, now);
+		for (int i = 0; i < 5; i++, frames++) {
+			in.frameCnt++;
+			if ((frames % 10) == 0) {
+				in.crcErr++;
+			}
+			if ((frames % 20) == 0) {
+				in.lostFrames++;
+			}
+		}
+	}
+	block.read(&out);
+	EXPECT_TRUE((out.frameRate >= 490) && (out.frameRate <= 510));
+	EXPECT_TRUE((out.errRate >= 45) && (out.errRate <= 55));
+	EXPECT_TRUE((out.lostRate >= 20) && (out.lostRate <= 30));
+
+	/* sensor disconnected: rates drop to 0 once window is past last frame */
+	for (int ms = 0; ms < 2000; ms += 10, now += 10 * MS_CLOCKS) {
+		block.publish(in, now);
+	}
+	block.read(&out);
+	EXPECT_EQ(0, out.frameRate);
+	EXPECT_EQ(0, out.errRate);
+	EXPECT_EQ(0, out.lostRate);
+	EXPECT_EQ(in.frameCnt, out.frameCnt);
+
+	/* decoder reset: counters going back are not a huge rate */
+	in = {};
+	in.frameCnt = 3;
+	block.publish(in, now);
+	now += 10 * MS_CLOCKS;
+	in.frameCnt = 8;
+	block.publish(in, now);
+	block.read(&out);
+	EXPECT_EQ(500, out.frameRate);
+}
+
+/* Reader never gets snapshot mixed from two publishes */
+static void testStatsConcurrent() {
+	static SentStatsBlock<> block;
+	const uint32_t total = 200000;
+	std::atomic<bool> done{false};
+	uint32_t torn = 0;
+	uint32_t reads = 0;
+	uint32_t last = 0;
+	uint32_t backwards = 0;
+
+	std::thread writer([&]() {
+		for (uint32_t i = 1; i <= total; i++) {
+			block.publish(makeStats(i), i * MS_CLOCKS);
+			if ((i % 64) == 0) {
+				std::this_thread::yield();
+			}
+		}
+		done = true;
+	});
+
+	while (!done) {
+		struct sent_channel_stats stats;
+		if (block.read(&stats)) {
+			reads++;
+			if (!isConsistent(stats)) {
+				torn++;
+			}
+			if (stats.frameCnt < last) {
+				backwards++;
+			}
+			last = stats.frameCnt;
+		}
+	}
+	writer.join();
+
+	EXPECT_EQ(0, torn);
+	EXPECT_EQ(0, backwards);
+	EXPECT_EQ(total, block.publishCnt());
+	printf("Stats block: %d consistent reads while publishing\r\n", reads);
+}
+
+static void testCanStatsFrame() {
+	struct sent_channel_stats stats = {};
+	uint8_t data[SENT_CAN_DLC];
+
+	stats.frameRate = 0x1234;
+	stats.errRate = 0x12345;
+	stats.lostRate = 7;
+	stats.tickNs = 2700;
+	SENT_CanPackStats(&stats, data);
+
+	const uint8_t expected[SENT_CAN_DLC] = { 0x34, 0x12, 0xff, 0xff, 7, 0, 2700 & 0xff, 2700 >> 8 };
+	for (int i = 0; i < SENT_CAN_DLC; i++) {
+		EXPECT_EQ(expected[i], data[i]);
+	}
+}
+
+void testSentStats() {
+	testStatsSnapshot();
+	testStatsRates();
+	testStatsConcurrent();
+	testCanStatsFrame();
+}
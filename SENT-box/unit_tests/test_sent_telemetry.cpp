@@ -0,0 +1,260 @@
+/**
+ * @file test_sent_telemetry.cpp
+ *
+ * Binary telemetry: firmware packet builders against host side decoder
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "logicdata_interval_reader.h"
+#include "sent_decoder.h"
+#include "sent_telemetry.h"
+#include "sent_telemetry_decoder.h"
+#include "sent_test.h"
+
+/* COBS and CRC on arbitrary payloads, including zero runs and blocks longer than 254 */
+static void testTelemetryFraming() {
+	srand(12);
+	uint32_t bad = 0;
+
+	for (size_t n = 0; n < 700; n++) {
+		std::vector<uint8_t> payload(n + 2);
+		std::vector<uint8_t> out(n + 2 + n / 254 + 2);
+		std::vector<uint8_t> back(n + 2);
+
+		for (size_t i = 0; i < n; i++) {
+			/* mostly non zero to get long COBS blocks, some zero runs */
+			payload[i] = (n % 3 == 0) ? 0 : ((rand() % 16) ? (rand() % 255) + 1 : 0);
+		}
+		std::vector<uint8_t> orig(payload.begin(), payload.begin() + n);
+
+		size_t len = SENT_TlmEncode(payload.data(), n, out.data());
+		bool delimOnlyAtEnd = (len <= out.size()) && (out[len - 1] == 0) &&
+			(memchr(out.data(), 0, len - 1) == nullptr);
+		size_t decoded = sentTlmCobsDecode(out.data(), len - 1, back.data());
+
+		if ((!delimOnlyAtEnd) || (decoded != n + 2) ||
+			(memcmp(back.data(), orig.data(), n) != 0) ||
+			(SENT_TlmCrc16(back.data(), n) != (back[n] | (back[n + 1] << 8)))) {
+			bad++;
+		}
+	}
+	EXPECT_EQ(0, bad);
+
+	/* CRC16-CCITT (0xffff) check value */
+	EXPECT_EQ(0x29b1, SENT_TlmCrc16((const uint8_t *)"123456789", 9));
+}
+
+struct tlm_replay {
+	struct sent_channel ch;
+	uint8_t seq;
+	uint32_t frames;
+	std::vector<uint8_t> stream;
+	/* what was sent, in order */
+	std::vector<sent_tlm_packet> sent;
+};
+
+static void sendPacket(tlm_replay *r, uint8_t *payload, size_t n) {
+	uint8_t out[SENT_TLM_MAX_PACKET];
+	sent_tlm_packet packet;
+
+	EXPECT_TRUE(n <= SENT_TLM_MAX_PAYLOAD);
+	EXPECT_TRUE(sentTlmParse(payload, n, &packet));
+	r->sent.push_back(packet);
+
+	size_t len = SENT_TlmEncode(payload, n, out);
+	EXPECT_TRUE(len <= SENT_TLM_MAX_PACKET);
+	r->stream.insert(r->stream.end(), out, out + len);
+}
+
+static void tlmOnFrame(struct sent_channel_hot *, void *arg) {
+	tlm_replay *r = (tlm_replay *)arg;
+	struct sent_channel *ch = &r->ch;
+	uint8_t payload[SENT_TLM_MAX_PAYLOAD + 2];
+	struct sent_tlm_frame frames[2];
+
+	r->frames++;
+	frames[0].seq = r->frames;
+	frames[0].syncTime = ch->frameSyncTime;
+	memcpy(frames[0].nibbles, ch->nibbles, sizeof(frames[0].nibbles));
+	frames[0].sig0 = (ch->nibbles[1] << 8) | (ch->nibbles[2] << 4) | ch->nibbles[3];
+	frames[0].sig1 = ch->nibbles[4] | (ch->nibbles[5] << 4) | (ch->nibbles[6] << 8);
+	/* second channel as Si7215 would look like: negative signal */
+	frames[1] = frames[0];
+	frames[1].sig0 = frames[0].sig0 - 2048;
+	sendPacket(r, payload, SENT_TlmPackFrames(r->seq++, ch->edgeTime, frames, 2, payload));
+
+	if ((r->frames % 100) == 0) {
+		struct sent_channel_stats stats = {};
+		stats.tickNs = ch->tickClocks * 1000 / SENT_TIMER_CLOCK_MHZ;
+		stats.pulseCnt = ch->PulseCnt;
+		stats.shortIntervalErr = ch->ShortIntervalErr;
+		stats.longIntervalErr = ch->LongIntervalErr;
+		stats.syncErr = ch->SyncErr;
+		stats.crcErr = ch->CrcErrCnt;
+		stats.frameCnt = ch->FrameCnt;
+		stats.intervalOverflow = 0xdeadbeef;
+		stats.lostFrames = ch->LostFrameCnt;
+		stats.frameRate = r->frames % 1000;
+		stats.errRate = 0xffff;
+		stats.lostRate = 1;
+		sendPacket(r, payload, SENT_TlmPackStats(r->seq++, ch->edgeTime, &stats, 1, payload));
+
+		/* by ID as firmware does, see UartPackSlow() */
+		struct sent_tlm_slow slow = {};
+		for (uint32_t format = 0; format < SENT_SLOW_FORMATS; format++) {
+			for (uint32_t id = 0; id < SENT_SlowIdCount((sent_slow_format)format); id++) {
+				int i = SENT_SlowMsgFind(ch, (sent_slow_format)format, id);
+				if (i >= 0) {
+					slow.msg[slow.count++] = ch->scMsg[i];
+				}
+			}
+		}
+		sendPacket(r, payload, SENT_TlmPackSlow(r->seq++, ch->edgeTime, 0, &slow, payload));
+	}
+}
+
+static void tlmBatch(const uint16_t *clocks, size_t n, void *arg) {
+	tlm_replay *r = (tlm_replay *)arg;
+	SENT_DecodeBatch<SentProfileGmFuelPressure>(&r->ch, clocks, n, tlmOnFrame, r);
+}
+
+static bool samePacket(const sent_tlm_packet &a, const sent_tlm_packet &b) {
+	if ((a.type != b.type) || (a.seq != b.seq) || (a.time != b.time) || (a.channels != b.channels)) {
+		return false;
+	}
+	for (uint32_t i = 0; i < a.channels; i++) {
+		const sent_tlm_frame &fa = a.frames[i];
+		const sent_tlm_frame &fb = b.frames[i];
+		if ((fa.seq != fb.seq) || (fa.syncTime != fb.syncTime) || (fa.sig0 != fb.sig0) || (fa.sig1 != fb.sig1) ||
+			(memcmp(fa.nibbles, fb.nibbles, sizeof(fa.nibbles)) != 0) ||
+			(memcmp(&a.stats[i], &b.stats[i], sizeof(a.stats[i])) != 0)) {
+			return false;
+		}
+	}
+	if (a.type == SENT_TLM_SLOW) {
+		if ((a.slowChannel != b.slowChannel) || (a.slow.count != b.slow.count)) {
+			return false;
+		}
+		for (uint32_t i = 0; i < a.slow.count; i++) {
+			const sent_slow_msg &ma = a.slow.msg[i];
+			const sent_slow_msg &mb = b.slow.msg[i];
+			if ((ma.format != mb.format) || (ma.id != mb.id) || (ma.data != mb.data) ||
+				(ma.time != mb.time) || (ma.count != mb.count)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+struct tlm_check {
+	const std::vector<sent_tlm_packet> *sent;
+	size_t next;
+	uint32_t mismatches;
+	/* sent packets expected to be lost */
+	size_t skipAt;
+};
+
+static void onTlmPacket(const struct sent_tlm_packet *packet, void *arg) {
+	tlm_check *c = (tlm_check *)arg;
+	if (c->next == c->skipAt) {
+		c->next++;
+	}
+	if ((c->next >= c->sent->size()) || (!samePacket((*c->sent)[c->next], *packet))) {
+		c->mismatches++;
+	}
+	c->next++;
+}
+
+/* Recording decoded, sent as telemetry stream in random sized chunks and decoded back */
+static void testTelemetryRoundTrip() {
+	static tlm_replay r;
+	memset(&r.ch, 0, sizeof(r.ch));
+	r.seq = 0;
+	r.frames = 0;
+
+	IntervalReader reader;
+	reader.open(SENT_RECORDINGS_DIR "SENT-fuel-pressure.csv");
+	reader.readAll(tlmBatch, &r);
+	EXPECT_EQ(2115, r.frames);
+
+	uint32_t slowWithData = 0;
+	uint32_t slowRepeated = 0;
+	for (const sent_tlm_packet &p : r.sent) {
+		if ((p.type == SENT_TLM_SLOW) && (p.slow.count)) {
+			slowWithData++;
+			for (uint32_t i = 0; i < p.slow.count; i++) {
+				/* sorted by format then ID */
+				if (i > 0) {
+					const sent_slow_msg &prev = p.slow.msg[i - 1];
+					const sent_slow_msg &msg = p.slow.msg[i];
+					EXPECT_TRUE((prev.format < msg.format) || ((prev.format == msg.format) && (prev.id < msg.id)));
+				}
+				if (p.slow.msg[i].count > 1) {
+					slowRepeated++;
+				}
+			}
+		}
+	}
+	EXPECT_TRUE(slowWithData > 0);
+	EXPECT_TRUE(slowRepeated > 0);
+
+	/* garbage before first delimiter is dropped as bad packet */
+	std::vector<uint8_t> stream = { 0x12, 0x34, 0x00 };
+	stream.insert(stream.end(), r.stream.begin(), r.stream.end());
+
+	TelemetryDecoder decoder;
+	tlm_check check = { &r.sent, 0, 0, (size_t)-1 };
+	srand(5);
+	for (size_t i = 0; i < stream.size(); ) {
+		size_t chunk = std::min((size_t)(rand() % 100), stream.size() - i);
+		decoder.feed(stream.data() + i, chunk, onTlmPacket, &check);
+		i += chunk;
+	}
+	EXPECT_EQ(0, check.mismatches);
+	EXPECT_EQ(r.sent.size(), check.next);
+	EXPECT_EQ(r.sent.size(), decoder.packetCnt);
+	EXPECT_EQ(1, decoder.badPacketCnt);
+	EXPECT_EQ(0, decoder.lostPacketCnt);
+
+	/* two channel frames packet, bytes on the wire per packet and rate at 921600 baud, 10 bits per byte */
+	size_t frameBytes = 0;
+	for (size_t i = 0; i < r.stream.size(); i++) {
+		if (r.stream[i] == 0) {
+			frameBytes = i + 1;
+			break;
+		}
+	}
+	EXPECT_TRUE(frameBytes > 0);
+	printf("Telemetry: %d packets, %d bytes, frames packet %d bytes, max %d packets/s at 921600\r\n",
+		(int)r.sent.size(), (int)r.stream.size(), (int)frameBytes, (int)(92160 / frameBytes));
+
+	/* corrupt one byte of 10th packet: it is dropped, seq gap is seen, stream recovers */
+	size_t start = 0;
+	for (int packets = 0; packets < 9; start++) {
+		if (r.stream[start] == 0) {
+			packets++;
+		}
+	}
+	std::vector<uint8_t> broken = r.stream;
+	broken[start + 3] ^= 0x40;
+	if (broken[start + 3] == 0) {
+		broken[start + 3] = 0x01;
+	}
+
+	TelemetryDecoder decoder2;
+	tlm_check check2 = { &r.sent, 0, 0, 9 };
+	decoder2.feed(broken.data(), broken.size(), onTlmPacket, &check2);
+	EXPECT_EQ(0, check2.mismatches);
+	EXPECT_EQ(r.sent.size() - 1, decoder2.packetCnt);
+	EXPECT_EQ(1, decoder2.badPacketCnt);
+	EXPECT_EQ(1, decoder2.lostPacketCnt);
+}
+
+void testSentTelemetry() {
+	testTelemetryFraming();
+	testTelemetryRoundTrip();
+}